@@ -0,0 +1,243 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Vector.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+AURORA_NAMESPACE_BEGIN
+
+double benchTime() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TriangleMesh * createTriangleSoup(size_t triangleCount, uint64_t seed) {
+    PCG32 random(seed);
+
+    TriangleMesh * triangleMesh = new TriangleMesh(3 * triangleCount, triangleCount);
+    double size = 0.5 / std::cbrt((double)triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        Vector3 center(random.nextDouble(), random.nextDouble(), random.nextDouble());
+
+        for (size_t j = 0; j < 3; j++)
+            triangleMesh->setVertex(3 * i + j, center + Vector3(
+                random.nextDouble(), random.nextDouble(), random.nextDouble()) * size);
+
+        triangleMesh->setVertexIndices(i, 3 * i, 3 * i + 1, 3 * i + 2);
+    }
+
+    return triangleMesh;
+}
+
+TriangleMesh * createTerrain(size_t triangleCount, uint64_t seed) {
+    PCG32 random(seed);
+
+    size_t resolution = std::max((size_t)std::sqrt(triangleCount / 2.0), size_t(1));
+    size_t vertexCount = (resolution + 1) * (resolution + 1);
+
+    TriangleMesh * triangleMesh = new TriangleMesh(vertexCount, 2 * resolution * resolution);
+
+    for (size_t j = 0; j <= resolution; j++)
+        for (size_t i = 0; i <= resolution; i++) {
+            double x = (double)i / resolution, y = (double)j / resolution;
+            double height = 0.5 + 0.1 * std::sin(20.0 * x) * std::cos(17.0 * y)
+                + 0.001 * random.nextDouble();
+
+            triangleMesh->setVertex(j * (resolution + 1) + i, Vector3(x, y, height));
+        }
+
+    for (size_t j = 0; j < resolution; j++)
+        for (size_t i = 0; i < resolution; i++) {
+            size_t v0 = j * (resolution + 1) + i;
+            size_t v1 = v0 + 1, v2 = v0 + resolution + 1, v3 = v2 + 1;
+            size_t t = 2 * (j * resolution + i);
+
+            triangleMesh->setVertexIndices(t, v0, v2, v1);
+            triangleMesh->setVertexIndices(t + 1, v1, v2, v3);
+        }
+
+    return triangleMesh;
+}
+
+TriangleMesh * createIcosphere(size_t levels, const Vector3 & center, const Vector3 & scale) {
+    double t = (1.0 + std::sqrt(5.0)) / 2.0;
+    double points[12][3] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    size_t faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6},
+        {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10},
+        {8, 6, 7}, {9, 8, 1}
+    };
+
+    std::vector<Vector3> vertices;
+    std::vector<size_t> vertexIndices;
+
+    for (const double (&point)[3] : points)
+        vertices.push_back(Vector3(point[0], point[1], point[2]).normalize());
+
+    for (const size_t (&face)[3] : faces)
+        vertexIndices.insert(vertexIndices.end(), {face[0], face[1], face[2]});
+
+    for (size_t level = 0; level < levels; level++) {
+        std::map<std::pair<size_t, size_t>, size_t> midpoints;
+        std::vector<size_t> subdivided;
+
+        // Retorna vrtice do ponto mdio da aresta (compartilhado pelos dois tringulos vizinhos)
+        auto midpoint = [&](size_t a, size_t b) {
+            std::pair<size_t, size_t> edge(std::min(a, b), std::max(a, b));
+            std::map<std::pair<size_t, size_t>, size_t>::iterator it = midpoints.find(edge);
+
+            if (it != midpoints.end())
+                return it->second;
+
+            vertices.push_back(((vertices[a] + vertices[b]) * 0.5).normalize());
+
+            return midpoints[edge] = vertices.size() - 1;
+        };
+
+        for (size_t i = 0; i < vertexIndices.size(); i += 3) {
+            size_t a = vertexIndices[i], b = vertexIndices[i + 1], c = vertexIndices[i + 2];
+            size_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+
+            subdivided.insert(subdivided.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+
+        vertexIndices.swap(subdivided);
+    }
+
+    TriangleMesh * triangleMesh = new TriangleMesh(vertices, vertexIndices);
+
+    for (size_t i = 0; i < vertices.size(); i++)
+        triangleMesh->setVertex(i, Vector3(vertices[i].x * scale.x, vertices[i].y * scale.y,
+            vertices[i].z * scale.z) + center);
+
+    return triangleMesh;
+}
+
+std::vector<Ray3> createRays(size_t count, uint64_t seed) {
+    PCG32 random(seed);
+
+    std::vector<Ray3> rays;
+    rays.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Vector3 origin(2.0 * random.nextDouble() - 0.5, 2.0 * random.nextDouble() - 0.5, -1.0);
+        Vector3 target(random.nextDouble(), random.nextDouble(), random.nextDouble());
+
+        rays.push_back(Ray3(origin, (target - origin).normalize()));
+    }
+
+    return rays;
+}
+
+std::vector<Ray3> createCoherentRays(size_t side) {
+    Vector3 origin(0.5, 0.5, -1.5);
+
+    std::vector<Ray3> rays;
+    rays.reserve(side * side);
+
+    for (size_t j = 0; j < side; j++)
+        for (size_t i = 0; i < side; i++) {
+            Vector3 target((i + 0.5) / side, (j + 0.5) / side, 0.5);
+            rays.push_back(Ray3(origin, (target - origin).normalize()));
+        }
+
+    return rays;
+}
+
+CacheSimulator::Level::Level(size_t size, size_t wayCount)
+    : setCount(size / 64 / wayCount), wayCount(wayCount),
+    tags(setCount * wayCount, ~uint64_t(0)), stamps(setCount * wayCount, 0), missCount(0) {}
+
+bool CacheSimulator::Level::access(uint64_t line, uint64_t clock) {
+    size_t first = (line % setCount) * wayCount;
+    size_t oldest = first;
+
+    for (size_t i = first; i < first + wayCount; i++) {
+        if (tags[i] == line) {
+            stamps[i] = clock;
+            return true;
+        }
+
+        if (stamps[i] < stamps[oldest])
+            oldest = i;
+    }
+
+    missCount++;
+    tags[oldest] = line;
+    stamps[oldest] = clock;
+
+    return false;
+}
+
+CacheSimulator::CacheSimulator(size_t l1Size, size_t l1Ways, size_t l2Size, size_t l2Ways)
+    : l1(l1Size, l1Ways), l2(l2Size, l2Ways), clock(0), lineCount(0), byteCount(0) {}
+
+void CacheSimulator::read(const void * address, size_t size) {
+    uint64_t first = (uint64_t)(uintptr_t)address;
+
+    byteCount += size;
+
+    for (uint64_t line = first >> 6; line <= (first + size - 1) >> 6; line++) {
+        lineCount++;
+        clock++;
+
+        if (!l1.access(line, clock))
+            l2.access(line, clock);
+    }
+}
+
+size_t CacheSimulator::getLineCount() const {
+    return lineCount;
+}
+size_t CacheSimulator::getByteCount() const {
+    return byteCount;
+}
+size_t CacheSimulator::getL1MissCount() const {
+    return l1.missCount;
+}
+size_t CacheSimulator::getL2MissCount() const {
+    return l2.missCount;
+}
+
+size_t getArgument(int argc, char ** argv, int i, size_t defaultValue) {
+    return i < argc ? (size_t)std::atoll(argv[i]) : defaultValue;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,116 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_BENCH_H
+#define AURORA_BENCH_H
+
+#include <aurora/Global.h>
+#include <aurora/Ray.h>
+
+#include <vector>
+#include <cstdint>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Vector3;
+class TriangleMesh;
+
+// Retorna tempo atual em segundos (relgio monotnico de alta resoluo)
+double benchTime();
+
+// Cria "sopa" de tringulos aleatrios em [0, 1]^3 (lado proporcional ao espaamento mdio, sem vrtices compartilhados)
+TriangleMesh * createTriangleSoup(size_t triangleCount, uint64_t seed = 1);
+// Cria terreno sobre [0, 1]^2 em "xy" (grade regular com alturas em "z", vrtices compartilhados) com cerca de "triangleCount" tringulos
+TriangleMesh * createTerrain(size_t triangleCount, uint64_t seed = 1);
+// Cria icosfera subdividida "levels" vezes (malha fechada com vrtices compartilhados entre tringulos vizinhos)
+// com centro e escala por eixo
+TriangleMesh * createIcosphere(size_t levels, const Vector3 & center, const Vector3 & scale);
+// Cria raios incoerentes de um plano abaixo do volume [0, 1]^3 em direo a pontos aleatrios dentro dele
+std::vector<Ray3> createRays(size_t count, uint64_t seed = 2);
+// Cria raios coerentes de cmera pontual abaixo do volume [0, 1]^3 (grade de "side" x "side" pixels)
+std::vector<Ray3> createCoherentRays(size_t side);
+
+// Simulador de hierarquia de cache de dados (dois nveis inclusivos, associativos por conjunto, substituio LRU),
+// alimentado pelos endereos lidos por uma travessia instrumentada
+class CacheSimulator {
+private:
+    // Nvel de cache (etiquetas e instantes do ltimo acesso de cada via)
+    struct Level {
+        size_t setCount; // Nmero de conjuntos
+        size_t wayCount; // Nmero de vias por conjunto
+        std::vector<uint64_t> tags; // Linha armazenada em cada via
+        std::vector<uint64_t> stamps; // Instante do ltimo acesso de cada via
+        size_t missCount; // Nmero de faltas
+
+        Level(size_t size, size_t wayCount);
+        // Retorna se linha estava no nvel (substitui a via menos recente em caso de falta)
+        bool access(uint64_t line, uint64_t clock);
+    };
+
+    Level l1; // Primeiro nvel
+    Level l2; // Segundo nvel (acessado nas faltas do primeiro)
+    uint64_t clock; // Contador de acessos
+    size_t lineCount; // Linhas acessadas
+    size_t byteCount; // Bytes lidos
+
+public:
+    // Construtor para tamanhos em bytes e associatividades (padro: L1 32 KB 8 vias, L2 1 MB 16 vias; linhas de 64 B)
+    CacheSimulator(size_t l1Size = 32768, size_t l1Ways = 8, size_t l2Size = 1 << 20, size_t l2Ways = 16);
+
+    // Registra leitura de "size" bytes a partir do endereo
+    void read(const void * address, size_t size);
+
+    // Retorna nmero de linhas acessadas
+    size_t getLineCount() const;
+    // Retorna nmero de bytes lidos
+    size_t getByteCount() const;
+    // Retorna nmero de faltas no primeiro nvel
+    size_t getL1MissCount() const;
+    // Retorna nmero de faltas no segundo nvel
+    size_t getL2MissCount() const;
+};
+
+// Retorna argumento inteiro de linha de comando (ou valor padro se ausente)
+size_t getArgument(int argc, char ** argv, int i, size_t defaultValue);
+
+// Programas de medio (argumentos aps o nome do programa)
+int benchBVH(int argc, char ** argv);
+int benchSBVH(int argc, char ** argv);
+int benchQuantizedBVH(int argc, char ** argv);
+int benchLayout(int argc, char ** argv);
+int benchRayStream(int argc, char ** argv);
+int benchTriangleBlocks(int argc, char ** argv);
+int benchTriangleTests(int argc, char ** argv);
+int benchWatertight(int argc, char ** argv);
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/BVH.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+
+AURORA_NAMESPACE_BEGIN
+
+// Mede raios/s da BVH binria (SAH em intervalos) contra fora bruta em "sopas" de 10 a 10M tringulos.
+// A fora bruta testa todos os tringulos por raio, ento o nmero de raios diminui com o tamanho da geometria
+// (cerca de 2 * 10^7 testes por tamanho); 10M tringulos exigem cerca de 4.4 GB no pico da construo
+int benchBVH(int argc, char ** argv) {
+    size_t maximumTriangleCount = getArgument(argc, argv, 1, 10000000);
+    size_t rayCount = getArgument(argc, argv, 2, 200000);
+
+    std::vector<Ray3> rays = createRays(rayCount);
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (size_t triangleCount = 10; triangleCount <= maximumTriangleCount; triangleCount *= 10) {
+        std::unique_ptr<TriangleMesh> triangleMesh(createTriangleSoup(triangleCount));
+
+        double start = benchTime();
+        BVH bvh(triangleMesh.get());
+        double buildTime = benchTime() - start;
+
+        size_t hitCount = 0;
+        start = benchTime();
+
+        for (const Ray3 & ray : rays) {
+            RayHit rayHit;
+            hitCount += bvh.intersect(ray, rayHit);
+        }
+
+        double bvhTime = benchTime() - start;
+
+        BruteForceAccelerator bruteForce;
+        bruteForce.build(triangleMesh.get());
+
+        size_t bruteForceRayCount = std::max(std::min(rayCount, size_t(20000000) / triangleCount), size_t(1));
+        size_t bruteForceHitCount = 0;
+        start = benchTime();
+
+        for (size_t i = 0; i < bruteForceRayCount; i++) {
+            RayHit rayHit;
+            bruteForceHitCount += bruteForce.intersect(rays[i], rayHit);
+        }
+
+        double bruteForceTime = benchTime() - start;
+
+        // Confere tringulos intersectados fora do tempo medido
+        size_t mismatchCount = 0;
+
+        for (size_t i = 0; i < bruteForceRayCount; i++) {
+            RayHit bvhHit, bruteForceHit;
+            bvh.intersect(rays[i], bvhHit);
+            bruteForce.intersect(rays[i], bruteForceHit);
+            mismatchCount += bvhHit.index != bruteForceHit.index;
+        }
+
+        double bvhRate = rayCount / bvhTime, bruteForceRate = bruteForceRayCount / bruteForceTime;
+
+        std::cout << std::setw(9) << triangleCount << " triangles"
+            << "  build " << std::setw(8) << buildTime * 1000.0 << " ms"
+            << "  bvh " << std::setw(10) << bvhRate << " rays/s (" << hitCount << " hits)"
+            << "  brute force " << std::setw(10) << bruteForceRate << " rays/s (" << bruteForceRayCount << " rays)"
+            << "  speedup " << std::setw(9) << bvhRate / bruteForceRate << "x"
+            << "  mismatches " << mismatchCount << std::endl;
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
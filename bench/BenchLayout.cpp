@@ -0,0 +1,197 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Cpia da travessia de "BVH::intersect" com as leituras de ns, ndices e vrtices registradas no simulador
+// (retorna ndice do tringulo mais prximo)
+size_t traverse(const BVH & bvh, const Ray3 & ray3, CacheSimulator & cacheSimulator) {
+    const std::vector<BVHNode> & nodes = bvh.getNodes();
+    const std::vector<size_t> & indices = bvh.getIndices();
+    const std::vector<Vector3> & triangleVertices = bvh.getTriangleVertices();
+    const TriangleMesh * triangleMesh = bvh.getTriangleMesh();
+    const std::vector<size_t> & vertexIndices = triangleMesh->getVertexIndices();
+
+    double maximum = ray3.maximum;
+    size_t index = RayHit().index;
+
+    size_t stack[128];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+        double near, far;
+
+        cacheSimulator.read(&node, sizeof(BVHNode));
+
+        if (node.boundingBox.intersects(ray3, near, far) && near <= maximum) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    const Vector3 * vertices[3];
+
+                    if (!triangleVertices.empty()) {
+                        vertices[0] = &triangleVertices[3 * i], vertices[1] = vertices[0] + 1, vertices[2] = vertices[0] + 2;
+                        cacheSimulator.read(vertices[0], 3 * sizeof(Vector3));
+                    }
+                    else {
+                        cacheSimulator.read(&indices[i], sizeof(size_t));
+                        cacheSimulator.read(&vertexIndices[3 * indices[i]], 3 * sizeof(size_t));
+
+                        for (size_t j = 0; j < 3; j++) {
+                            vertices[j] = &triangleMesh->getVertex(vertexIndices[3 * indices[i] + j]);
+                            cacheSimulator.read(vertices[j], sizeof(Vector3));
+                        }
+                    }
+
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction, *vertices[0], *vertices[1], *vertices[2],
+                        distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                        maximum = distance;
+                        index = indices[i];
+                    }
+                }
+            }
+            else {
+                if ((ray3.inverseDirection[node.axis & 3] < 0) != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return index;
+}
+
+}
+
+// Faltas de cache simuladas por raio (L1 32 KB 8 vias, L2 1 MB 16 vias, LRU, linhas de 64 B) e raios/s da BVH binria
+// nas ordens de ns "DepthFirst" e "LargerChildFirst", com e sem cpia dos vrtices na ordem das folhas,
+// para raios coerentes (cmera pontual) e incoerentes; cena "soup" (tringulos aleatrios) ou "terrain" (grade)
+int benchLayout(int argc, char ** argv) {
+    size_t triangleCount = getArgument(argc, argv, 1, 100000);
+    std::string scene = argc > 2 ? argv[2] : "soup";
+    size_t rayCount = getArgument(argc, argv, 3, 100000);
+
+    std::unique_ptr<TriangleMesh> triangleMesh(scene == "terrain" ?
+        createTerrain(triangleCount) : createTriangleSoup(triangleCount));
+
+    std::vector<Ray3> rays[2] = {
+        createCoherentRays((size_t)std::sqrt((double)rayCount)),
+        createRays(rayCount)
+    };
+    const char * rayNames[2] = {"coherent", "incoherent"};
+    std::vector<size_t> reference[2];
+
+    BVH bvh(triangleMesh.get());
+
+    struct configuration {
+        const char * name;
+        BVHLayout layout;
+        bool trianglePacking;
+    } configurations[] = {
+        {"depth-first", BVHLayout::DepthFirst, false},
+        {"larger child first", BVHLayout::LargerChildFirst, false},
+        {"+ packed triangles", BVHLayout::LargerChildFirst, true}
+    };
+
+    std::cout << scene << " " << triangleMesh->getTriangleCount() << " triangles" << std::endl
+        << std::fixed << std::setprecision(2);
+
+    for (const configuration & c : configurations) {
+        bvh.setLayout(c.layout).setTrianglePacking(c.trianglePacking).reorder();
+
+        for (size_t set = 0; set < 2; set++) {
+            CacheSimulator cacheSimulator;
+            size_t mismatchCount = 0;
+
+            for (size_t i = 0; i < rays[set].size(); i++) {
+                size_t index = traverse(bvh, rays[set][i], cacheSimulator);
+
+                if (c.layout == BVHLayout::DepthFirst)
+                    reference[set].push_back(index);
+                else
+                    mismatchCount += index != reference[set][i];
+            }
+
+            // Melhor de 3 repeties
+            double traceTime = AURORA_INFINITY;
+
+            for (size_t repetition = 0; repetition < 3; repetition++) {
+                double start = benchTime();
+
+                for (const Ray3 & ray : rays[set]) {
+                    RayHit rayHit;
+                    bvh.intersect(ray, rayHit);
+                }
+
+                traceTime = std::min(traceTime, benchTime() - start);
+            }
+
+            double count = (double)rays[set].size();
+
+            std::cout << "  " << std::left << std::setw(20) << c.name << std::setw(11) << rayNames[set] << std::right
+                << "  L1 miss/ray " << std::setw(7) << cacheSimulator.getL1MissCount() / count
+                << "  L2 miss/ray " << std::setw(7) << cacheSimulator.getL2MissCount() / count
+                << "  lines/ray " << std::setw(7) << cacheSimulator.getLineCount() / count
+                << "  " << std::setprecision(0) << std::setw(8) << count / traceTime << " rays/s" << std::setprecision(2)
+                << "  mismatches " << mismatchCount << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
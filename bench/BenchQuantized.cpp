@@ -0,0 +1,96 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/TriangleMesh.h>
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Mede raios/s de uma hierarquia e conta divergncias em relao s intersees de referncia
+template <typename T>
+void measure(const char * name, const T & hierarchy, size_t memorySize, size_t triangleCount,
+    const std::vector<Ray3> & rays, const std::vector<RayHit> & reference) {
+    size_t mismatchCount = 0;
+    double start = benchTime();
+
+    for (size_t i = 0; i < rays.size(); i++) {
+        RayHit rayHit;
+        hierarchy.intersect(rays[i], rayHit);
+        mismatchCount += rayHit.index != reference[i].index;
+    }
+
+    double traceTime = benchTime() - start;
+
+    std::cout << std::setw(12) << name << "  " << std::setw(8) << rays.size() / traceTime << " rays/s"
+        << "  memory " << std::setw(7) << (double)memorySize / triangleCount << " B/triangle"
+        << "  mismatches " << mismatchCount << std::endl;
+}
+
+}
+
+// Compara memria por tringulo (ns e ndices) e raios/s das hierarquias binria, larga e quantizada
+// (4 e 8 filhos) sobre a mesma BVH binria; a geometria em si ocupa 96 B por tringulo
+int benchQuantizedBVH(int argc, char ** argv) {
+    size_t triangleCount = getArgument(argc, argv, 1, 1000000);
+    size_t rayCount = getArgument(argc, argv, 2, 200000);
+
+    std::unique_ptr<TriangleMesh> triangleMesh(createTriangleSoup(triangleCount));
+    std::vector<Ray3> rays = createRays(rayCount);
+    std::vector<RayHit> reference(rayCount);
+
+    BVH bvh(triangleMesh.get());
+
+    for (size_t i = 0; i < rayCount; i++)
+        bvh.intersect(rays[i], reference[i]);
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    measure("binary", bvh, bvh.getNodeCount() * sizeof(BVHNode) + bvh.getIndices().size() * sizeof(size_t),
+        triangleCount, rays, reference);
+
+    for (size_t width : {4, 8}) {
+        WideBVH wideBVH(bvh, width);
+        QuantizedBVH quantizedBVH(bvh, width);
+
+        measure(width == 4 ? "wide 4" : "wide 8", wideBVH, wideBVH.getMemorySize(), triangleCount, rays, reference);
+        measure(width == 4 ? "quantized 4" : "quantized 8", quantizedBVH, quantizedBVH.getMemorySize(),
+            triangleCount, rays, reference);
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,203 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+#include <aurora/Utility.h>
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <cstdlib>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Contadores de travessia por raio
+struct TraversalStatistics {
+    size_t nodeCount = 0; // Ns visitados
+    size_t triangleCount = 0; // Tringulos testados
+};
+
+// Cria tringulos longos e finos (comprimento "length", largura 0.003) com orientaes aleatrias em [0, 1]^3
+TriangleMesh * createThinTriangles(size_t triangleCount, double length, uint64_t seed) {
+    PCG32 random(seed);
+
+    TriangleMesh * triangleMesh = new TriangleMesh(3 * triangleCount, triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        Vector3 point(random.nextDouble(), random.nextDouble(), random.nextDouble());
+        Vector3 direction = Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5, random.nextDouble() - 0.5).normalize();
+        Vector3 width = Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5, random.nextDouble() - 0.5).normalize();
+        double size = length * (0.5 + random.nextDouble());
+
+        triangleMesh->setVertex(3 * i, point);
+        triangleMesh->setVertex(3 * i + 1, point + direction * size);
+        triangleMesh->setVertex(3 * i + 2, point + direction * (0.5 * size) + width * 0.003);
+        triangleMesh->setVertexIndices(i, 3 * i, 3 * i + 1, 3 * i + 2);
+    }
+
+    return triangleMesh;
+}
+
+// Cpia da travessia de "BVH::intersect" com contadores (retorna ndice do tringulo mais prximo)
+size_t traverse(const BVH & bvh, const Ray3 & ray3, TraversalStatistics & statistics) {
+    const std::vector<BVHNode> & nodes = bvh.getNodes();
+    const std::vector<size_t> & indices = bvh.getIndices();
+    const TriangleMesh * triangleMesh = bvh.getTriangleMesh();
+
+    double maximum = ray3.maximum;
+    size_t index = RayHit().index;
+
+    size_t stack[128];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+        double near, far;
+
+        statistics.nodeCount++;
+
+        if (node.boundingBox.intersects(ray3, near, far) && near <= maximum) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    size_t v0, v1, v2;
+                    triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+                    double distance, u, v;
+                    statistics.triangleCount++;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction,
+                        triangleMesh->getVertex(v0), triangleMesh->getVertex(v1), triangleMesh->getVertex(v2),
+                        distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                        maximum = distance;
+                        index = indices[i];
+                    }
+                }
+            }
+            else {
+                if ((ray3.inverseDirection[node.axis & 3] < 0) != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return index;
+}
+
+}
+
+// Compara SBVH (com diferentes limites de duplicao em "setSplitBudget") e SAH em intervalos sobre tringulos finos:
+// referncias, memria, ns e tringulos visitados por raio (travessia copiada com contadores) e raios/s ("BVH::intersect")
+int benchSBVH(int argc, char ** argv) {
+    size_t triangleCount = getArgument(argc, argv, 1, 100000);
+    double length = argc > 2 ? std::atof(argv[2]) : 0.05;
+    size_t rayCount = getArgument(argc, argv, 3, 100000);
+
+    std::vector<double> budgets;
+
+    for (int i = 4; i < argc; i++)
+        budgets.push_back(std::atof(argv[i]));
+
+    if (budgets.empty())
+        budgets = {0.3, 1.0};
+
+    std::unique_ptr<TriangleMesh> triangleMesh(createThinTriangles(triangleCount, length, 7));
+    std::vector<Ray3> rays = createRays(rayCount);
+    std::vector<size_t> reference;
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Primeira configurao (oramento negativo)  a construo SAH em intervalos de referncia
+    budgets.insert(budgets.begin(), -1.0);
+
+    for (double budget : budgets) {
+        BVH bvh;
+        bvh.setBuildMethod(budget < 0 ? BVHBuildMethod::BinnedSAH : BVHBuildMethod::SpatialSAH);
+
+        if (budget >= 0)
+            bvh.setSplitBudget(budget);
+
+        bvh.build(triangleMesh.get());
+
+        TraversalStatistics statistics;
+        size_t mismatchCount = 0;
+
+        for (size_t i = 0; i < rayCount; i++) {
+            size_t index = traverse(bvh, rays[i], statistics);
+
+            if (budget < 0)
+                reference.push_back(index);
+            else
+                mismatchCount += index != reference[i];
+        }
+
+        double start = benchTime();
+
+        for (const Ray3 & ray : rays) {
+            RayHit rayHit;
+            bvh.intersect(ray, rayHit);
+        }
+
+        double traceTime = benchTime() - start;
+        size_t referenceCount = bvh.getIndices().size();
+        size_t memorySize = bvh.getNodeCount() * sizeof(BVHNode) + referenceCount * sizeof(size_t);
+
+        std::cout << (budget < 0 ? "binned" : "sbvh  ") << " budget " << std::setprecision(2) << std::max(budget, 0.0)
+            << std::setprecision(1) << "  build " << std::setw(6) << bvh.getBuildTime() << " ms"
+            << "  refs " << std::setw(8) << referenceCount
+            << " (+" << 100.0 * (referenceCount - triangleCount) / triangleCount << "%)"
+            << "  mem " << std::setw(6) << memorySize / 1048576.0 << " MB"
+            << "  nodes/ray " << std::setw(6) << (double)statistics.nodeCount / rayCount
+            << "  tris/ray " << std::setw(6) << (double)statistics.triangleCount / rayCount
+            << "  " << std::setw(8) << rayCount / traceTime << " rays/s"
+            << "  mismatches " << mismatchCount << std::endl;
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
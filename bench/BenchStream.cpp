@@ -0,0 +1,253 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/RayStream.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Cria sala fechada [0, 1]^3 (paredes em grade de "resolution" x "resolution" quadrados) com moblia
+// (40 aglomerados de tringulos pequenos)
+TriangleMesh * createInterior(size_t resolution, size_t furnitureCount, PCG32 & random) {
+    std::vector<Vector3> vertices;
+    std::vector<size_t> vertexIndices;
+
+    for (size_t axis = 0; axis < 3; axis++)
+        for (size_t side = 0; side < 2; side++) {
+            size_t base = vertices.size();
+
+            for (size_t a = 0; a <= resolution; a++)
+                for (size_t b = 0; b <= resolution; b++) {
+                    double position[3];
+                    position[axis] = (double)side;
+                    position[(axis + 1) % 3] = (double)a / resolution;
+                    position[(axis + 2) % 3] = (double)b / resolution;
+
+                    vertices.push_back(Vector3(position[0], position[1], position[2]));
+                }
+
+            for (size_t a = 0; a < resolution; a++)
+                for (size_t b = 0; b < resolution; b++) {
+                    size_t v0 = base + a * (resolution + 1) + b;
+                    size_t v1 = v0 + 1, v2 = v0 + resolution + 1, v3 = v2 + 1;
+
+                    vertexIndices.insert(vertexIndices.end(), {v0, v1, v2, v1, v3, v2});
+                }
+        }
+
+    for (size_t c = 0; c < 40; c++) {
+        Vector3 center(0.15 + 0.7 * random.nextDouble(), 0.15 + 0.7 * random.nextDouble(),
+            0.3 + 0.6 * random.nextDouble());
+        double radius = 0.05 + 0.1 * random.nextDouble();
+
+        for (size_t i = 0; i < furnitureCount / 40; i++) {
+            Vector3 position = center + Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5,
+                random.nextDouble() - 0.5) * (2.0 * radius);
+
+            for (size_t j = 0; j < 3; j++) {
+                vertexIndices.push_back(vertices.size());
+                vertices.push_back(position + Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5,
+                    random.nextDouble() - 0.5) * 0.01);
+            }
+        }
+    }
+
+    return new TriangleMesh(vertices, vertexIndices);
+}
+
+// Retorna direo com distribuio cosseno em torno da normal
+Vector3 sampleCosineDirection(const Vector3 & normal, PCG32 & random) {
+    double phi = 2.0 * AURORA_PI * random.nextDouble();
+    double r2 = random.nextDouble(), radius = std::sqrt(r2);
+
+    Vector3 axis = std::abs(normal.x) > 0.5 ? Vector3(0, 1.0, 0) : Vector3(1.0, 0, 0);
+    Vector3 bitangent = normal.cross(axis).normalize();
+    Vector3 tangent = normal.cross(bitangent);
+
+    return (bitangent * (std::cos(phi) * radius) + tangent * (std::sin(phi) * radius)
+        + normal * std::sqrt(1.0 - r2)).normalize();
+}
+
+}
+
+// Compara traado raio a raio e em fluxos ordenados (RayStream, um fluxo por bloco da imagem) dos raios
+// secundrios de uma sala fechada com moblia: um rebote difuso com distribuio cosseno e um raio de
+// sombra at luz de rea no teto por interseo primria; a primeira passada aquece caches e alocador
+// e o tempo  o melhor de 3 repeties
+int benchRayStream(int argc, char ** argv) {
+    size_t furnitureCount = getArgument(argc, argv, 1, 200000);
+    size_t wallResolution = getArgument(argc, argv, 2, 150);
+    size_t resolution = getArgument(argc, argv, 3, 256);
+    size_t tileSize = getArgument(argc, argv, 4, 64);
+    size_t sampleCount = 4;
+
+    PCG32 random(1);
+
+    std::unique_ptr<TriangleMesh> triangleMesh(createInterior(wallResolution, furnitureCount, random));
+    BVH bvh(triangleMesh.get());
+    WideBVH wideBVH(bvh, 4);
+
+    // Raios secundrios agrupados por bloco da imagem
+    std::vector<std::vector<Ray3> > bounceRays, shadowRays;
+    size_t rayCount = 0;
+    Vector3 eye(0.5, 0.5, 0.02);
+
+    for (size_t tileY = 0; tileY < resolution; tileY += tileSize)
+        for (size_t tileX = 0; tileX < resolution; tileX += tileSize) {
+            bounceRays.push_back(std::vector<Ray3>());
+            shadowRays.push_back(std::vector<Ray3>());
+
+            for (size_t y = tileY; y < std::min(tileY + tileSize, resolution); y++)
+                for (size_t x = tileX; x < std::min(tileX + tileSize, resolution); x++)
+                    for (size_t s = 0; s < sampleCount; s++) {
+                        Vector3 direction = Vector3((x + random.nextDouble()) / resolution - 0.5,
+                            (y + random.nextDouble()) / resolution - 0.5, 0.7).normalize();
+                        RayHit rayHit;
+
+                        if (!wideBVH.intersect(Ray3(eye, direction), rayHit))
+                            continue;
+
+                        size_t v0, v1, v2;
+                        triangleMesh->getVertexIndices(rayHit.index, v0, v1, v2);
+
+                        Vector3 geometricNormal = (triangleMesh->getVertex(v1) - triangleMesh->getVertex(v0)).cross(
+                            triangleMesh->getVertex(v2) - triangleMesh->getVertex(v0)).normalize();
+                        Vector3 normal = geometricNormal.dot(direction) > 0 ? -geometricNormal : geometricNormal;
+
+                        Vector3 position = eye + direction * rayHit.distance;
+                        Vector3 light = Vector3(0.4 + 0.2 * random.nextDouble(), 0.999,
+                            0.4 + 0.2 * random.nextDouble()) - position;
+                        double distance = light.length();
+
+                        bounceRays.back().push_back(Ray3(position, sampleCosineDirection(normal, random), 1e-6));
+                        shadowRays.back().push_back(Ray3(position, light.normalize(), 1e-6,
+                            distance * (1.0 - 1e-4)));
+                        rayCount++;
+                    }
+        }
+
+    std::cout << "interior: " << triangleMesh->getTriangleCount() << " triangles, " << resolution << "x"
+        << resolution << " x " << sampleCount << " spp, tiles " << tileSize << "x" << tileSize << ", "
+        << rayCount << " bounce and shadow rays" << std::endl;
+
+    std::vector<RayHit> reference(rayCount);
+    std::vector<bool> referenceHits(rayCount), referenceOcclusions(rayCount);
+    double bestTimes[4] = {1e9, 1e9, 1e9, 1e9};
+    size_t mismatchCount = 0;
+
+    for (size_t pass = 0; pass < 4; pass++) {
+        double start = benchTime();
+        size_t k = 0;
+
+        for (const std::vector<Ray3> & rays : bounceRays)
+            for (const Ray3 & ray : rays) {
+                referenceHits[k] = wideBVH.intersect(ray, reference[k]);
+                k++;
+            }
+
+        double times[4];
+        times[0] = benchTime() - start;
+
+        start = benchTime();
+        k = 0;
+
+        for (const std::vector<Ray3> & rays : shadowRays)
+            for (const Ray3 & ray : rays)
+                referenceOcclusions[k++] = wideBVH.occluded(ray);
+
+        times[1] = benchTime() - start;
+
+        start = benchTime();
+        k = 0;
+
+        for (const std::vector<Ray3> & rays : bounceRays) {
+            RayStream rayStream;
+            std::vector<RayHit> rayHits(rays.size());
+            std::unique_ptr<bool[]> hits(new bool[rays.size()]);
+
+            for (const Ray3 & ray : rays)
+                rayStream.add(ray);
+
+            rayStream.intersect(wideBVH, rayHits.data(), hits.get());
+
+            for (size_t i = 0; i < rays.size(); i++, k++)
+                mismatchCount += hits[i] != referenceHits[k] || (hits[i] && rayHits[i].index != reference[k].index);
+        }
+
+        times[2] = benchTime() - start;
+
+        start = benchTime();
+        k = 0;
+
+        for (const std::vector<Ray3> & rays : shadowRays) {
+            RayStream rayStream;
+            std::unique_ptr<bool[]> occlusions(new bool[rays.size()]);
+
+            for (const Ray3 & ray : rays)
+                rayStream.add(ray);
+
+            rayStream.occluded(wideBVH, occlusions.get());
+
+            for (size_t i = 0; i < rays.size(); i++, k++)
+                mismatchCount += occlusions[i] != referenceOcclusions[k];
+        }
+
+        times[3] = benchTime() - start;
+
+        if (pass > 0)
+            for (size_t i = 0; i < 4; i++)
+                bestTimes[i] = std::min(bestTimes[i], times[i]);
+    }
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "bounce  per-ray " << std::setw(9) << rayCount / bestTimes[0] << " rays/s  stream "
+        << std::setw(9) << rayCount / bestTimes[2] << " rays/s  (" << std::setprecision(2)
+        << bestTimes[0] / bestTimes[2] << "x)" << std::setprecision(0) << std::endl;
+    std::cout << "shadow  per-ray " << std::setw(9) << rayCount / bestTimes[1] << " rays/s  stream "
+        << std::setw(9) << rayCount / bestTimes[3] << " rays/s  (" << std::setprecision(2)
+        << bestTimes[1] / bestTimes[3] << "x)" << std::endl;
+    std::cout << "mismatches " << mismatchCount << std::endl;
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
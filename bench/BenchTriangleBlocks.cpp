@@ -0,0 +1,317 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+#include <aurora/Utility.h>
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Embaralha ordem dos tringulos da malha (leituras da malha deixam de seguir a ordem espacial das folhas)
+void shuffleTriangles(TriangleMesh * triangleMesh, uint64_t seed) {
+    PCG32 random(seed);
+    std::vector<size_t> vertexIndices = triangleMesh->getVertexIndices();
+
+    for (size_t i = triangleMesh->getTriangleCount() - 1; i > 0; i--) {
+        size_t j = random.nextUInt() % (i + 1);
+
+        for (size_t k = 0; k < 3; k++)
+            std::swap(vertexIndices[3 * i + k], vertexIndices[3 * j + k]);
+    }
+
+    triangleMesh->setVertexIndices(vertexIndices);
+}
+
+// Copia tringulos na ordem dos ndices da hierarquia para blocos SoA de preciso simples
+// (mesmo formato dos blocos da BVH larga: posio "i" da lista no bloco "i / 4", faixa "i % 4")
+std::vector<TriangleBlock> createTriangleBlocks(const TriangleMesh * triangleMesh, const std::vector<size_t> & indices) {
+    std::vector<TriangleBlock> blocks((indices.size() + 3) / 4, TriangleBlock());
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        TriangleBlock & block = blocks[i / 4];
+        size_t v0, v1, v2;
+
+        triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+        const Vector3 & p0 = triangleMesh->getVertex(v0);
+        Vector3 e1 = triangleMesh->getVertex(v1) - p0;
+        Vector3 e2 = triangleMesh->getVertex(v2) - p0;
+
+        for (size_t k = 0; k < 3; k++) {
+            block.vertex[k][i % 4] = (float)p0[k];
+            block.edges[k][i % 4] = (float)e1[k];
+            block.edges[k + 3][i % 4] = (float)e2[k];
+        }
+    }
+
+    return blocks;
+}
+
+// Leituras registradas no simulador (todos os dados) e contagem de bytes e linhas distintas de dados de tringulos
+class ReadCounter {
+public:
+    CacheSimulator cacheSimulator; // Todas as leituras da travessia (ns includos)
+    std::unordered_set<uint64_t> rayLines; // Linhas de dados de tringulos lidas pelo raio atual
+    size_t byteCount = 0; // Bytes de dados de tringulos lidos
+    size_t lineCount = 0; // Soma das linhas distintas de dados de tringulos por raio
+    size_t exactCount = 0; // Testes exatos (vrtices da malha em preciso dupla)
+
+    void readNode(const void * address, size_t size) {
+        cacheSimulator.read(address, size);
+    }
+    void readTriangle(const void * address, size_t size) {
+        uint64_t first = (uint64_t)address >> 6, last = ((uint64_t)address + size - 1) >> 6;
+
+        for (uint64_t line = first; line <= last; line++)
+            rayLines.insert(line);
+
+        cacheSimulator.read(address, size);
+        byteCount += size;
+    }
+    void finishRay() {
+        lineCount += rayLines.size();
+        rayLines.clear();
+    }
+};
+
+// Filtro de tringulo da faixa do bloco em preciso simples com as leituras registradas (Mller-Trumbore
+// com margem de 1e-3 nas coordenadas baricntricas e na distncia, como na BVH larga): retorna se tringulo
+//  candidato a interseo no intervalo
+bool filterTriangle(const TriangleBlock & block, size_t lane, const Ray3 & ray3, double maximum,
+    ReadCounter & readCounter) {
+    const float margin = 1e-3f;
+
+    float vertex[3], edge0[3], edge1[3];
+    float origin[3] = { (float)ray3.origin.x, (float)ray3.origin.y, (float)ray3.origin.z };
+    float direction[3] = { (float)ray3.direction.x, (float)ray3.direction.y, (float)ray3.direction.z };
+
+    for (size_t k = 0; k < 3; k++) {
+        readCounter.readTriangle(&block.vertex[k][lane], sizeof(float));
+        readCounter.readTriangle(&block.edges[k][lane], sizeof(float));
+        readCounter.readTriangle(&block.edges[k + 3][lane], sizeof(float));
+
+        vertex[k] = block.vertex[k][lane];
+        edge0[k] = block.edges[k][lane];
+        edge1[k] = block.edges[k + 3][lane];
+    }
+
+    float p[3] = {
+        direction[1] * edge1[2] - direction[2] * edge1[1],
+        direction[2] * edge1[0] - direction[0] * edge1[2],
+        direction[0] * edge1[1] - direction[1] * edge1[0]
+    };
+    float d = edge0[0] * p[0] + edge0[1] * p[1] + edge0[2] * p[2];
+
+    if (d == 0)
+        return false;
+
+    float inverseD = 1.0f / d;
+    float t[3] = { origin[0] - vertex[0], origin[1] - vertex[1], origin[2] - vertex[2] };
+    float u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2]) * inverseD;
+
+    if (u < -margin || u > 1.0f + margin)
+        return false;
+
+    float q[3] = {
+        t[1] * edge0[2] - t[2] * edge0[1],
+        t[2] * edge0[0] - t[0] * edge0[2],
+        t[0] * edge0[1] - t[1] * edge0[0]
+    };
+    float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseD;
+
+    if (v < -margin || u + v > 1.0f + margin)
+        return false;
+
+    float distance = (edge1[0] * q[0] + edge1[1] * q[1] + edge1[2] * q[2]) * inverseD;
+    float error = margin * (std::abs(distance) + (std::abs(t[0]) + std::abs(t[1]) + std::abs(t[2]))
+        / (float)(std::abs(ray3.direction.x) + std::abs(ray3.direction.y) + std::abs(ray3.direction.z)));
+
+    return distance + error > ray3.minimum && distance - error < maximum;
+}
+
+// L tringulo na malha (ndice na lista da hierarquia, ndices de vrtices e vrtices em preciso dupla)
+void readMeshTriangle(const TriangleMesh * triangleMesh, const std::vector<size_t> & indices, size_t i,
+    const Vector3 * (&vertices)[3], ReadCounter & readCounter) {
+    const std::vector<size_t> & vertexIndices = triangleMesh->getVertexIndices();
+
+    readCounter.readTriangle(&indices[i], sizeof(size_t));
+    readCounter.readTriangle(&vertexIndices[3 * indices[i]], 3 * sizeof(size_t));
+
+    for (size_t j = 0; j < 3; j++) {
+        vertices[j] = &triangleMesh->getVertex(vertexIndices[3 * indices[i] + j]);
+        readCounter.readTriangle(vertices[j], sizeof(Vector3));
+    }
+}
+
+// Cpia da travessia de "BVH::intersect" com leituras registradas: folhas testam tringulos lendo a malha
+// ("blocks" nulo) ou testam primeiro a faixa do bloco em preciso simples e leem a malha apenas para confirmar
+// candidatos com o teste exato; a malha  lida mais uma vez para o sombreamento da interseo final
+size_t traverse(const BVH & bvh, const TriangleBlock * blocks, const Ray3 & ray3, ReadCounter & readCounter) {
+    const std::vector<BVHNode> & nodes = bvh.getNodes();
+    const std::vector<size_t> & indices = bvh.getIndices();
+    const TriangleMesh * triangleMesh = bvh.getTriangleMesh();
+
+    double maximum = ray3.maximum;
+    size_t index = RayHit().index, slot = 0;
+
+    size_t stack[128];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+        double near, far;
+
+        readCounter.readNode(&node, sizeof(BVHNode));
+
+        if (node.boundingBox.intersects(ray3, near, far) && near <= maximum) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    // S candidatos do filtro leem a malha
+                    if (blocks && !filterTriangle(blocks[i / 4], i % 4, ray3, maximum, readCounter))
+                        continue;
+
+                    const Vector3 * vertices[3];
+                    readMeshTriangle(triangleMesh, indices, i, vertices, readCounter);
+                    readCounter.exactCount++;
+
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction, *vertices[0], *vertices[1], *vertices[2],
+                        distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                        maximum = distance;
+                        index = indices[i];
+                        slot = i;
+                    }
+                }
+            }
+            else {
+                if ((ray3.inverseDirection[node.axis & 3] < 0) != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    if (index != RayHit().index) {
+        const Vector3 * vertices[3];
+        readMeshTriangle(triangleMesh, indices, slot, vertices, readCounter);
+    }
+
+    readCounter.finishRay();
+
+    return index;
+}
+
+}
+
+// Bytes e linhas distintas de dados de tringulos lidos por raio (e faltas de cache simuladas, L1 32 KB, L2 1 MB) nas folhas
+// da BVH binria, lendo ndices e vrtices em preciso dupla da malha ("mesh") ou blocos de interseo em
+// preciso simples na ordem das folhas ("blocks", formato da BVH larga); cena "soup" ou "terrain" com ordem dos
+// tringulos da malha embaralhada, raios coerentes e incoerentes
+int benchTriangleBlocks(int argc, char ** argv) {
+    size_t triangleCount = getArgument(argc, argv, 1, 100000);
+    std::string scene = argc > 2 ? argv[2] : "terrain";
+    size_t rayCount = getArgument(argc, argv, 3, 100000);
+
+    std::unique_ptr<TriangleMesh> triangleMesh(scene == "terrain" ?
+        createTerrain(triangleCount) : createTriangleSoup(triangleCount));
+    shuffleTriangles(triangleMesh.get(), 3);
+
+    std::vector<Ray3> rays[2] = {
+        createCoherentRays((size_t)std::sqrt((double)rayCount)),
+        createRays(rayCount)
+    };
+    const char * rayNames[2] = {"coherent", "incoherent"};
+
+    BVH bvh(triangleMesh.get());
+    std::vector<TriangleBlock> blocks = createTriangleBlocks(triangleMesh.get(), bvh.getIndices());
+
+    std::cout << scene << " " << triangleMesh->getTriangleCount() << " triangles (shuffled)" << std::endl
+        << std::fixed << std::setprecision(2);
+
+    for (size_t set = 0; set < 2; set++) {
+        std::vector<size_t> reference;
+
+        for (size_t mode = 0; mode < 2; mode++) {
+            ReadCounter readCounter;
+            size_t mismatchCount = 0;
+
+            for (size_t i = 0; i < rays[set].size(); i++) {
+                size_t index = traverse(bvh, mode == 0 ? nullptr : blocks.data(), rays[set][i], readCounter);
+
+                if (mode == 0)
+                    reference.push_back(index);
+                else
+                    mismatchCount += index != reference[i];
+            }
+
+            double count = (double)rays[set].size();
+
+            std::cout << "  " << std::left << std::setw(8) << (mode == 0 ? "mesh" : "blocks") << std::setw(11)
+                << rayNames[set] << std::right
+                << "  triangle bytes/ray " << std::setw(5) << std::setprecision(0)
+                << readCounter.byteCount / count << std::setprecision(2)
+                << "  triangle lines/ray " << std::setw(6) << readCounter.lineCount / count
+                << "  L1 miss/ray " << std::setw(7) << readCounter.cacheSimulator.getL1MissCount() / count
+                << "  L2 miss/ray " << std::setw(7) << readCounter.cacheSimulator.getL2MissCount() / count
+                << "  exact tests/ray " << std::setw(6) << readCounter.exactCount / count
+                << "  mismatches " << mismatchCount << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
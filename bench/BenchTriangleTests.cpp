@@ -0,0 +1,108 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Vector.h>
+#include <aurora/WideBVH.h>
+#include <aurora/Random.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+AURORA_NAMESPACE_BEGIN
+
+// Testes de tringulos por segundo em uma thread (um ncleo) do teste vetorial de blocos e da referncia
+// escalar: conjuntos de 16 tringulos (4 blocos) cabem na L1 e L2; a largura vetorial  a do conjunto de
+// instrues da compilao (compilar com "-msse4.2", "-mavx2" ou "-mavx512f" para comparar); melhor de 5
+int benchTriangleTests(int argc, char ** argv) {
+    size_t setCount = getArgument(argc, argv, 1, 4096);
+    size_t rayCount = getArgument(argc, argv, 2, 1024);
+    const size_t setSize = 16;
+
+    PCG32 random(7);
+    std::vector<TriangleBlock> blocks(setCount * setSize / 4, TriangleBlock());
+
+    for (TriangleBlock & block : blocks)
+        for (size_t lane = 0; lane < 4; lane++)
+            for (size_t k = 0; k < 3; k++) {
+                block.vertex[k][lane] = (float)random.nextDouble();
+                block.edges[k][lane] = (float)(random.nextDouble() - 0.5) * 0.6f;
+                block.edges[k + 3][lane] = (float)(random.nextDouble() - 0.5) * 0.6f;
+            }
+
+    std::vector<Ray3> rays = createRays(rayCount, 3);
+
+    // Validao contra a referncia escalar
+    size_t mismatchCount = 0;
+
+    for (size_t s = 0; s < setCount; s++)
+        for (size_t r = 0; r < 64; r++) {
+            float distance = 0, u = 0, v = 0, referenceDistance = 0, referenceU = 0, referenceV = 0;
+            const Ray3 & ray = rays[(s + r) % rayCount];
+
+            int closest = intersectTriangleBlocks(&blocks[s * setSize / 4], setSize, ray, distance, u, v);
+            int reference = intersectTriangleBlocksReference(&blocks[s * setSize / 4], setSize, ray,
+                referenceDistance, referenceU, referenceV);
+
+            mismatchCount += closest != reference || (reference >= 0 && (distance != referenceDistance ||
+                u != referenceU || v != referenceV));
+        }
+
+    std::cout << "width " << getTriangleBlockWidth() << "  mismatches " << mismatchCount << std::endl
+        << std::fixed << std::setprecision(1);
+
+    for (size_t mode = 0; mode < 2; mode++) {
+        double bestTime = AURORA_INFINITY;
+        long checksum = 0;
+
+        for (size_t repetition = 0; repetition < 5; repetition++) {
+            double start = benchTime();
+            checksum = 0;
+
+            for (size_t r = 0; r < rayCount; r++)
+                for (size_t s = 0; s < setCount; s++) {
+                    float distance, u, v;
+
+                    checksum += mode == 0 ?
+                        intersectTriangleBlocks(&blocks[s * setSize / 4], setSize, rays[r], distance, u, v) :
+                        intersectTriangleBlocksReference(&blocks[s * setSize / 4], setSize, rays[r], distance, u, v);
+                }
+
+            bestTime = std::min(bestTime, benchTime() - start);
+        }
+
+        std::cout << std::left << std::setw(18) << (mode == 0 ? "vector" : "scalar reference") << std::right
+            << std::setw(8) << (double)rayCount * setCount * setSize / bestTime / 1e6
+            << " M triangle tests/s per core  (checksum " << checksum << ")" << std::endl;
+    }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,162 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+#include <aurora/Random.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+
+AURORA_NAMESPACE_BEGIN
+
+// Teste estanque em preciso simples contra Mller-Trumbore em preciso dupla numa icosfera fechada
+// (vrtices compartilhados, coordenadas no representveis exatamente): raios de pontos internos na direo
+// de vrtices, pontos de arestas e interiores; imprime raios que escapam pela malha e raios/s das BVHs binria
+// e larga, e testes isolados por segundo (melhor de 3) com pares que acertam (raio e tringulo alvo) e pares
+// aleatrios (quase sempre rejeitados)
+int benchWatertight(int argc, char ** argv) {
+    size_t levels = getArgument(argc, argv, 1, 6);
+    size_t rayCount = getArgument(argc, argv, 2, 400000);
+
+    Vector3 center(10.37, -5.11, 0.731), scale(3.1, 2.7, 1.9);
+    std::unique_ptr<TriangleMesh> triangleMesh(createIcosphere(levels, center, scale));
+
+    size_t triangleCount = triangleMesh->getTriangleCount();
+    PCG32 random(3);
+    std::vector<Ray3> rays;
+    std::vector<size_t> targets; // Tringulo alvo de cada raio
+
+    for (size_t i = 0; i < rayCount; i++) {
+        Vector3 origin = center + Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5,
+            random.nextDouble() - 0.5) * 1.2;
+
+        size_t v0, v1, v2;
+        targets.push_back(random.nextUInt() % triangleCount);
+        triangleMesh->getVertexIndices(targets.back(), v0, v1, v2);
+
+        const Vector3 & a = triangleMesh->getVertex(v0);
+        const Vector3 & b = triangleMesh->getVertex(v1);
+        const Vector3 & c = triangleMesh->getVertex(v2);
+        double s = random.nextDouble(), r = random.nextDouble();
+
+        if (s + r > 1.0)
+            s = 1.0 - s, r = 1.0 - r;
+
+        Vector3 target = i % 3 == 0 ? a : i % 3 == 1 ? a * s + b * (1.0 - s) : a * (1.0 - s - r) + b * s + c * r;
+
+        rays.push_back(Ray3(origin, (target - origin).normalize()));
+    }
+
+    const char * names[2] = {"Moller-Trumbore", "watertight"};
+    TriangleIntersection methods[2] = {TriangleIntersection::MollerTrumbore, TriangleIntersection::Watertight};
+
+    std::cout << "icosphere " << triangleCount << " triangles, " << rayCount << " rays" << std::endl;
+
+    for (size_t method = 0; method < 2; method++) {
+        setTriangleIntersection(methods[method]);
+
+        for (size_t width : {2, 4}) {
+            std::shared_ptr<Accelerator> accelerator = createAccelerator(triangleMesh.get(), AcceleratorType::BVH,
+                BVHBuildMethod::BinnedSAH, width);
+
+            size_t missCounts[3] = {0, 0, 0};
+            double traceTime = AURORA_INFINITY;
+
+            for (size_t repetition = 0; repetition < 3; repetition++) {
+                double start = benchTime();
+
+                for (size_t i = 0; i < rays.size(); i++) {
+                    RayHit rayHit;
+                    bool hit = accelerator->intersect(rays[i], rayHit);
+
+                    if (repetition == 0)
+                        missCounts[i % 3] += !hit;
+                }
+
+                traceTime = std::min(traceTime, benchTime() - start);
+            }
+
+            std::cout << std::left << std::setw(16) << names[method] << (width == 2 ? "binary" : "wide 4") << std::right
+                << "  misses vertex " << missCounts[0] << " edge " << missCounts[1] << " interior " << missCounts[2]
+                << std::fixed << std::setprecision(0) << "  " << std::setw(8) << rays.size() / traceTime << " rays/s"
+                << std::endl;
+        }
+    }
+
+    setTriangleIntersection(TriangleIntersection::MollerTrumbore);
+
+    // Testes isolados: tringulo alvo do raio ou tringulo pseudoaleatrio
+    const size_t testCount = 2000000;
+    const std::vector<Vector3> & vertices = triangleMesh->getVertices();
+    const std::vector<size_t> & vertexIndices = triangleMesh->getVertexIndices();
+
+    std::cout << std::setprecision(1);
+
+    for (size_t pairing = 0; pairing < 2; pairing++)
+        for (size_t method = 0; method < 2; method++) {
+            double testTime = AURORA_INFINITY;
+            size_t hitCount = 0;
+
+            for (size_t repetition = 0; repetition < 3; repetition++) {
+                double start = benchTime();
+                hitCount = 0;
+
+                for (size_t i = 0; i < testCount; i++) {
+                    const Ray3 & ray = rays[i % rays.size()];
+                    size_t triangle = pairing == 0 ? targets[i % rays.size()] : (i * 7919) % triangleCount;
+                    const size_t * v = &vertexIndices[3 * triangle];
+                    double distance, u, w;
+
+                    bool hit = method == 0 ?
+                        intersectTriangleMollerTrumbore(ray.origin, ray.direction,
+                            vertices[v[0]], vertices[v[1]], vertices[v[2]], distance, u, w) :
+                        intersectTriangleWatertight(ray.origin, ray.direction,
+                            vertices[v[0]], vertices[v[1]], vertices[v[2]], distance, u, w);
+
+                    hitCount += hit && distance > 0;
+                }
+
+                testTime = std::min(testTime, benchTime() - start);
+            }
+
+            std::cout << std::left << std::setw(16) << names[method] << std::setw(14)
+                << (pairing == 0 ? "target pairs" : "random pairs") << std::right << std::setw(6)
+                << testCount / testTime / 1e6 << " M tests/s  (hits " << hitCount << ")" << std::endl;
+        }
+
+    return 0;
+}
+
+AURORA_NAMESPACE_END
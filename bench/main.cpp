@@ -0,0 +1,68 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Bench.h"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+using namespace aurora;
+using namespace std;
+
+// Programa de medio registrado (nome usado na linha de comando)
+struct benchmark
+{
+	const char * name;
+	int (*function)(int argc, char ** argv);
+	const char * description;
+};
+
+const benchmark benchmarks[] = {
+	{"bvh", benchBVH, "[maxTriangles] [rays]  BVH vs brute force rays/s, 10 to 10M triangles"},
+	{"sbvh", benchSBVH, "[triangles] [length] [rays] [budgets...]  SBVH split budgets vs binned SAH on thin triangles"},
+	{"quantized", benchQuantizedBVH, "[triangles] [rays]  binary, wide and quantized BVH memory and rays/s"},
+	{"layout", benchLayout, "[triangles] [soup|terrain] [rays]  simulated cache misses per ray for BVH node layouts and packing"},
+	{"stream", benchRayStream, "[furniture] [wallResolution] [resolution] [tileSize]  per-ray vs streamed secondary rays in a diffuse interior"},
+	{"blocks", benchTriangleBlocks, "[triangles] [terrain|soup] [rays]  triangle bytes touched per ray, mesh reads vs float triangle blocks"},
+	{"triangles", benchTriangleTests, "[sets] [rays]  SIMD triangle tests per second per core (width of the compiled instruction set)"},
+	{"watertight", benchWatertight, "[levels] [rays]  float watertight vs double Moller-Trumbore: cracks and throughput on a closed mesh"}
+};
+
+int main(int argc, char ** argv) {
+	
+	for (const benchmark & b : benchmarks)
+		if (argc > 1 && strcmp(argv[1], b.name) == 0)
+			return b.function(argc - 1, argv + 1);
+	
+	cout << "Usage: bench <program> [arguments]" << endl;
+	
+	for (const benchmark & b : benchmarks)
+		cout << "  " << b.name << " " << b.description << endl;
+	
+	return 1;
+}
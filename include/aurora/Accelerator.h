@@ -0,0 +1,197 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_ACCELERATOR_H
+#define AURORA_ACCELERATOR_H
+
+#include <aurora/Global.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+class RayHit;
+class TriangleMesh;
+
+// Tipo de estrutura de acelerao
+enum class AcceleratorType {
+    BruteForce, // Teste de todos os tringulos (cenas mnimas, sem construo)
+    UniformGrid, // Grade uniforme hierrquica com travessia 3D-DDA (construo barata)
+    BVH, // Hierarquia de volumes delimitadores (travessia mais rpida em cenas grandes)
+    QuantizedBVH, // Hierarquia larga com caixas quantizadas em 8 bits (menor memria por n)
+    Automatic // Escolha pela contagem e distribuio espacial dos tringulos
+};
+
+// Interface de estrutura de acelerao de consultas de raios sobre os tringulos de uma geometria
+class Accelerator {
+protected:
+    // Imprime informaes da estrutura
+    virtual void print(std::ostream & output) const = 0;
+
+public:
+    // Destrutor virtual (estruturas destrudas pela interface)
+    virtual ~Accelerator();
+
+    // Sobrecarga da operao "sada << estrutura" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const Accelerator & rhs);
+
+    // Retorna tipo da estrutura
+    virtual AcceleratorType getType() const = 0;
+    // Retorna memria ocupada pela estrutura em bytes
+    virtual size_t getMemorySize() const = 0;
+    // Retorna geometria referenciada
+    virtual const TriangleMesh * getTriangleMesh() const = 0;
+
+    // Constri estrutura sobre os tringulos da geometria
+    virtual void build(const TriangleMesh * triangleMesh) = 0;
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    virtual bool intersect(const Ray3 & ray3, RayHit & rayHit) const = 0;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    virtual bool occluded(const Ray3 & ray3) const = 0;
+    // Intersecta grupo de raios (padro: raio a raio)
+    virtual void intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const;
+};
+
+// Teste de todos os tringulos da geometria (sem construo)
+class BruteForceAccelerator : public Accelerator {
+private:
+    const TriangleMesh * triangleMesh; // Geometria referenciada (no pertence  estrutura)
+
+protected:
+    // Imprime informaes da estrutura
+    void print(std::ostream & output) const;
+
+public:
+    // Construtor padro (estrutura vazia)
+    BruteForceAccelerator();
+    // Construtor cpia
+    BruteForceAccelerator(const BruteForceAccelerator & bruteForceAccelerator);
+    // Destrutor padro
+    ~BruteForceAccelerator();
+
+    // Retorna tipo da estrutura
+    AcceleratorType getType() const;
+    // Retorna memria ocupada pela estrutura em bytes
+    size_t getMemorySize() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+
+    using Accelerator::intersect;
+
+    // Referencia geometria
+    void build(const TriangleMesh * triangleMesh);
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+};
+
+// Hierarquia de volumes delimitadores binria ou larga (colapsada da binria quando largura > 2),
+// opcionalmente com ns quantizados
+class BVHAccelerator : public Accelerator {
+private:
+    BVH bvh; // Hierarquia binria
+    WideBVH wideBVH; // Hierarquia larga (largura 4 ou 8)
+    QuantizedBVH quantizedBVH; // Hierarquia larga quantizada (largura 4 ou 8)
+    size_t width; // Nmero de filhos por n (2 usa hierarquia binria)
+    bool quantized; // Travessia pela hierarquia quantizada em vez da larga
+    bool cached; // Hierarquia binria carregada do cache em disco na ltima construo
+
+    // Colapsa hierarquia binria na hierarquia larga ou quantizada (se largura > 2)
+    void collapse();
+
+protected:
+    // Imprime informaes da estrutura
+    void print(std::ostream & output) const;
+
+public:
+    // Construtor para valores iniciais
+    BVHAccelerator(BVHBuildMethod buildMethod = BVHBuildMethod::BinnedSAH, size_t width = 4, bool quantized = false);
+    // Construtor cpia
+    BVHAccelerator(const BVHAccelerator & bvhAccelerator);
+    // Destrutor padro
+    ~BVHAccelerator();
+
+    // Retorna tipo da estrutura
+    AcceleratorType getType() const;
+    // Retorna memria ocupada pela estrutura em bytes
+    size_t getMemorySize() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+    // Retorna nmero de filhos por n
+    size_t getWidth() const;
+    // Retorna hierarquia binria
+    BVH & getBVH();
+    // Retorna hierarquia binria
+    const BVH & getBVH() const;
+    // Retorna hierarquia larga (vazia se largura 2 ou quantizada)
+    const WideBVH & getWideBVH() const;
+    // Retorna se travessia usa a hierarquia quantizada
+    bool isQuantized() const;
+    // Retorna hierarquia quantizada (vazia se no quantizada)
+    const QuantizedBVH & getQuantizedBVH() const;
+    // Retorna se hierarquia binria foi carregada do cache em disco
+    bool isCached() const;
+
+    // Constri hierarquia binria e, se largura > 2, hierarquia larga (ou quantizada, com largura 4 ou 8)
+    void build(const TriangleMesh * triangleMesh);
+    // Carrega hierarquia binria do cache em disco se vlido para a geometria (hash do contedo), seno
+    // constri e escreve o cache; retorna se foi carregada (o cache guarda a primeira hierarquia construda
+    // para a geometria, independente do mtodo de construo configurado)
+    bool build(const TriangleMesh * triangleMesh, const std::string & cacheFilename);
+    // Reordena hierarquia binria construda conforme a ordem dos ns e a cpia de vrtices indicadas
+    // e recolapsa a hierarquia larga ou quantizada
+    BVHAccelerator & reorder(BVHLayout layout, bool trianglePacking);
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+    // Intersecta grupo de raios (pacotes coerentes na hierarquia larga, raio a raio na quantizada)
+    void intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const;
+};
+
+// Escolhe tipo de estrutura pela contagem de tringulos e uniformidade da distribuio espacial
+AcceleratorType chooseAccelerator(const TriangleMesh * triangleMesh);
+// Cria estrutura do tipo indicado (automtico resolvido por "chooseAccelerator") e constri sobre geometria
+// (hierarquias carregadas do cache em disco "cacheFilename" ou construdas e escritas nele, se indicado)
+std::shared_ptr<Accelerator> createAccelerator(const TriangleMesh * triangleMesh,
+    AcceleratorType type = AcceleratorType::Automatic,
+    BVHBuildMethod buildMethod = BVHBuildMethod::BinnedSAH, size_t width = 4,
+    const std::string & cacheFilename = std::string());
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
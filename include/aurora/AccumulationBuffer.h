@@ -0,0 +1,102 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_ACCUMULATIONBUFFER_H
+#define AURORA_ACCUMULATIONBUFFER_H
+
+#include <aurora/Global.h>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Color3;
+class Image3;
+
+// Buffer de acumulao da renderizao progressiva: soma RGB e soma dos quadrados da luminncia em preciso
+// simples e nmero de amostras de cada pixel (pixels com quantidades diferentes de amostras, mdia e varincia
+// estimadas por pixel); blocos de pixels distintos podem ser acumulados por threads diferentes sem bloqueios
+class AccumulationBuffer {
+private:
+    size_t width; // Resoluo horizontal
+    size_t height; // Resoluo vertical
+    std::vector<float> sums; // Soma das amostras RGB de cada pixel no formato linha majoritria
+    std::vector<float> squaredSums; // Soma dos quadrados da luminncia das amostras de cada pixel
+    std::vector<uint32_t> sampleCounts; // Nmero de amostras de cada pixel
+
+public:
+    // Construtor padro (buffer nulo)
+    AccumulationBuffer();
+    // Construtor cpia
+    AccumulationBuffer(const AccumulationBuffer & accumulationBuffer);
+    // Construtor para alocao de pixels (sem amostras)
+    AccumulationBuffer(size_t width, size_t height);
+    // Destrutor padro
+    ~AccumulationBuffer();
+
+    // Cria buffer alocando pixels (sem amostras)
+    AccumulationBuffer & create(size_t width, size_t height);
+    // Descarta amostras de todos os pixels
+    void clear();
+
+    // Acumula uma amostra no pixel
+    void add(size_t i, size_t j, const Color3 & sample);
+    // Acumula soma e soma dos quadrados da luminncia de "sampleCount" amostras no pixel
+    void add(size_t i, size_t j, const Color3 & sum, double squaredSum, uint32_t sampleCount);
+    // Retorna nmero de amostras do pixel
+    uint32_t getSampleCount(size_t i, size_t j) const;
+    // Retorna mdia das amostras do pixel (preto se no h amostras)
+    Color3 getPixel(size_t i, size_t j) const;
+    // Retorna varincia amostral da luminncia do pixel (zero com menos de duas amostras)
+    double getVariance(size_t i, size_t j) const;
+    // Retorna erro estimado da mdia do pixel: erro padro da luminncia relativo  raiz da luminncia mdia
+    // (aproxima o rudo percebido aps correo gamma; zero com menos de duas amostras)
+    double getError(size_t i, size_t j) const;
+    // Retorna menor nmero de amostras entre os pixels
+    uint32_t getMinimumSampleCount() const;
+    // Retorna nmero total de amostras
+    uint64_t getTotalSampleCount() const;
+    // Retorna resoluo horizontal
+    size_t getWidth() const;
+    // Retorna resoluo vertical
+    size_t getHeight() const;
+
+    // Escreve mdia das amostras de cada pixel na imagem (redimensionada se necessrio)
+    void resolve(Image3 & image3) const;
+    // Escreve mapa do nmero de amostras de cada pixel na imagem (tons de cinza, branco no maior nmero)
+    void resolveSampleCounts(Image3 & image3) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,197 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_BVH_H
+#define AURORA_BVH_H
+
+#include <aurora/Global.h>
+#include <aurora/BoundingBox.h>
+
+#include <vector>
+#include <utility>
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+class RayHit;
+class TriangleMesh;
+class BVHCache;
+
+// N de hierarquia de volumes delimitadores (filho esquerdo  sempre o n seguinte)
+class BVHNode {
+public:
+    BoundingBox3 boundingBox; // Caixa delimitadora do n
+    size_t offset; // ndice do filho direito (n interno) ou da primeira primitiva (folha)
+    size_t count; // Nmero de primitivas (zero em ns internos)
+    size_t axis; // Eixo de diviso (bits 0-1) e filho seguinte  direita da diviso (bit 2) em ns internos
+
+    // Construtor padro (n vazio)
+    BVHNode();
+    // Construtor cpia
+    BVHNode(const BVHNode & bvhNode);
+    // Destrutor padro
+    ~BVHNode();
+
+    // Retorna se n  folha
+    bool isLeaf() const;
+};
+
+// Mtodo de construo da hierarquia
+enum class BVHBuildMethod {
+    SweepSAH, // SAH com varredura completa dos centros (sequencial, maior qualidade)
+    BinnedSAH, // SAH com agrupamento em intervalos (paralelo, construo rpida)
+    Linear, // Ordenao por cdigo de Morton (LBVH, construo mais rpida)
+    HierarchicalLinear, // LBVH em grupos de Morton com nveis superiores SAH (HLBVH)
+    SpatialSAH // SAH com divises espaciais e duplicao de referncias (SBVH, sequencial)
+};
+
+// Ordem dos ns na memria (filhos em profundidade, um deles sempre seguinte ao pai)
+enum class BVHLayout {
+    DepthFirst, // Filho esquerdo da diviso seguinte ao pai (ordem de construo)
+    LargerChildFirst // Filho de maior rea (mais provvel de ser visitado) seguinte ao pai
+};
+
+// Hierarquia de volumes delimitadores (BVH) sobre os tringulos de uma geometria,
+// construda com heurstica de rea de superfcie (SAH)
+class BVH {
+private:
+    const TriangleMesh * triangleMesh; // Geometria referenciada (no pertence  hierarquia)
+    std::vector<BVHNode> nodes; // Lista de ns em ordem de profundidade
+    std::vector<size_t> indices; // Lista de ndices de tringulos ordenados por folha
+    BVHBuildMethod buildMethod; // Mtodo de construo
+    size_t maximumLeafSize; // Nmero mximo de tringulos por folha
+    size_t threadCount; // Nmero de threads de construo (zero usa todos os ncleos)
+    double splitBudget; // Frao mxima de referncias duplicadas por divises espaciais (SBVH)
+    size_t buildTime; // Tempo da ltima construo em milisegundos
+    std::vector<std::pair<size_t, size_t> > subtrees; // Intervalos de ns [incio, fim) das subrvores (reajuste paralelo)
+    std::vector<double> subtreeCosts; // Custo SAH de referncia de cada subrvore
+    double cost; // Custo SAH atual (normalizado pela rea da raiz)
+    double buildCost; // Custo SAH aps a ltima construo completa
+    double rebuildThreshold; // Razo de degradao do custo SAH que dispara reconstruo
+    size_t updateTime; // Tempo da ltima atualizao em milisegundos
+    BVHLayout layout; // Ordem dos ns na memria
+    bool trianglePacking; // Copia vrtices dos tringulos na ordem das folhas
+    std::vector<Vector3> triangleVertices; // Vrtices (trs por referncia) na ordem dos ndices
+
+    // Seleciona subrvores disjuntas que cobrem a hierarquia abaixo dos nveis superiores
+    void computeSubtrees();
+    // Recalcula custos SAH das subrvores e da hierarquia (atualizando caixas se solicitado)
+    void evaluate(bool updateBounds, std::vector<double> & costs);
+    // Reconstri subrvores indicadas preservando o restante da hierarquia
+    void rebuildSubtrees(const std::vector<size_t> & degraded);
+    // Copia vrtices dos tringulos referenciados na ordem das folhas
+    void packTriangleVertices();
+
+public:
+    // Construtor padro (hierarquia vazia)
+    BVH();
+    // Construtor cpia
+    BVH(const BVH & bvh);
+    // Construtor que constri hierarquia sobre geometria
+    BVH(const TriangleMesh * triangleMesh,
+        BVHBuildMethod buildMethod = BVHBuildMethod::BinnedSAH, size_t maximumLeafSize = 4);
+    // Destrutor padro
+    ~BVH();
+
+    // Sobrecarga da operao "sada << hierarquia" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const BVH & rhs);
+
+    // Configura mtodo de construo (aplicado na prxima construo)
+    BVH & setBuildMethod(BVHBuildMethod buildMethod);
+    // Retorna mtodo de construo
+    BVHBuildMethod getBuildMethod() const;
+    // Configura nmero mximo de tringulos por folha (aplicado na prxima construo)
+    BVH & setMaximumLeafSize(size_t maximumLeafSize);
+    // Retorna nmero mximo de tringulos por folha
+    size_t getMaximumLeafSize() const;
+    // Configura nmero de threads de construo (zero usa todos os ncleos)
+    BVH & setThreadCount(size_t threadCount);
+    // Retorna nmero de threads de construo
+    size_t getThreadCount() const;
+    // Configura frao mxima de referncias duplicadas em relao ao nmero de tringulos (SBVH)
+    BVH & setSplitBudget(double splitBudget);
+    // Retorna frao mxima de referncias duplicadas
+    double getSplitBudget() const;
+    // Retorna tempo da ltima construo em milisegundos
+    size_t getBuildTime() const;
+    // Configura razo de degradao do custo SAH que dispara reconstruo em "update" (1.3 = 30% pior)
+    BVH & setRebuildThreshold(double rebuildThreshold);
+    // Retorna razo de degradao que dispara reconstruo
+    double getRebuildThreshold() const;
+    // Retorna custo SAH atual (normalizado pela rea da raiz)
+    double getCost() const;
+    // Retorna custo SAH aps a ltima construo completa
+    double getBuildCost() const;
+    // Retorna tempo da ltima atualizao em milisegundos
+    size_t getUpdateTime() const;
+    // Configura ordem dos ns na memria (aplicada na prxima construo ou em "reorder")
+    BVH & setLayout(BVHLayout layout);
+    // Retorna ordem dos ns na memria
+    BVHLayout getLayout() const;
+    // Configura cpia dos vrtices na ordem das folhas (aplicada na prxima construo ou em "reorder")
+    BVH & setTrianglePacking(bool trianglePacking);
+    // Retorna se vrtices so copiados na ordem das folhas
+    bool getTrianglePacking() const;
+    // Retorna vrtices copiados na ordem das folhas (vazio se cpia desabilitada)
+    const std::vector<Vector3> & getTriangleVertices() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+    // Retorna lista de ns
+    const std::vector<BVHNode> & getNodes() const;
+    // Retorna lista de ndices de tringulos ordenados por folha (com repeties no SBVH)
+    const std::vector<size_t> & getIndices() const;
+    // Retorna nmero de ns
+    size_t getNodeCount() const;
+    // Retorna caixa delimitadora da geometria
+    BoundingBox3 getBoundingBox() const;
+
+    // Constri hierarquia sobre os tringulos da geometria
+    BVH & build(const TriangleMesh * triangleMesh);
+    // Constri hierarquia sobre caixas arbitrrias (sem geometria; ndices referem-se s caixas)
+    BVH & build(const std::vector<BoundingBox3> & boundingBoxes);
+    // Carrega hierarquia de cache aberto para a geometria (falso se cache fechado ou de outra contagem de tringulos)
+    bool load(const TriangleMesh * triangleMesh, const BVHCache & bvhCache);
+    // Atualiza caixas dos ns a partir das posies atuais dos vrtices (topologia inalterada)
+    BVH & refit();
+    // Reajusta caixas e reconstri subrvores (ou a hierarquia inteira) se o custo SAH degradou alm do limite
+    BVH & update();
+    // Reordena ns e ndices conforme a ordem configurada (topologia inalterada)
+    BVH & reorder();
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
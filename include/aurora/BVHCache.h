@@ -0,0 +1,112 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_BVH_CACHE_H
+#define AURORA_BVH_CACHE_H
+
+#include <aurora/Global.h>
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+class RayHit;
+class TriangleMesh;
+class BVH;
+class BVHNode;
+struct BVHCacheHeader;
+struct BVHCacheNode;
+
+// Cache em disco de BVH: ns e tringulos reordenados por folha, validados por hash
+// do contedo da geometria e mapeados em memria (mmap / CreateFileMapping) sem cpia
+class BVHCache {
+private:
+    void * data; // Incio do arquivo mapeado em memria
+    size_t size; // Tamanho do arquivo em bytes
+    void * mapping; // Identificador do mapeamento (Windows)
+    const BVHCacheHeader * header; // Cabealho do arquivo
+    const BVHCacheNode * nodes; // Lista de ns em ordem de profundidade
+    const uint32_t * indices; // ndices originais dos tringulos por referncia
+    const double * triangles; // Vrtices dos tringulos por referncia (9 valores por tringulo)
+
+    // Retorna se referncias dos ns esto dentro dos limites das sees
+    bool validate() const;
+
+    // Cpia no permitida (arquivo mapeado pertence a um nico objeto)
+    BVHCache(const BVHCache & bvhCache);
+    BVHCache & operator =(const BVHCache & bvhCache);
+
+public:
+    // Construtor padro (cache fechado)
+    BVHCache();
+    // Destrutor (desfaz mapeamento)
+    ~BVHCache();
+
+    // Sobrecarga da operao "sada << cache" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const BVHCache & rhs);
+
+    // Retorna hash de 64 bits do contedo da geometria (vrtices e ndices de vrtices)
+    static uint64_t computeHash(const TriangleMesh * triangleMesh);
+    // Escreve hierarquia e tringulos reordenados em arquivo
+    static bool write(const std::string & filename, const BVH & bvh, uint64_t hash);
+
+    // Mapeia arquivo em memria e valida formato, hash (hash zero aceita qualquer geometria)
+    // e referncias dos ns (filhos, intervalos das folhas e profundidade dentro dos limites)
+    bool open(const std::string & filename, uint64_t hash = 0);
+    // Desfaz mapeamento
+    void close();
+    // Retorna se cache est aberto
+    bool isOpen() const;
+
+    // Retorna hash da geometria armazenado no arquivo
+    uint64_t getHash() const;
+    // Retorna nmero de tringulos da geometria original
+    size_t getTriangleCount() const;
+    // Retorna nmero de ns
+    size_t getNodeCount() const;
+    // Retorna tamanho do arquivo em bytes
+    size_t getSize() const;
+    // Copia ns e ndices originais das referncias (carregamento em hierarquia em memria)
+    bool read(std::vector<BVHNode> & bvhNodes, std::vector<size_t> & bvhIndices) const;
+
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_BOUNDING_BOX_H
+#define AURORA_BOUNDING_BOX_H
+
+#include <aurora/Global.h>
+#include <aurora/Vector.h>
+
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+
+// Caixa delimitadora alinhada aos eixos
+class BoundingBox3 {
+public:
+    // Limites da caixa
+    Vector3 min, max;
+
+    // Construtor padro (caixa vazia)
+    BoundingBox3();
+    // Construtor cpia
+    BoundingBox3(const BoundingBox3 & boundingBox3);
+    // Construtor para valores iniciais
+    BoundingBox3(const Vector3 & min, const Vector3 & max);
+    // Destrutor padro
+    ~BoundingBox3();
+
+    // Sobrecarga da operao "caixaA == caixaB"
+    bool operator ==(const BoundingBox3 & rhs) const;
+    // Sobrecarga da operao "caixaA != caixaB"
+    bool operator !=(const BoundingBox3 & rhs) const;
+    // Sobrecarga da operao "sada << caixa" (imprimir sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const BoundingBox3 & rhs);
+
+    // Expande caixa para conter ponto
+    BoundingBox3 & expand(const Vector3 & point);
+    // Expande caixa para conter outra caixa
+    BoundingBox3 & expand(const BoundingBox3 & boundingBox3);
+    // Retorna centro da caixa
+    Vector3 getCenter() const;
+    // Retorna dimenses da caixa
+    Vector3 getSize() const;
+    // Retorna rea de superfcie
+    double getSurfaceArea() const;
+    // Retorna ndice do eixo de maior extenso
+    size_t getMaximumExtent() const;
+    // Retorna se caixa  vazia
+    bool isEmpty() const;
+    // Retorna se raio intersecta caixa e o intervalo paramtrico de entrada e sada (teste de "slabs")
+    bool intersects(const Ray3 & ray3, double & near, double & far) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -98,6 +98,8 @@ public:
     Color3 & applyExposure(double exposure);
     // Satura cor (linear)
     Color3 & saturate();
+    // Retorna luminncia da cor (linear, coeficientes Rec. 709)
+    double luminance() const;
 };
 
 // Cor RGBA linear
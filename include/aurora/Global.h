@@ -46,4 +46,15 @@
 #define AURORA_NAMESPACE_END };
 #define AURORA_NAMESPACE_USING using namespace aurora;
 
+// Desabilita contrao de multiplicao e soma em FMA no restante do arquivo (habilitada pelo compilador
+// com "-mfma", AVX-512 ou "-march=native"): usada nos arquivos dos testes de interseo, cujos resultados
+// devem ser iguais em todos os caminhos e conjuntos de instrues
+#if defined(__clang__)
+#define AURORA_FP_CONTRACT_OFF _Pragma("STDC FP_CONTRACT OFF")
+#elif defined(__GNUC__)
+#define AURORA_FP_CONTRACT_OFF _Pragma("GCC optimize(\"fp-contract=off\")")
+#else
+#define AURORA_FP_CONTRACT_OFF
+#endif
+
 #endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_INSTANCE_H
+#define AURORA_INSTANCE_H
+
+#include <aurora/Global.h>
+#include <aurora/Matrix.h>
+#include <aurora/BoundingBox.h>
+#include <aurora/BVH.h>
+
+#include <vector>
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+class RayHit;
+
+// Instncia de geometria: hierarquia compartilhada posicionada por uma transformao
+class Instance {
+public:
+    const BVH * bvh; // Hierarquia da geometria em espao de objeto (no pertence  instncia)
+    Matrix4 transform; // Transformao de espao de objeto para espao de mundo
+    Matrix4 inverseTransform; // Transformao inversa (pr-calculada para levar raios ao espao de objeto)
+
+    // Construtor padro (instncia vazia)
+    Instance();
+    // Construtor cpia
+    Instance(const Instance & instance);
+    // Construtor para valores iniciais (calcula transformao inversa)
+    Instance(const BVH * bvh, const Matrix4 & transform);
+    // Destrutor padro
+    ~Instance();
+
+    // Retorna caixa delimitadora em espao de mundo
+    BoundingBox3 getBoundingBox() const;
+    // Retorna se raio (em espao de mundo) intersecta a geometria e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+};
+
+// Hierarquia de dois nveis: BVH de topo sobre as caixas das instncias,
+// cada uma referenciando a BVH (construda uma nica vez) de sua geometria
+class InstanceBVH {
+private:
+    std::vector<Instance> instances; // Lista de instncias
+    BVH bvh; // Hierarquia de topo (ndices referem-se s instncias)
+
+public:
+    // Construtor padro (hierarquia vazia)
+    InstanceBVH();
+    // Construtor cpia
+    InstanceBVH(const InstanceBVH & instanceBVH);
+    // Destrutor padro
+    ~InstanceBVH();
+
+    // Sobrecarga da operao "sada << hierarquia" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const InstanceBVH & rhs);
+
+    // Adiciona instncia e retorna seu ndice (aplicado na prxima construo)
+    size_t addInstance(const BVH * bvh, const Matrix4 & transform);
+    // Remove todas as instncias
+    InstanceBVH & clear();
+    // Retorna instncia
+    const Instance & getInstance(size_t i) const;
+    // Retorna nmero de instncias
+    size_t getInstanceCount() const;
+    // Retorna hierarquia de topo
+    const BVH & getBVH() const;
+    // Retorna memria ocupada pelas instncias e pela hierarquia de topo em bytes
+    size_t getMemorySize() const;
+
+    // Constri hierarquia de topo sobre as caixas das instncias
+    InstanceBVH & build(BVHBuildMethod buildMethod = BVHBuildMethod::BinnedSAH);
+    // Retorna se raio intersecta alguma instncia e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -39,6 +39,7 @@
 #define AURORA_EPSILON 2.2204460492503131e-016
 #define AURORA_INFINITY 1.7976931348623158e+308
 #define AURORA_THRESHOLD 1.0000000000000000e-006
+#define AURORA_SLAB_ROUNDING 1.0000000000000007 // Fator conservador (1 + 2 * gamma(3)) para teste de caixas
 
 AURORA_NAMESPACE_BEGIN // Incio do "namespace" da biblioteca
 
@@ -0,0 +1,73 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_RANDOM_H
+#define AURORA_RANDOM_H
+
+#include <aurora/Global.h>
+
+#include <cstdint>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Gerador congruencial permutado PCG32 (estado de 64 bits, sada de 32 bits, sequncias independentes)
+class PCG32 {
+private:
+    uint64_t state; // Estado do gerador
+    uint64_t increment; // Incremento mpar (seleciona a sequncia)
+
+public:
+    // Construtor para valores iniciais
+    PCG32(uint64_t seed = 0, uint64_t sequence = 0);
+    // Construtor cpia
+    PCG32(const PCG32 & pcg32);
+    // Destrutor padro
+    ~PCG32();
+
+    // Reinicia gerador com semente e sequncia
+    PCG32 & setSeed(uint64_t seed, uint64_t sequence);
+    // Retorna sequncia do gerador
+    uint64_t getSequence() const;
+
+    // Retorna prximo inteiro de 32 bits
+    uint32_t nextUInt();
+    // Retorna prxima amostra uniforme no intervalo real "[0, 1)"
+    double nextDouble();
+};
+
+// Retorna inteiro aleatrio de 32 bits sem estado, funo apenas de pixel, ndice da amostra, dimenso e semente
+// (mesmos argumentos sempre geram o mesmo valor, em qualquer thread e ordem)
+uint32_t hashRandom(uint64_t pixel, uint32_t sampleIndex, uint32_t dimension, uint32_t seed = 0);
+// Retorna amostra uniforme sem estado no intervalo real "[0, 1)" (ver "hashRandom")
+double hashUniform(uint64_t pixel, uint32_t sampleIndex, uint32_t dimension, uint32_t seed = 0);
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
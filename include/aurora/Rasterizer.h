@@ -0,0 +1,89 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_RASTERIZER_H
+#define AURORA_RASTERIZER_H
+
+#include <aurora/Global.h>
+#include <aurora/Matrix.h>
+
+#include <vector>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Vector2;
+class RayHit;
+class TriangleMesh;
+
+// Rasterizador da visibilidade primria de uma cmera pinhole (buffer de visibilidade): tringulo visvel,
+// coordenadas baricntricas e distncia por pixel, com teste de profundidade em blocos de pixels
+// processados em paralelo. Funes de aresta homogneas (planos pela cmera) dispensam recorte e so
+// exatamente opostas em arestas compartilhadas (sem frestas entre tringulos vizinhos)
+class Rasterizer {
+private:
+    Matrix4 worldMatrix; // Transformao da cmera para o mundo (eixos nas linhas 0 a 2, posio na linha 3; cmera olha para "-z")
+    double fieldOfView; // Campo de viso vertical em radianos
+    size_t width, height; // Resoluo em pixels
+    size_t tileSize; // Lado dos blocos de pixels
+    size_t threadCount; // Nmero de threads (zero usa todos os ncleos)
+
+public:
+    // Construtor padro (cmera na origem olhando para "-z", resoluo nula)
+    Rasterizer();
+    // Construtor cpia
+    Rasterizer(const Rasterizer & rasterizer);
+    // Destrutor padro
+    ~Rasterizer();
+
+    // Configura cmera (mesma conveno dos raios de cmera: ponto "(xc, yc, -1)" transformado pela matriz)
+    Rasterizer & setCamera(const Matrix4 & worldMatrix, double fieldOfView, size_t width, size_t height);
+    // Configura lado dos blocos de pixels
+    Rasterizer & setTileSize(size_t tileSize);
+    // Retorna lado dos blocos de pixels
+    size_t getTileSize() const;
+    // Configura nmero de threads (zero usa todos os ncleos)
+    Rasterizer & setThreadCount(size_t threadCount);
+    // Retorna nmero de threads
+    size_t getThreadCount() const;
+    // Retorna largura em pixels
+    size_t getWidth() const;
+    // Retorna altura em pixels
+    size_t getHeight() const;
+
+    // Rasteriza tringulos da geometria com amostra de cada pixel "(x, y)" deslocada do centro por
+    // "samples[y * largura + x]" (em [-0.5, 0.5), nulo usa centros): visibilidade em "rayHits" na mesma
+    // ordem (distncia ao longo da direo normalizada do raio de cmera; pixels vazios sem interseo)
+    void rasterize(const TriangleMesh * triangleMesh, const Vector2 * samples, std::vector<RayHit> & rayHits) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
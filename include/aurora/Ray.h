@@ -0,0 +1,91 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_RAY_H
+#define AURORA_RAY_H
+
+#include <aurora/Global.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Raio definido por origem, direo e intervalo paramtrico "[minimum, maximum]"
+class Ray3 {
+public:
+    Vector3 origin; // Origem do raio
+    Vector3 direction; // Direo do raio
+    Vector3 inverseDirection; // Inverso da direo por componente (pr-calculado para teste de caixas)
+    double minimum; // Distncia mnima vlida
+    double maximum; // Distncia mxima vlida
+
+    // Construtor padro (raio nulo)
+    Ray3();
+    // Construtor cpia
+    Ray3(const Ray3 & ray3);
+    // Construtor para valores iniciais
+    Ray3(const Vector3 & origin, const Vector3 & direction,
+        double minimum = AURORA_EPSILON, double maximum = AURORA_INFINITY);
+    // Destrutor padro
+    ~Ray3();
+
+    // Sobrecarga da operao "raio(t)" (ponto na distncia "t")
+    Vector3 operator ()(double t) const;
+    // Sobrecarga da operao "sada << raio" (imprimir sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const Ray3 & rhs);
+
+    // Configura direo e recalcula seu inverso
+    Ray3 & setDirection(const Vector3 & direction);
+};
+
+// Resultado de interseo entre raio e primitiva
+class RayHit {
+public:
+    double distance; // Distncia paramtrica da interseo
+    double u, v; // Coordenadas baricntricas em relao aos vrtices 1 e 2
+    size_t index; // ndice da primitiva intersectada
+    size_t instance; // ndice da instncia intersectada (cenas com instncias)
+
+    // Construtor padro (sem interseo)
+    RayHit();
+    // Construtor cpia
+    RayHit(const RayHit & rayHit);
+    // Destrutor padro
+    ~RayHit();
+
+    // Retorna se houve interseo
+    bool hasHit() const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
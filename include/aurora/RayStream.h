@@ -0,0 +1,95 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_RAYSTREAM_H
+#define AURORA_RAYSTREAM_H
+
+#include <aurora/Global.h>
+#include <aurora/Ray.h>
+
+#include <vector>
+#include <cstdint>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class BVH;
+class WideBVH;
+class Accelerator;
+
+// Fluxo de raios incoerentes (raios secundrios): raios acumulados so ordenados por octante da direo,
+// clula da origem e direo (cdigos de Morton) e traados nessa ordem, com resultados devolvidos
+// na ordem de insero
+class RayStream {
+private:
+    std::vector<Ray3> rays; // Raios na ordem de insero
+    std::vector<uint64_t> keys; // Chaves de ordenao (octante, origem e direo)
+    std::vector<size_t> order; // ndices dos raios em ordem coerente
+    bool sorted; // Ordem coerente atualizada
+
+    // Calcula chaves e ordena raios (se necessrio)
+    void sort();
+
+public:
+    // Construtor padro (fluxo vazio)
+    RayStream();
+    // Construtor cpia
+    RayStream(const RayStream & rayStream);
+    // Destrutor padro
+    ~RayStream();
+
+    // Adiciona raio ao fluxo e retorna seu ndice
+    size_t add(const Ray3 & ray3);
+    // Remove todos os raios
+    void clear();
+    // Retorna nmero de raios
+    size_t getRayCount() const;
+    // Retorna raio pelo ndice de insero
+    const Ray3 & getRay(size_t i) const;
+    // Retorna ndices dos raios em ordem coerente
+    const std::vector<size_t> & getOrder();
+
+    // Intersecta raios em ordem coerente (resultados indexados pela ordem de insero)
+    void intersect(const BVH & bvh, RayHit * rayHits, bool * hits);
+    // Intersecta raios em ordem coerente (resultados indexados pela ordem de insero)
+    void intersect(const WideBVH & wideBVH, RayHit * rayHits, bool * hits);
+    // Intersecta raios em ordem coerente (resultados indexados pela ordem de insero)
+    void intersect(const Accelerator & accelerator, RayHit * rayHits, bool * hits);
+    // Testa ocluso dos raios em ordem coerente (resultados indexados pela ordem de insero)
+    void occluded(const BVH & bvh, bool * results);
+    // Testa ocluso dos raios em ordem coerente (resultados indexados pela ordem de insero)
+    void occluded(const WideBVH & wideBVH, bool * results);
+    // Testa ocluso dos raios em ordem coerente (resultados indexados pela ordem de insero)
+    void occluded(const Accelerator & accelerator, bool * results);
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
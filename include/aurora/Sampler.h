@@ -0,0 +1,108 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_SAMPLER_H
+#define AURORA_SAMPLER_H
+
+#include <aurora/Global.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Vector2;
+
+// Tipo de sequncia de amostras
+enum class SamplerType {
+    Independent, // Amostras independentes (convergncia de Monte Carlo)
+    Sobol, // Sequncia de Sobol com embaralhamento de Owen por pixel e dimenso
+    Halton // Sequncia de Halton com embaralhamento de Owen por pixel e dimenso
+};
+
+// Amostrador de caminhos: cada amostra de pixel consome dimenses em sequncia, com valores gerados sem estado
+// a partir de pixel, ndice da amostra e dimenso (resultado independe da thread e da ordem dos pixels);
+// dimenses alm das tabelas das sequncias de baixa discrepncia usam amostras independentes
+class Sampler {
+private:
+    SamplerType type; // Tipo de sequncia
+    uint32_t seed; // Semente (imagens diferentes com mesmas amostras)
+    uint64_t pixel; // Pixel da amostra atual (linha nos 32 bits altos)
+    uint32_t sampleIndex; // ndice da amostra atual no pixel
+    uint32_t dimension; // Prxima dimenso da amostra atual
+
+public:
+    // Construtor para valores iniciais
+    Sampler(SamplerType type = SamplerType::Independent, uint32_t seed = 0);
+    // Construtor cpia
+    Sampler(const Sampler & sampler);
+    // Destrutor padro
+    ~Sampler();
+
+    // Configura tipo de sequncia
+    Sampler & setType(SamplerType type);
+    // Retorna tipo de sequncia
+    SamplerType getType() const;
+    // Configura semente
+    Sampler & setSeed(uint32_t seed);
+    // Retorna semente
+    uint32_t getSeed() const;
+    // Configura prxima dimenso da amostra atual (blocos fixos de dimenses por etapa do caminho)
+    Sampler & setDimension(size_t dimension);
+    // Retorna ndice da amostra atual no pixel
+    size_t getSampleIndex() const;
+    // Retorna prxima dimenso da amostra atual
+    size_t getDimension() const;
+
+    // Inicia amostra de pixel (dimenses recomeam do zero)
+    void startPixelSample(size_t x, size_t y, size_t sampleIndex);
+    // Retorna prxima dimenso da amostra no intervalo real "[0, 1)"
+    double get1D();
+    // Retorna prximas duas dimenses da amostra no intervalo real "[0, 1)"
+    Vector2 get2D();
+};
+
+// Retorna nmero de dimenses da sequncia de Sobol (matrizes geradoras de Joe e Kuo)
+size_t getSobolDimensionCount();
+// Retorna coordenada de ponto da sequncia de Sobol em 32 bits (dimenso menor que "getSobolDimensionCount")
+uint32_t sobolSample(uint32_t index, uint32_t dimension);
+// Retorna nmero de dimenses da sequncia de Halton (uma base prima por dimenso)
+size_t getHaltonDimensionCount();
+// Retorna coordenada de ponto da sequncia de Halton no intervalo real "[0, 1)", com dgitos permutados
+// por embaralhamento de Owen da semente (dimenso menor que "getHaltonDimensionCount")
+double haltonSample(uint32_t index, uint32_t dimension, uint32_t seed);
+// Embaralhamento de Owen em base 2: cada bit invertido conforme hash da semente e dos bits mais significativos
+// (estratificao da sequncia preservada)
+uint32_t owenScramble(uint32_t value, uint32_t seed);
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_THREAD_POOL_H
+#define AURORA_THREAD_POOL_H
+
+#include <aurora/Global.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Conjunto de threads persistentes com roubo de trabalho: cada thread comea com uma faixa contgua
+// das tarefas e, ao esvazi-la, rouba metade da faixa restante de outra thread
+class ThreadPool {
+private:
+    // Faixa de tarefas restantes de uma thread (consumida pelo incio, roubada pelo fim)
+    struct Queue {
+        std::mutex mutex;
+        size_t begin;
+        size_t end;
+    };
+
+    size_t threadCount; // Nmero de threads (incluindo a thread que chama "run")
+    std::vector<std::thread> threads; // Threads auxiliares
+    std::unique_ptr<Queue[]> queues; // Faixa de tarefas de cada thread
+    const std::function<void(size_t, size_t)> * function; // Tarefa em execuo
+    std::mutex mutex; // Protege estado de sincronizao
+    std::condition_variable started; // Sinaliza nova execuo (ou encerramento)
+    std::condition_variable finished; // Sinaliza fim das threads auxiliares
+    size_t generation; // Nmero da execuo atual
+    size_t running; // Threads auxiliares ainda executando
+    bool stopping; // Threads auxiliares devem encerrar
+    std::atomic<size_t> stealCount; // Faixas roubadas desde a criao
+
+    // Cria threads auxiliares
+    void create(size_t threadCount);
+    // Lao das threads auxiliares
+    void work(size_t thread);
+    // Executa tarefas da prpria faixa e roubadas at no restar nenhuma
+    void execute(size_t thread);
+
+public:
+    // Construtor para valores iniciais (zero usa todos os ncleos)
+    ThreadPool(size_t threadCount = 0);
+    // Construtor cpia (novas threads em mesmo nmero)
+    ThreadPool(const ThreadPool & threadPool);
+    // Destrutor padro (encerra threads)
+    ~ThreadPool();
+
+    // Retorna nmero de threads
+    size_t getThreadCount() const;
+    // Retorna nmero de faixas roubadas desde a criao
+    size_t getStealCount() const;
+
+    // Executa "function(thread, task)" para cada tarefa em [0, taskCount) e aguarda o fim
+    // (thread em [0, getThreadCount()) identifica dados por thread; execues no podem ser aninhadas)
+    void run(size_t taskCount, const std::function<void(size_t, size_t)> & function);
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
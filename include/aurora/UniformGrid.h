@@ -0,0 +1,129 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_UNIFORMGRID_H
+#define AURORA_UNIFORMGRID_H
+
+#include <aurora/Global.h>
+#include <aurora/Accelerator.h>
+
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Clula de grade: intervalo de referncias a tringulos ou grade aninhada
+class UniformGridCell {
+public:
+    uint32_t offset; // ndice da primeira referncia
+    uint32_t count; // Nmero de referncias (zero em clulas vazias ou com grade aninhada)
+    int32_t grid; // ndice da grade aninhada (-1 se ausente)
+};
+
+// Nvel de grade: caixa delimitadora dividida em clulas de mesmo tamanho
+class UniformGridLevel {
+public:
+    double min[3], max[3]; // Caixa delimitadora
+    double cellSize[3]; // Tamanho das clulas por eixo
+    double inverseCellSize[3]; // Inverso do tamanho das clulas por eixo
+    uint32_t resolution[3]; // Nmero de clulas por eixo
+    uint32_t cellOffset; // ndice da primeira clula na lista de clulas
+};
+
+// Grade uniforme hierrquica sobre os tringulos de uma geometria: clulas com muitos tringulos
+// recebem grade aninhada; travessia por 3D-DDA com trmino antecipado
+class UniformGrid : public Accelerator {
+private:
+    const TriangleMesh * triangleMesh; // Geometria referenciada (no pertence  grade)
+    std::vector<UniformGridLevel> grids; // Grades (raiz primeiro)
+    std::vector<UniformGridCell> cells; // Clulas de todas as grades
+    std::vector<uint32_t> indices; // Referncias a tringulos ordenadas por clula
+    double density; // Nmero desejado de clulas por tringulo
+    size_t maximumCellSize; // Nmero de tringulos a partir do qual clula recebe grade aninhada
+    size_t maximumDepth; // Nmero mximo de nveis aninhados
+    size_t buildTime; // Tempo da ltima construo em milisegundos
+
+    // Constri grade sobre tringulos indicados e retorna seu ndice (-1 se grade aninhada no separa tringulos)
+    int32_t buildLevel(const std::vector<double> & boxes, const double * min, const double * max,
+        const std::vector<uint32_t> & triangles, size_t depth);
+    // Percorre grade no intervalo paramtrico (interseo mais prxima ou qualquer interseo)
+    bool traverse(size_t grid, const Ray3 & ray3, double t0, double t1, double & maximum,
+        RayHit * rayHit) const;
+
+protected:
+    // Imprime informaes da estrutura
+    void print(std::ostream & output) const;
+
+public:
+    // Construtor padro (grade vazia)
+    UniformGrid();
+    // Construtor cpia
+    UniformGrid(const UniformGrid & uniformGrid);
+    // Destrutor padro
+    ~UniformGrid();
+
+    // Configura nmero desejado de clulas por tringulo (aplicado na prxima construo)
+    UniformGrid & setDensity(double density);
+    // Retorna nmero desejado de clulas por tringulo
+    double getDensity() const;
+    // Configura nmero de tringulos a partir do qual clula recebe grade aninhada
+    UniformGrid & setMaximumCellSize(size_t maximumCellSize);
+    // Retorna nmero de tringulos a partir do qual clula recebe grade aninhada
+    size_t getMaximumCellSize() const;
+    // Retorna nmero de grades (raiz e aninhadas)
+    size_t getGridCount() const;
+    // Retorna nmero de clulas
+    size_t getCellCount() const;
+    // Retorna nmero de referncias a tringulos
+    size_t getReferenceCount() const;
+    // Retorna tempo da ltima construo em milisegundos
+    size_t getBuildTime() const;
+
+    // Retorna tipo da estrutura
+    AcceleratorType getType() const;
+    // Retorna memria ocupada pela estrutura em bytes
+    size_t getMemorySize() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+
+    using Accelerator::intersect;
+
+    // Constri grade sobre os tringulos da geometria
+    void build(const TriangleMesh * triangleMesh);
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
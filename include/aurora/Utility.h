@@ -62,12 +62,44 @@ Vector3 barycentric(
 Vector3 calculateNormal(
     const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2);
 
+// Mtodo de interseo raio/tringulo usado por "intersectTriangle"
+enum class TriangleIntersection {
+    MollerTrumbore, // Mller-Trumbore em preciso dupla com tolerncia fixa no determinante
+    Watertight // Teste estanque em preciso simples (Woop, Benthin e Wald): sem frestas entre tringulos vizinhos
+};
+
+// Seleciona mtodo de interseo raio/tringulo (global, padro Mller-Trumbore)
+void setTriangleIntersection(TriangleIntersection triangleIntersection);
+// Retorna mtodo de interseo raio/tringulo selecionado
+TriangleIntersection getTriangleIntersection();
+// Retorna margem espacial que mantm conservadores os testes de caixas em preciso dupla para o mtodo selecionado,
+// dados os limites da geometria e a origem do raio: zero com Mller-Trumbore; com o teste estanque, limite do erro
+// dos vrtices relativos  origem em preciso simples (o tringulo aceito pode estar fora da caixa justa do raio)
+double getTriangleIntersectionMargin(const double * min, const double * max, const Vector3 & origin);
+
+// Retorna se raio intersecta tringulo pelo mtodo selecionado, com distncia e coordenadas baricntricas
+bool intersectTriangle(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v);
+// Retorna se raio intersecta tringulo (Mller-Trumbore), com distncia e coordenadas baricntricas
+bool intersectTriangleMollerTrumbore(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v);
+// Retorna se raio intersecta tringulo (teste estanque em preciso simples, recalculado em preciso
+// dupla apenas quando o raio passa exatamente sobre uma aresta), com distncia e coordenadas baricntricas
+bool intersectTriangleWatertight(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v);
+
 // Retorna tempo atual em milisegundos (geralmente desde 00:00 horas de 1 de janeiro de 1970 UTC)
 size_t time();
 
-// Inicializa gerador de amostras com semente aleatria
+// Inicializa gerador de amostras da thread atual com semente aleatria
 void randomSeed(size_t seed);
-// Retorna amostra aleatria uniforme no intervalo real "[0, 1)"
+// Retorna amostra aleatria uniforme no intervalo real "[0, 1)" (gerador PCG32 prprio de cada thread)
 double uniformRandom();
 // Retorna amostra aletria uniforme (ponto 2D) dentro de crculo de raio unitrio
 Vector2 uniformSampleDisk(const Vector2 & sample);
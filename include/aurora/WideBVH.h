@@ -0,0 +1,174 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_WIDE_BVH_H
+#define AURORA_WIDE_BVH_H
+
+#include <aurora/Global.h>
+
+#include <vector>
+#include <ostream>
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class Ray3;
+class RayHit;
+class TriangleMesh;
+class BVH;
+
+// N de BVH larga com "N" filhos: caixas em layout SoA de preciso simples (uma instruo SIMD testa todos os filhos)
+template <size_t N>
+class WideBVHNode {
+public:
+    float bounds[6][N]; // Limites mnimos (x, y, z) e mximos (x, y, z) de cada filho
+    unsigned int children[N]; // ndice do n filho (n interno) ou da primeira primitiva (folha)
+    unsigned int counts[N]; // Nmero de primitivas do filho (zero em ns internos)
+    unsigned char order[8][N]; // Ordem de visita dos filhos por octante da direo do raio
+    unsigned char childCount; // Nmero de filhos vlidos
+};
+
+// Bloco de 4 tringulos em layout SoA de preciso simples para o filtro das folhas (vrtice 0 e arestas
+// pr-calculadas), alinhado a 16 bytes. Candidatos do filtro so confirmados com os vrtices da malha
+class alignas(16) TriangleBlock {
+public:
+    float vertex[3][4]; // Vrtice 0 (x, y, z) de cada tringulo
+    float edges[6][4]; // Arestas "vrtice 1 - vrtice 0" (x, y, z) e "vrtice 2 - vrtice 0" (x, y, z)
+};
+
+// Retorna nmero de tringulos testados por instruo (16 com AVX-512, 8 com AVX, 4 com SSE ou escalar)
+size_t getTriangleBlockWidth();
+// Intersecta raio com "count" tringulos consecutivos dos blocos em preciso simples: retorna posio
+// do tringulo mais prximo no intervalo do raio (-1 se nenhum), distncia e coordenadas baricntricas
+int intersectTriangleBlocks(const TriangleBlock * blocks, size_t count, const Ray3 & ray3,
+    float & distance, float & u, float & v);
+// Referncia escalar de "intersectTriangleBlocks" (mesma aritmtica, para validao)
+int intersectTriangleBlocksReference(const TriangleBlock * blocks, size_t count, const Ray3 & ray3,
+    float & distance, float & u, float & v);
+
+// BVH larga (4 ou 8 filhos por n) obtida pelo colapso de uma BVH binria
+class WideBVH {
+private:
+    const TriangleMesh * triangleMesh; // Geometria referenciada (no pertence  hierarquia)
+    std::vector<size_t> indices; // Lista de ndices de tringulos ordenados por folha
+    std::vector<TriangleBlock> triangles; // Blocos do filtro de tringulos na ordem dos ndices
+    std::vector<WideBVHNode<4> > nodes4; // Lista de ns com 4 filhos
+    std::vector<WideBVHNode<8> > nodes8; // Lista de ns com 8 filhos
+    size_t width; // Nmero de filhos por n
+
+public:
+    // Construtor padro (hierarquia vazia)
+    WideBVH();
+    // Construtor cpia
+    WideBVH(const WideBVH & wideBVH);
+    // Construtor que colapsa hierarquia binria
+    WideBVH(const BVH & bvh, size_t width = 4);
+    // Destrutor padro
+    ~WideBVH();
+
+    // Sobrecarga da operao "sada << hierarquia" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const WideBVH & rhs);
+
+    // Retorna nmero de filhos por n
+    size_t getWidth() const;
+    // Retorna nmero de ns
+    size_t getNodeCount() const;
+    // Retorna memria ocupada pelos ns, ndices e blocos de tringulos em bytes
+    size_t getMemorySize() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+
+    // Constri hierarquia larga colapsando hierarquia binria (largura 4 ou 8)
+    WideBVH & build(const BVH & bvh, size_t width);
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+    // Intersecta pacote de raios coerentes em grupos de at 64 (grupos divergentes seguem raio a raio)
+    void intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const;
+};
+
+// N quantizado de BVH larga: caixas dos filhos em 8 bits relativas  caixa do n
+// (origem em preciso simples e escala potncia de 2 por eixo) e filhos contguos
+template <size_t N>
+class QuantizedBVHNode {
+public:
+    float origin[3]; // Canto mnimo da caixa do n
+    signed char exponents[3]; // Expoente da escala de quantizao de cada eixo
+    unsigned char childCount; // Nmero de filhos vlidos
+    unsigned int nodeBase; // ndice do primeiro filho interno (filhos internos so contguos)
+    unsigned int primitiveBase; // ndice da primeira primitiva das folhas (primitivas das folhas so contguas)
+    unsigned char counts[N]; // Nmero de primitivas do filho (zero em ns internos)
+    unsigned char bounds[6][N]; // Limites quantizados mnimos (x, y, z) e mximos (x, y, z) de cada filho
+};
+
+// BVH larga com ns quantizados (4 ou 8 filhos por n), obtida pelo colapso de uma BVH binria
+// (folhas com mais de 255 tringulos divididas em ns adicionais)
+class QuantizedBVH {
+private:
+    const TriangleMesh * triangleMesh; // Geometria referenciada (no pertence  hierarquia)
+    std::vector<unsigned int> indices; // Lista de ndices de tringulos ordenados por folha
+    std::vector<QuantizedBVHNode<4> > nodes4; // Lista de ns com 4 filhos
+    std::vector<QuantizedBVHNode<8> > nodes8; // Lista de ns com 8 filhos
+    size_t width; // Nmero de filhos por n
+
+public:
+    // Construtor padro (hierarquia vazia)
+    QuantizedBVH();
+    // Construtor cpia
+    QuantizedBVH(const QuantizedBVH & quantizedBVH);
+    // Construtor que colapsa e quantiza hierarquia binria
+    QuantizedBVH(const BVH & bvh, size_t width = 8);
+    // Destrutor padro
+    ~QuantizedBVH();
+
+    // Sobrecarga da operao "sada << hierarquia" (imprimir informaes na sada de dados)
+    friend std::ostream & operator <<(std::ostream & lhs, const QuantizedBVH & rhs);
+
+    // Retorna nmero de filhos por n
+    size_t getWidth() const;
+    // Retorna nmero de ns
+    size_t getNodeCount() const;
+    // Retorna memria ocupada pelos ns e ndices em bytes
+    size_t getMemorySize() const;
+    // Retorna geometria referenciada
+    const TriangleMesh * getTriangleMesh() const;
+
+    // Constri hierarquia quantizada colapsando hierarquia binria (largura 4 ou 8)
+    QuantizedBVH & build(const BVH & bvh, size_t width);
+    // Retorna se raio intersecta algum tringulo e a interseo mais prxima
+    bool intersect(const Ray3 & ray3, RayHit & rayHit) const;
+    // Retorna se raio intersecta algum tringulo no intervalo (encerra na primeira interseo)
+    bool occluded(const Ray3 & ray3) const;
+};
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,356 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Accelerator.h>
+#include <aurora/UniformGrid.h>
+#include <aurora/BVHCache.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Limiares da escolha automtica (medidos em cenas uniformes e agrupadas)
+const size_t bruteForceThreshold = 4; // Tringulos at os quais o teste exaustivo dispensa construo
+const size_t gridMinimum = 1024; // Tringulos a partir dos quais a construo da hierarquia pesa
+const size_t gridMaximum = 262144; // Tringulos a partir dos quais a travessia mais rpida da hierarquia compensa
+const double gridConcentration = 2.0; // Concentrao mxima de tringulos por clula ocupada para grade
+
+}
+
+Accelerator::~Accelerator() {}
+
+std::ostream & operator <<(std::ostream & lhs, const Accelerator & rhs) {
+    rhs.print(lhs);
+    return lhs;
+}
+
+void Accelerator::intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const {
+    for (size_t i = 0; i < count; i++)
+        hits[i] = intersect(ray3s[i], rayHits[i]);
+}
+
+BruteForceAccelerator::BruteForceAccelerator() : triangleMesh(nullptr) {}
+BruteForceAccelerator::BruteForceAccelerator(const BruteForceAccelerator & bruteForceAccelerator)
+    : triangleMesh(bruteForceAccelerator.triangleMesh) {}
+BruteForceAccelerator::~BruteForceAccelerator() {}
+
+void BruteForceAccelerator::print(std::ostream & output) const {
+    output << "Accelerator: brute force" << std::endl
+        << "Triangles: " << (triangleMesh != nullptr ? triangleMesh->getTriangleCount() : 0);
+}
+
+AcceleratorType BruteForceAccelerator::getType() const {
+    return AcceleratorType::BruteForce;
+}
+size_t BruteForceAccelerator::getMemorySize() const {
+    return 0;
+}
+const TriangleMesh * BruteForceAccelerator::getTriangleMesh() const {
+    return triangleMesh;
+}
+
+void BruteForceAccelerator::build(const TriangleMesh * triangleMesh) {
+    this->triangleMesh = triangleMesh;
+}
+bool BruteForceAccelerator::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (triangleMesh == nullptr)
+        return false;
+
+    const Vector3 * vertices = triangleMesh->getVertices().data();
+    const size_t * vertexIndices = triangleMesh->getVertexIndices().data();
+    double maximum = ray3.maximum;
+    bool hit = false;
+
+    for (size_t i = 0; i < triangleMesh->getTriangleCount(); i++) {
+        const size_t * v = &vertexIndices[3 * i];
+        double distance, u, w;
+
+        if (intersectTriangle(ray3.origin, ray3.direction, vertices[v[0]], vertices[v[1]], vertices[v[2]],
+            distance, u, w) && distance > ray3.minimum && distance < maximum) {
+            maximum = distance;
+            hit = true;
+
+            rayHit.distance = distance;
+            rayHit.u = u;
+            rayHit.v = w;
+            rayHit.index = i;
+        }
+    }
+
+    return hit;
+}
+bool BruteForceAccelerator::occluded(const Ray3 & ray3) const {
+    if (triangleMesh == nullptr)
+        return false;
+
+    const Vector3 * vertices = triangleMesh->getVertices().data();
+    const size_t * vertexIndices = triangleMesh->getVertexIndices().data();
+
+    for (size_t i = 0; i < triangleMesh->getTriangleCount(); i++) {
+        const size_t * v = &vertexIndices[3 * i];
+        double distance, u, w;
+
+        if (intersectTriangle(ray3.origin, ray3.direction, vertices[v[0]], vertices[v[1]], vertices[v[2]],
+            distance, u, w) && distance > ray3.minimum && distance < ray3.maximum)
+            return true;
+    }
+
+    return false;
+}
+
+BVHAccelerator::BVHAccelerator(BVHBuildMethod buildMethod, size_t width, bool quantized)
+    : width(quantized ? (width >= 8 ? 8 : 4) : width), quantized(quantized), cached(false) {
+    bvh.setBuildMethod(buildMethod);
+}
+BVHAccelerator::BVHAccelerator(const BVHAccelerator & bvhAccelerator)
+    : bvh(bvhAccelerator.bvh), wideBVH(bvhAccelerator.wideBVH), quantizedBVH(bvhAccelerator.quantizedBVH),
+    width(bvhAccelerator.width), quantized(bvhAccelerator.quantized), cached(bvhAccelerator.cached) {}
+BVHAccelerator::~BVHAccelerator() {}
+
+void BVHAccelerator::print(std::ostream & output) const {
+    output << "Accelerator: " << (quantized ? "quantized BVH" : "BVH") << std::endl << bvh;
+
+    if (cached)
+        output << std::endl << "Cache: loaded";
+
+    if (quantized)
+        output << std::endl << quantizedBVH;
+    else if (width > 2)
+        output << std::endl << wideBVH;
+}
+
+AcceleratorType BVHAccelerator::getType() const {
+    return quantized ? AcceleratorType::QuantizedBVH : AcceleratorType::BVH;
+}
+size_t BVHAccelerator::getMemorySize() const {
+    size_t size = bvh.getNodeCount() * sizeof(BVHNode) + bvh.getIndices().size() * sizeof(size_t) +
+        bvh.getTriangleVertices().size() * sizeof(Vector3);
+
+    if (quantized)
+        return size + quantizedBVH.getMemorySize();
+
+    return width > 2 ? size + wideBVH.getMemorySize() : size;
+}
+const TriangleMesh * BVHAccelerator::getTriangleMesh() const {
+    return bvh.getTriangleMesh();
+}
+size_t BVHAccelerator::getWidth() const {
+    return width;
+}
+BVH & BVHAccelerator::getBVH() {
+    return bvh;
+}
+const BVH & BVHAccelerator::getBVH() const {
+    return bvh;
+}
+const WideBVH & BVHAccelerator::getWideBVH() const {
+    return wideBVH;
+}
+bool BVHAccelerator::isQuantized() const {
+    return quantized;
+}
+const QuantizedBVH & BVHAccelerator::getQuantizedBVH() const {
+    return quantizedBVH;
+}
+bool BVHAccelerator::isCached() const {
+    return cached;
+}
+
+void BVHAccelerator::collapse() {
+    if (quantized)
+        quantizedBVH.build(bvh, width);
+    else if (width > 2)
+        wideBVH.build(bvh, width);
+}
+
+void BVHAccelerator::build(const TriangleMesh * triangleMesh) {
+    cached = false;
+
+    bvh.build(triangleMesh);
+    collapse();
+}
+bool BVHAccelerator::build(const TriangleMesh * triangleMesh, const std::string & cacheFilename) {
+    if (triangleMesh == nullptr || triangleMesh->getTriangleCount() == 0 || cacheFilename.empty()) {
+        build(triangleMesh);
+        return false;
+    }
+
+    uint64_t hash = BVHCache::computeHash(triangleMesh);
+    BVHCache bvhCache;
+
+    cached = bvhCache.open(cacheFilename, hash) && bvh.load(triangleMesh, bvhCache);
+    bvhCache.close();
+
+    // Cache ausente, invlido ou de outra geometria: reconstruo substitui o arquivo
+    if (!cached) {
+        bvh.build(triangleMesh);
+        BVHCache::write(cacheFilename, bvh, hash);
+    }
+
+    collapse();
+
+    return cached;
+}
+BVHAccelerator & BVHAccelerator::reorder(BVHLayout layout, bool trianglePacking) {
+    bvh.setLayout(layout).setTrianglePacking(trianglePacking).reorder();
+    collapse();
+
+    return *this;
+}
+bool BVHAccelerator::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (quantized)
+        return quantizedBVH.intersect(ray3, rayHit);
+
+    return width > 2 ? wideBVH.intersect(ray3, rayHit) : bvh.intersect(ray3, rayHit);
+}
+bool BVHAccelerator::occluded(const Ray3 & ray3) const {
+    if (quantized)
+        return quantizedBVH.occluded(ray3);
+
+    return width > 2 ? wideBVH.occluded(ray3) : bvh.occluded(ray3);
+}
+void BVHAccelerator::intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const {
+    if (width > 2 && !quantized)
+        wideBVH.intersect(ray3s, count, rayHits, hits);
+    else
+        Accelerator::intersect(ray3s, count, rayHits, hits);
+}
+
+AcceleratorType chooseAccelerator(const TriangleMesh * triangleMesh) {
+    size_t triangleCount = triangleMesh != nullptr ? triangleMesh->getTriangleCount() : 0;
+
+    if (triangleCount <= bruteForceThreshold)
+        return AcceleratorType::BruteForce;
+
+    if (triangleCount < gridMinimum || triangleCount > gridMaximum)
+        return AcceleratorType::BVH;
+
+    // Centrides dos tringulos em grade grosseira (uma clula para cada 4 tringulos, eixos planos com uma clula)
+    std::vector<double> centroids(3 * triangleCount);
+    double min[3] = { AURORA_INFINITY, AURORA_INFINITY, AURORA_INFINITY };
+    double max[3] = { -AURORA_INFINITY, -AURORA_INFINITY, -AURORA_INFINITY };
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        size_t v[3];
+        triangleMesh->getVertexIndices(i, v[0], v[1], v[2]);
+
+        for (size_t k = 0; k < 3; k++) {
+            double centroid = (triangleMesh->getVertex(v[0])[k] + triangleMesh->getVertex(v[1])[k] +
+                triangleMesh->getVertex(v[2])[k]) / 3.0;
+
+            centroids[3 * i + k] = centroid;
+            min[k] = std::min(min[k], centroid);
+            max[k] = std::max(max[k], centroid);
+        }
+    }
+
+    double extent[3], maximumExtent = 0, area = 1.0, dimensions = 0;
+
+    for (size_t k = 0; k < 3; k++) {
+        extent[k] = max[k] - min[k];
+        maximumExtent = std::max(maximumExtent, extent[k]);
+    }
+
+    for (size_t k = 0; k < 3; k++) {
+        if (extent[k] > maximumExtent * 1e-3) {
+            area *= extent[k];
+            dimensions++;
+        }
+    }
+
+    if (dimensions == 0)
+        return AcceleratorType::BVH;
+
+    double factor = std::pow(triangleCount / 4.0 / area, 1.0 / dimensions);
+    size_t resolution[3];
+
+    for (size_t k = 0; k < 3; k++)
+        resolution[k] = extent[k] > maximumExtent * 1e-3 ?
+            (size_t)std::max(1.0, std::min(std::floor(extent[k] * factor + 0.5), 128.0)) : 1;
+
+    std::vector<uint32_t> counts(resolution[0] * resolution[1] * resolution[2], 0);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        size_t cell[3];
+
+        for (size_t k = 0; k < 3; k++) {
+            double t = extent[k] > 0 ? (centroids[3 * i + k] - min[k]) / extent[k] : 0;
+
+            cell[k] = std::min((size_t)(t * resolution[k]), resolution[k] - 1);
+        }
+
+        counts[(cell[2] * resolution[1] + cell[1]) * resolution[0] + cell[0]]++;
+    }
+
+    // Concentrao: ocupao mdia vista por um tringulo relativa  mdia das clulas ocupadas
+    // (1 em distribuio uniforme sobre as clulas ocupadas, cresce com aglomerados)
+    double occupied = 0, squares = 0;
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        occupied += counts[i] > 0 ? 1 : 0;
+        squares += (double)counts[i] * counts[i];
+    }
+
+    double concentration = squares * occupied / ((double)triangleCount * triangleCount);
+
+    return concentration <= gridConcentration ? AcceleratorType::UniformGrid : AcceleratorType::BVH;
+}
+std::shared_ptr<Accelerator> createAccelerator(const TriangleMesh * triangleMesh, AcceleratorType type,
+    BVHBuildMethod buildMethod, size_t width, const std::string & cacheFilename) {
+    if (type == AcceleratorType::Automatic)
+        type = chooseAccelerator(triangleMesh);
+
+    std::shared_ptr<Accelerator> accelerator;
+
+    if (type == AcceleratorType::BruteForce)
+        accelerator = std::make_shared<BruteForceAccelerator>();
+    else if (type == AcceleratorType::UniformGrid)
+        accelerator = std::make_shared<UniformGrid>();
+    else {
+        std::shared_ptr<BVHAccelerator> bvhAccelerator =
+            std::make_shared<BVHAccelerator>(buildMethod, width, type == AcceleratorType::QuantizedBVH);
+
+        bvhAccelerator->build(triangleMesh, cacheFilename);
+
+        return bvhAccelerator;
+    }
+
+    accelerator->build(triangleMesh);
+
+    return accelerator;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,157 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/AccumulationBuffer.h>
+#include <aurora/Color.h>
+#include <aurora/Image.h>
+
+#include <algorithm>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+AccumulationBuffer::AccumulationBuffer() : width(0), height(0) {}
+AccumulationBuffer::AccumulationBuffer(const AccumulationBuffer & accumulationBuffer)
+    : width(accumulationBuffer.width), height(accumulationBuffer.height), sums(accumulationBuffer.sums),
+    squaredSums(accumulationBuffer.squaredSums), sampleCounts(accumulationBuffer.sampleCounts) {}
+AccumulationBuffer::AccumulationBuffer(size_t width, size_t height) {
+    create(width, height);
+}
+AccumulationBuffer::~AccumulationBuffer() {}
+
+AccumulationBuffer & AccumulationBuffer::create(size_t width, size_t height) {
+    this->width = width;
+    this->height = height;
+    sums.assign(width * height * 3, 0.0f);
+    squaredSums.assign(width * height, 0.0f);
+    sampleCounts.assign(width * height, 0);
+
+    return *this;
+}
+void AccumulationBuffer::clear() {
+    std::fill(sums.begin(), sums.end(), 0.0f);
+    std::fill(squaredSums.begin(), squaredSums.end(), 0.0f);
+    std::fill(sampleCounts.begin(), sampleCounts.end(), 0);
+}
+
+void AccumulationBuffer::add(size_t i, size_t j, const Color3 & sample) {
+    double luminance = sample.luminance();
+
+    add(i, j, sample, luminance * luminance, 1);
+}
+void AccumulationBuffer::add(size_t i, size_t j, const Color3 & sum, double squaredSum, uint32_t sampleCount) {
+    size_t pixel = i + j * width;
+    float * rgb = &sums[pixel * 3];
+
+    rgb[0] += (float)sum.r;
+    rgb[1] += (float)sum.g;
+    rgb[2] += (float)sum.b;
+    squaredSums[pixel] += (float)squaredSum;
+    sampleCounts[pixel] += sampleCount;
+}
+uint32_t AccumulationBuffer::getSampleCount(size_t i, size_t j) const {
+    return sampleCounts[i + j * width];
+}
+Color3 AccumulationBuffer::getPixel(size_t i, size_t j) const {
+    size_t pixel = i + j * width;
+
+    if (sampleCounts[pixel] == 0)
+        return Color3();
+
+    const float * rgb = &sums[pixel * 3];
+    double inverseCount = 1.0 / sampleCounts[pixel];
+
+    return Color3(rgb[0] * inverseCount, rgb[1] * inverseCount, rgb[2] * inverseCount);
+}
+double AccumulationBuffer::getVariance(size_t i, size_t j) const {
+    size_t pixel = i + j * width;
+    uint32_t count = sampleCounts[pixel];
+
+    if (count < 2)
+        return 0.0;
+
+    const float * rgb = &sums[pixel * 3];
+    double sum = 0.2126 * rgb[0] + 0.7152 * rgb[1] + 0.0722 * rgb[2];
+
+    // Cancelamento em preciso simples pode gerar valores levemente negativos
+    return std::max((squaredSums[pixel] - sum * sum / count) / (count - 1), 0.0);
+}
+double AccumulationBuffer::getError(size_t i, size_t j) const {
+    uint32_t count = getSampleCount(i, j);
+    double mean = getPixel(i, j).luminance();
+
+    if (count < 2 || mean <= 0.0)
+        return 0.0;
+
+    return std::sqrt(getVariance(i, j) / (count * mean));
+}
+uint32_t AccumulationBuffer::getMinimumSampleCount() const {
+    if (sampleCounts.empty())
+        return 0;
+
+    return *std::min_element(sampleCounts.begin(), sampleCounts.end());
+}
+uint64_t AccumulationBuffer::getTotalSampleCount() const {
+    uint64_t total = 0;
+
+    for (size_t k = 0; k < sampleCounts.size(); k++)
+        total += sampleCounts[k];
+
+    return total;
+}
+size_t AccumulationBuffer::getWidth() const {
+    return width;
+}
+size_t AccumulationBuffer::getHeight() const {
+    return height;
+}
+
+void AccumulationBuffer::resolve(Image3 & image3) const {
+    if (image3.getWidth() != width || image3.getHeight() != height)
+        image3.create(width, height);
+
+    for (size_t j = 0; j < height; j++) {
+        for (size_t i = 0; i < width; i++)
+            image3(i, j) = getPixel(i, j);
+    }
+}
+void AccumulationBuffer::resolveSampleCounts(Image3 & image3) const {
+    if (image3.getWidth() != width || image3.getHeight() != height)
+        image3.create(width, height);
+
+    uint32_t maximum = sampleCounts.empty() ? 0 : *std::max_element(sampleCounts.begin(), sampleCounts.end());
+    double scale = maximum != 0 ? 1.0 / maximum : 0.0;
+
+    for (size_t j = 0; j < height; j++) {
+        for (size_t i = 0; i < width; i++) {
+            double value = getSampleCount(i, j) * scale;
+            image3(i, j) = Color3(value, value, value);
+        }
+    }
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,2200 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/BVH.h>
+#include <aurora/BVHCache.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const double traversalCost = 0.125;
+const double intersectionCost = 1.0;
+const size_t maximumDepth = 60;
+const size_t stackSize = 128;
+const size_t binCount = 32;
+const size_t parallelThreshold = 1 << 16;
+const size_t subtreeCount = 64;
+
+struct BVHBox {
+    double min[3], max[3];
+
+    void reset() {
+        for (size_t i = 0; i < 3; i++) {
+            min[i] = AURORA_INFINITY;
+            max[i] = -AURORA_INFINITY;
+        }
+    }
+
+    void expand(const double * point) {
+        for (size_t i = 0; i < 3; i++) {
+            min[i] = point[i] < min[i] ? point[i] : min[i];
+            max[i] = point[i] > max[i] ? point[i] : max[i];
+        }
+    }
+
+    void expand(const BVHBox & box) {
+        for (size_t i = 0; i < 3; i++) {
+            min[i] = box.min[i] < min[i] ? box.min[i] : min[i];
+            max[i] = box.max[i] > max[i] ? box.max[i] : max[i];
+        }
+    }
+
+    double getSurfaceArea() const {
+        double x = max[0] - min[0];
+        double y = max[1] - min[1];
+        double z = max[2] - min[2];
+
+        return x < 0 ? 0 : 2.0 * (x * y + y * z + z * x);
+    }
+
+    size_t getMaximumExtent() const {
+        double x = max[0] - min[0];
+        double y = max[1] - min[1];
+        double z = max[2] - min[2];
+
+        if (x > y && x > z)
+            return 0;
+
+        return y > z ? 1 : 2;
+    }
+
+    BoundingBox3 toBoundingBox() const {
+        return BoundingBox3(Vector3(min[0], min[1], min[2]), Vector3(max[0], max[1], max[2]));
+    }
+
+    void store(BoundingBox3 & boundingBox) const {
+        boundingBox.min.x = min[0];
+        boundingBox.min.y = min[1];
+        boundingBox.min.z = min[2];
+        boundingBox.max.x = max[0];
+        boundingBox.max.y = max[1];
+        boundingBox.max.z = max[2];
+    }
+};
+
+struct BVHPrimitive {
+    BVHBox box;
+    double center[3];
+    size_t index;
+};
+
+struct BVHBin {
+    BVHBox box;
+    size_t count;
+
+    void reset() {
+        box.reset();
+        count = 0;
+    }
+
+    void expand(const BVHBin & bin) {
+        box.expand(bin.box);
+        count += bin.count;
+    }
+};
+
+struct BVHPrimitiveCompare {
+    size_t axis;
+
+    BVHPrimitiveCompare(size_t axis) : axis(axis) {}
+
+    bool operator ()(const BVHPrimitive & lhs, const BVHPrimitive & rhs) const {
+        return lhs.center[axis] < rhs.center[axis];
+    }
+};
+
+void computePrimitiveBounds(const BVHPrimitive * primitives, size_t begin, size_t end,
+    BVHBox & box, BVHBox & centerBox) {
+    box.reset();
+    centerBox.reset();
+
+    for (size_t i = begin; i < end; i++) {
+        box.expand(primitives[i].box);
+        centerBox.expand(primitives[i].center);
+    }
+}
+
+size_t buildSweepRecursive(
+    std::vector<BVHNode> & nodes, std::vector<BVHPrimitive> & primitives,
+    size_t begin, size_t end, size_t depth, size_t maximumLeafSize) {
+    size_t current = nodes.size();
+    nodes.push_back(BVHNode());
+
+    BVHBox box, centerBox;
+    computePrimitiveBounds(&primitives[0], begin, end, box, centerBox);
+
+    size_t count = end - begin;
+    size_t axis = centerBox.getMaximumExtent();
+    size_t middle = begin + count / 2;
+
+    nodes[current].boundingBox = box.toBoundingBox();
+
+    if (count <= 1) {
+        nodes[current].offset = begin;
+        nodes[current].count = count;
+
+        return current;
+    }
+
+    bool degenerate = centerBox.max[axis] == centerBox.min[axis];
+
+    if (!degenerate && depth < maximumDepth) {
+        double bestCost = AURORA_INFINITY;
+        size_t bestAxis = axis, bestSplit = middle, sortedAxis = 3;
+
+        std::vector<double> rightAreas(count);
+
+        for (size_t k = 0; k < 3; k++) {
+            if (centerBox.max[k] == centerBox.min[k])
+                continue;
+
+            std::sort(primitives.begin() + begin, primitives.begin() + end, BVHPrimitiveCompare(k));
+            sortedAxis = k;
+
+            BVHBox right;
+            right.reset();
+
+            for (size_t i = count - 1; i > 0; i--) {
+                right.expand(primitives[begin + i].box);
+                rightAreas[i] = right.getSurfaceArea();
+            }
+
+            BVHBox left;
+            left.reset();
+
+            for (size_t i = 1; i < count; i++) {
+                left.expand(primitives[begin + i - 1].box);
+
+                double cost = left.getSurfaceArea() * i + rightAreas[i] * (count - i);
+
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = k;
+                    bestSplit = begin + i;
+                }
+            }
+        }
+
+        double area = box.getSurfaceArea();
+
+        bestCost = traversalCost + intersectionCost * (area > 0 ? bestCost / area : count);
+
+        if (count <= maximumLeafSize && bestCost >= intersectionCost * count) {
+            nodes[current].offset = begin;
+            nodes[current].count = count;
+
+            return current;
+        }
+
+        axis = bestAxis;
+        middle = bestSplit;
+
+        if (axis != sortedAxis)
+            std::nth_element(primitives.begin() + begin, primitives.begin() + middle,
+                primitives.begin() + end, BVHPrimitiveCompare(axis));
+    }
+    else if (count <= maximumLeafSize) {
+        nodes[current].offset = begin;
+        nodes[current].count = count;
+
+        return current;
+    }
+    else
+        std::nth_element(primitives.begin() + begin, primitives.begin() + middle,
+            primitives.begin() + end, BVHPrimitiveCompare(axis));
+
+    buildSweepRecursive(nodes, primitives, begin, middle, depth + 1, maximumLeafSize);
+    size_t right = buildSweepRecursive(nodes, primitives, middle, end, depth + 1, maximumLeafSize);
+
+    nodes[current].offset = right;
+    nodes[current].count = 0;
+    nodes[current].axis = axis;
+
+    return current;
+}
+
+template <typename Function>
+void parallelFor(size_t count, size_t threadCount, const Function & function) {
+    threadCount = std::min(threadCount, count);
+
+    if (threadCount <= 1) {
+        function(0, 0, count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(std::cref(function),
+            i, count * i / threadCount, count * (i + 1) / threadCount));
+
+    for (size_t i = 0; i < threadCount; i++)
+        threads[i].join();
+}
+
+struct BVHBuildTask {
+    size_t node, begin, end, depth;
+
+    BVHBuildTask(size_t node, size_t begin, size_t end, size_t depth)
+        : node(node), begin(begin), end(end), depth(depth) {}
+
+    bool operator <(const BVHBuildTask & rhs) const {
+        return end - begin > rhs.end - rhs.begin;
+    }
+};
+
+// Construtor SAH por intervalos: ns grandes so divididos com todas as threads
+// (agrupamento e particionamento paralelos) e as subrvores restantes em paralelo
+class BinnedBuilder {
+private:
+    std::vector<BVHPrimitive> & primitives;
+    std::vector<BVHPrimitive> buffer;
+    std::vector<BVHNode> nodes;
+    std::atomic<size_t> nodeCount;
+    size_t maximumLeafSize;
+    size_t threadCount;
+
+    static size_t binIndex(const BVHPrimitive & primitive, const BVHBox & centerBox, size_t axis, size_t bins) {
+        double extent = centerBox.max[axis] - centerBox.min[axis];
+
+        if (extent <= 0)
+            return 0;
+
+        size_t i = (size_t)((primitive.center[axis] - centerBox.min[axis]) / extent * bins);
+
+        return i < bins ? i : bins - 1;
+    }
+
+    void computeBounds(size_t begin, size_t end, bool parallel, BVHBox & box, BVHBox & centerBox) {
+        if (!parallel) {
+            computePrimitiveBounds(&primitives[0], begin, end, box, centerBox);
+            return;
+        }
+
+        std::vector<BVHBox> boxes(threadCount), centerBoxes(threadCount);
+
+        parallelFor(end - begin, threadCount, [&](size_t task, size_t first, size_t last) {
+            computePrimitiveBounds(&primitives[0], begin + first, begin + last, boxes[task], centerBoxes[task]);
+        });
+
+        box.reset();
+        centerBox.reset();
+
+        for (size_t i = 0; i < threadCount; i++) {
+            box.expand(boxes[i]);
+            centerBox.expand(centerBoxes[i]);
+        }
+    }
+
+    void computeBins(size_t begin, size_t end, const BVHBox & centerBox, size_t bins, BVHBin * output) {
+        for (size_t i = 0; i < 3 * bins; i++)
+            output[i].reset();
+
+        for (size_t i = begin; i < end; i++) {
+            for (size_t k = 0; k < 3; k++) {
+                BVHBin & bin = output[k * bins + binIndex(primitives[i], centerBox, k, bins)];
+
+                bin.box.expand(primitives[i].box);
+                bin.count++;
+            }
+        }
+    }
+
+    void computeBins(size_t begin, size_t end, bool parallel,
+        const BVHBox & centerBox, size_t bins, BVHBin * output) {
+        if (!parallel) {
+            computeBins(begin, end, centerBox, bins, output);
+            return;
+        }
+
+        std::vector<BVHBin> partialBins(threadCount * 3 * bins);
+
+        parallelFor(end - begin, threadCount, [&](size_t task, size_t first, size_t last) {
+            computeBins(begin + first, begin + last, centerBox, bins, &partialBins[task * 3 * bins]);
+        });
+
+        for (size_t i = 0; i < 3 * bins; i++)
+            output[i].reset();
+
+        for (size_t i = 0; i < threadCount; i++) {
+            for (size_t j = 0; j < 3 * bins; j++)
+                output[j].expand(partialBins[i * 3 * bins + j]);
+        }
+    }
+
+    size_t partition(size_t begin, size_t end, bool parallel,
+        const BVHBox & centerBox, size_t axis, size_t bins, size_t split) {
+        if (!parallel) {
+            BVHPrimitive * middle = std::partition(&primitives[0] + begin, &primitives[0] + end,
+                [&](const BVHPrimitive & primitive) {
+                    return binIndex(primitive, centerBox, axis, bins) < split;
+                });
+
+            return middle - &primitives[0];
+        }
+
+        std::vector<size_t> leftCounts(threadCount + 1, 0), rightCounts(threadCount + 1, 0);
+
+        parallelFor(end - begin, threadCount, [&](size_t task, size_t first, size_t last) {
+            for (size_t i = begin + first; i < begin + last; i++) {
+                if (binIndex(primitives[i], centerBox, axis, bins) < split)
+                    leftCounts[task + 1]++;
+                else
+                    rightCounts[task + 1]++;
+            }
+        });
+
+        for (size_t i = 0; i < threadCount; i++) {
+            leftCounts[i + 1] += leftCounts[i];
+            rightCounts[i + 1] += rightCounts[i];
+        }
+
+        size_t middle = begin + leftCounts[threadCount];
+
+        parallelFor(end - begin, threadCount, [&](size_t task, size_t first, size_t last) {
+            size_t left = begin + leftCounts[task];
+            size_t right = middle + rightCounts[task];
+
+            for (size_t i = begin + first; i < begin + last; i++) {
+                if (binIndex(primitives[i], centerBox, axis, bins) < split)
+                    buffer[left++] = primitives[i];
+                else
+                    buffer[right++] = primitives[i];
+            }
+        });
+
+        parallelFor(end - begin, threadCount, [&](size_t, size_t first, size_t last) {
+            std::copy(buffer.begin() + begin + first, buffer.begin() + begin + last,
+                primitives.begin() + begin + first);
+        });
+
+        return middle;
+    }
+
+    void makeLeaf(size_t node, size_t begin, size_t end) {
+        nodes[node].offset = begin;
+        nodes[node].count = end - begin;
+    }
+
+    // Divide n e retorna se foi criado n interno (filhos consecutivos a partir de "offset")
+    bool split(const BVHBuildTask & task, size_t & middle, bool parallel) {
+        size_t begin = task.begin, end = task.end, count = end - begin;
+
+        BVHBox box, centerBox;
+        computeBounds(begin, end, parallel, box, centerBox);
+
+        nodes[task.node].boundingBox = box.toBoundingBox();
+
+        if (count <= 1) {
+            makeLeaf(task.node, begin, end);
+            return false;
+        }
+
+        size_t axis = centerBox.getMaximumExtent();
+        middle = begin + count / 2;
+
+        if (centerBox.max[axis] == centerBox.min[axis]) {
+            if (count <= maximumLeafSize) {
+                makeLeaf(task.node, begin, end);
+                return false;
+            }
+        }
+        else if (task.depth >= maximumDepth) {
+            std::nth_element(primitives.begin() + begin, primitives.begin() + middle,
+                primitives.begin() + end, BVHPrimitiveCompare(axis));
+        }
+        else {
+            size_t bins = std::min(binCount, count + 1);
+
+            BVHBin binArray[3 * binCount];
+            computeBins(begin, end, parallel, centerBox, bins, binArray);
+
+            double bestCost = AURORA_INFINITY;
+            size_t bestAxis = axis, bestSplit = 0;
+
+            for (size_t k = 0; k < 3; k++) {
+                const BVHBin * axisBins = &binArray[k * bins];
+
+                double rightCosts[binCount];
+                BVHBin right;
+                right.reset();
+
+                for (size_t i = bins - 1; i > 0; i--) {
+                    right.expand(axisBins[i]);
+                    rightCosts[i] = right.box.getSurfaceArea() * right.count;
+                }
+
+                BVHBin left;
+                left.reset();
+
+                for (size_t i = 1; i < bins; i++) {
+                    left.expand(axisBins[i - 1]);
+
+                    if (left.count == 0 || left.count == count)
+                        continue;
+
+                    double cost = left.box.getSurfaceArea() * left.count + rightCosts[i];
+
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = k;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            double area = box.getSurfaceArea();
+
+            if (bestSplit != 0) {
+                bestCost = traversalCost + intersectionCost * (area > 0 ? bestCost / area : count);
+
+                if (count <= maximumLeafSize && bestCost >= intersectionCost * count) {
+                    makeLeaf(task.node, begin, end);
+                    return false;
+                }
+
+                axis = bestAxis;
+                middle = partition(begin, end, parallel, centerBox, axis, bins, bestSplit);
+            }
+            else if (count <= maximumLeafSize) {
+                makeLeaf(task.node, begin, end);
+                return false;
+            }
+            else
+                std::nth_element(primitives.begin() + begin, primitives.begin() + middle,
+                    primitives.begin() + end, BVHPrimitiveCompare(axis));
+        }
+
+        size_t children = nodeCount.fetch_add(2);
+
+        nodes[task.node].offset = children;
+        nodes[task.node].count = 0;
+        nodes[task.node].axis = axis;
+
+        return true;
+    }
+
+    void buildSubtree(const BVHBuildTask & task) {
+        size_t middle;
+
+        if (split(task, middle, false)) {
+            size_t children = nodes[task.node].offset;
+
+            buildSubtree(BVHBuildTask(children, task.begin, middle, task.depth + 1));
+            buildSubtree(BVHBuildTask(children + 1, middle, task.end, task.depth + 1));
+        }
+    }
+
+public:
+    BinnedBuilder(std::vector<BVHPrimitive> & primitives, size_t maximumLeafSize, size_t threadCount)
+        : primitives(primitives), nodeCount(0), maximumLeafSize(maximumLeafSize), threadCount(threadCount) {}
+
+    void build(std::vector<BVHNode> & output) {
+        size_t primitiveCount = primitives.size();
+
+        nodes.resize(2 * primitiveCount);
+        nodeCount = 1;
+
+        std::vector<BVHBuildTask> large, small;
+        large.push_back(BVHBuildTask(0, 0, primitiveCount, 0));
+
+        if (threadCount > 1 && primitiveCount > parallelThreshold)
+            buffer.resize(primitiveCount);
+
+        while (!large.empty()) {
+            BVHBuildTask task = large.back();
+            large.pop_back();
+
+            if (threadCount <= 1 || task.end - task.begin <= parallelThreshold
+                || large.size() + small.size() >= 4 * threadCount) {
+                small.push_back(task);
+                continue;
+            }
+
+            size_t middle;
+
+            if (split(task, middle, true)) {
+                size_t children = nodes[task.node].offset;
+
+                large.push_back(BVHBuildTask(children, task.begin, middle, task.depth + 1));
+                large.push_back(BVHBuildTask(children + 1, middle, task.end, task.depth + 1));
+            }
+        }
+
+        std::vector<BVHPrimitive>().swap(buffer);
+        std::sort(small.begin(), small.end());
+
+        std::atomic<size_t> next(0);
+
+        parallelFor(threadCount, threadCount, [&](size_t, size_t, size_t) {
+            for (size_t i = next++; i < small.size(); i = next++)
+                buildSubtree(small[i]);
+        });
+
+        output.clear();
+        output.reserve(nodeCount);
+
+        std::vector<std::pair<size_t, size_t> > stack;
+        stack.push_back(std::make_pair(size_t(0), size_t(-1)));
+
+        while (!stack.empty()) {
+            size_t node = stack.back().first;
+            size_t parent = stack.back().second;
+            stack.pop_back();
+
+            size_t current = output.size();
+            output.push_back(nodes[node]);
+
+            if (parent != size_t(-1))
+                output[parent].offset = current;
+
+            if (!nodes[node].isLeaf()) {
+                stack.push_back(std::make_pair(nodes[node].offset + 1, current));
+                stack.push_back(std::make_pair(nodes[node].offset, size_t(-1)));
+            }
+        }
+    }
+};
+
+// Construtor SBVH: divises por objeto (SAH por intervalos) e divises espaciais com
+// duplicao de referncias, limitada por oramento de memria (Stich et al. 2009)
+class SpatialBuilder {
+private:
+    const TriangleMesh * triangleMesh;
+    std::vector<BVHPrimitive> & source;
+    std::vector<BVHPrimitive> references;
+    std::vector<BVHNode> & nodes;
+    size_t maximumLeafSize;
+    size_t splitBudget;
+    double minimumOverlap;
+
+    struct SpatialBin {
+        BVHBox box;
+        size_t entries, exits;
+    };
+
+    struct ObjectSplit {
+        double cost;
+        size_t axis, bin, bins;
+        BVHBox centerBox, left, right;
+    };
+
+    struct SpatialSplit {
+        double cost;
+        size_t axis;
+        double position;
+    };
+
+    static void updateCenter(BVHPrimitive & primitive) {
+        for (size_t k = 0; k < 3; k++)
+            primitive.center[k] = (primitive.box.min[k] + primitive.box.max[k]) * 0.5;
+    }
+
+    static bool isEmpty(const BVHBox & box) {
+        return box.min[0] > box.max[0] || box.min[1] > box.max[1] || box.min[2] > box.max[2];
+    }
+
+    // Divide referncia no plano: caixas das partes do tringulo de cada lado, recortadas pela caixa original
+    void splitReference(const BVHPrimitive & reference, size_t axis, double position,
+        BVHPrimitive & left, BVHPrimitive & right) const {
+        size_t indices[3];
+        triangleMesh->getVertexIndices(reference.index, indices[0], indices[1], indices[2]);
+
+        left.box.reset();
+        right.box.reset();
+        left.index = right.index = reference.index;
+
+        for (size_t i = 0; i < 3; i++) {
+            const double * v0 = &triangleMesh->getVertex(indices[i]).x;
+            const double * v1 = &triangleMesh->getVertex(indices[(i + 1) % 3]).x;
+
+            if (v0[axis] <= position)
+                left.box.expand(v0);
+            if (v0[axis] >= position)
+                right.box.expand(v0);
+
+            // Aresta cruza o plano: ponto de interseo pertence aos dois lados
+            if ((v0[axis] < position && v1[axis] > position) || (v0[axis] > position && v1[axis] < position)) {
+                double t = (position - v0[axis]) / (v1[axis] - v0[axis]);
+                double point[3];
+
+                for (size_t k = 0; k < 3; k++)
+                    point[k] = v0[k] + (v1[k] - v0[k]) * t;
+                point[axis] = position;
+
+                left.box.expand(point);
+                right.box.expand(point);
+            }
+        }
+
+        left.box.max[axis] = position;
+        right.box.min[axis] = position;
+
+        for (size_t k = 0; k < 3; k++) {
+            left.box.min[k] = std::max(left.box.min[k], reference.box.min[k]);
+            left.box.max[k] = std::min(left.box.max[k], reference.box.max[k]);
+            right.box.min[k] = std::max(right.box.min[k], reference.box.min[k]);
+            right.box.max[k] = std::min(right.box.max[k], reference.box.max[k]);
+        }
+
+        updateCenter(left);
+        updateCenter(right);
+    }
+
+    static size_t binIndex(double value, double minimum, double extent, size_t bins) {
+        if (extent <= 0)
+            return 0;
+
+        double i = (value - minimum) / extent * bins;
+
+        return i <= 0 ? 0 : (i < bins ? (size_t)i : bins - 1);
+    }
+
+    void findObjectSplit(const std::vector<BVHPrimitive> & primitives, ObjectSplit & split) const {
+        split.cost = AURORA_INFINITY;
+        split.axis = split.bin = 0;
+        split.bins = std::min(binCount, primitives.size() + 1);
+        split.centerBox.reset();
+
+        for (size_t i = 0; i < primitives.size(); i++)
+            split.centerBox.expand(primitives[i].center);
+
+        size_t bins = split.bins;
+        BVHBin binned[binCount];
+        BVHBox rightBoxes[binCount];
+        size_t rightCounts[binCount];
+
+        for (size_t k = 0; k < 3; k++) {
+            double extent = split.centerBox.max[k] - split.centerBox.min[k];
+
+            if (extent <= 0)
+                continue;
+
+            for (size_t i = 0; i < bins; i++)
+                binned[i].reset();
+
+            for (size_t i = 0; i < primitives.size(); i++) {
+                BVHBin & bin = binned[binIndex(primitives[i].center[k], split.centerBox.min[k], extent, bins)];
+
+                bin.box.expand(primitives[i].box);
+                bin.count++;
+            }
+
+            BVHBin right;
+            right.reset();
+
+            for (size_t i = bins - 1; i > 0; i--) {
+                right.expand(binned[i]);
+                rightBoxes[i] = right.box;
+                rightCounts[i] = right.count;
+            }
+
+            BVHBin left;
+            left.reset();
+
+            for (size_t i = 1; i < bins; i++) {
+                left.expand(binned[i - 1]);
+
+                if (left.count == 0 || rightCounts[i] == 0)
+                    continue;
+
+                double cost = left.box.getSurfaceArea() * left.count + rightBoxes[i].getSurfaceArea() * rightCounts[i];
+
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = k;
+                    split.bin = i;
+                    split.left = left.box;
+                    split.right = rightBoxes[i];
+                }
+            }
+        }
+    }
+
+    void findSpatialSplit(const std::vector<BVHPrimitive> & primitives, const BVHBox & box, SpatialSplit & split) const {
+        split.cost = AURORA_INFINITY;
+
+        SpatialBin binned[binCount];
+        BVHBox rightBoxes[binCount];
+        size_t rightCounts[binCount];
+
+        for (size_t k = 0; k < 3; k++) {
+            double extent = box.max[k] - box.min[k];
+
+            if (extent <= 0)
+                continue;
+
+            for (size_t i = 0; i < binCount; i++) {
+                binned[i].box.reset();
+                binned[i].entries = binned[i].exits = 0;
+            }
+
+            // Recorta cada referncia nos planos dos intervalos que ela atravessa
+            for (size_t i = 0; i < primitives.size(); i++) {
+                size_t first = binIndex(primitives[i].box.min[k], box.min[k], extent, binCount);
+                size_t last = binIndex(primitives[i].box.max[k], box.min[k], extent, binCount);
+
+                BVHPrimitive current = primitives[i];
+
+                for (size_t j = first; j < last; j++) {
+                    BVHPrimitive left, right;
+                    splitReference(current, k, box.min[k] + extent * (j + 1) / binCount, left, right);
+
+                    if (!isEmpty(left.box))
+                        binned[j].box.expand(left.box);
+                    current = right;
+                }
+
+                if (!isEmpty(current.box))
+                    binned[last].box.expand(current.box);
+
+                binned[first].entries++;
+                binned[last].exits++;
+            }
+
+            BVHBox right;
+            size_t rightCount = 0;
+            right.reset();
+
+            for (size_t i = binCount - 1; i > 0; i--) {
+                right.expand(binned[i].box);
+                rightCount += binned[i].exits;
+                rightBoxes[i] = right;
+                rightCounts[i] = rightCount;
+            }
+
+            BVHBox left;
+            size_t leftCount = 0;
+            left.reset();
+
+            for (size_t i = 1; i < binCount; i++) {
+                left.expand(binned[i - 1].box);
+                leftCount += binned[i - 1].entries;
+
+                if (leftCount == 0 || rightCounts[i] == 0)
+                    continue;
+
+                double cost = left.getSurfaceArea() * leftCount + rightBoxes[i].getSurfaceArea() * rightCounts[i];
+
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = k;
+                    split.position = box.min[k] + extent * i / binCount;
+                }
+            }
+        }
+    }
+
+    void partitionObject(std::vector<BVHPrimitive> & primitives, const ObjectSplit & split,
+        std::vector<BVHPrimitive> & left, std::vector<BVHPrimitive> & right) const {
+        double extent = split.centerBox.max[split.axis] - split.centerBox.min[split.axis];
+
+        for (size_t i = 0; i < primitives.size(); i++) {
+            if (binIndex(primitives[i].center[split.axis], split.centerBox.min[split.axis], extent, split.bins) < split.bin)
+                left.push_back(primitives[i]);
+            else
+                right.push_back(primitives[i]);
+        }
+    }
+
+    void partitionSpatial(std::vector<BVHPrimitive> & primitives, const SpatialSplit & split,
+        std::vector<BVHPrimitive> & left, std::vector<BVHPrimitive> & right) const {
+        std::vector<size_t> straddling;
+        BVHBox leftBox, rightBox;
+
+        leftBox.reset();
+        rightBox.reset();
+
+        for (size_t i = 0; i < primitives.size(); i++) {
+            if (primitives[i].box.max[split.axis] <= split.position) {
+                left.push_back(primitives[i]);
+                leftBox.expand(primitives[i].box);
+            }
+            else if (primitives[i].box.min[split.axis] >= split.position) {
+                right.push_back(primitives[i]);
+                rightBox.expand(primitives[i].box);
+            }
+            else
+                straddling.push_back(i);
+        }
+
+        size_t leftCount = left.size() + straddling.size();
+        size_t rightCount = right.size() + straddling.size();
+
+        for (size_t i = 0; i < straddling.size(); i++) {
+            const BVHPrimitive & reference = primitives[straddling[i]];
+
+            BVHPrimitive leftPart, rightPart;
+            splitReference(reference, split.axis, split.position, leftPart, rightPart);
+
+            BVHBox splitLeft = leftBox, splitRight = rightBox;
+            splitLeft.expand(leftPart.box);
+            splitRight.expand(rightPart.box);
+
+            BVHBox unsplitLeft = leftBox, unsplitRight = rightBox;
+            unsplitLeft.expand(reference.box);
+            unsplitRight.expand(reference.box);
+
+            // Desfaz a diviso da referncia quando manter o tringulo inteiro em um lado custa menos
+            double splitCost = isEmpty(leftPart.box) || isEmpty(rightPart.box) ? AURORA_INFINITY :
+                splitLeft.getSurfaceArea() * leftCount + splitRight.getSurfaceArea() * rightCount;
+            double leftCost = unsplitLeft.getSurfaceArea() * leftCount + rightBox.getSurfaceArea() * (rightCount - 1);
+            double rightCost = leftBox.getSurfaceArea() * (leftCount - 1) + unsplitRight.getSurfaceArea() * rightCount;
+
+            if (splitCost <= leftCost && splitCost <= rightCost) {
+                left.push_back(leftPart);
+                right.push_back(rightPart);
+                leftBox = splitLeft;
+                rightBox = splitRight;
+            }
+            else if (leftCost <= rightCost) {
+                left.push_back(reference);
+                leftBox = unsplitLeft;
+                rightCount--;
+            }
+            else {
+                right.push_back(reference);
+                rightBox = unsplitRight;
+                leftCount--;
+            }
+        }
+    }
+
+    size_t makeLeaf(size_t node, std::vector<BVHPrimitive> & primitives) {
+        nodes[node].offset = references.size();
+        nodes[node].count = primitives.size();
+
+        references.insert(references.end(), primitives.begin(), primitives.end());
+
+        return node;
+    }
+
+    // Oramento de duplicao do n  repartido entre os filhos proporcionalmente ao nmero de referncias
+    size_t buildRecursive(std::vector<BVHPrimitive> & primitives, size_t depth, size_t budget) {
+        size_t current = nodes.size();
+        nodes.push_back(BVHNode());
+
+        size_t count = primitives.size();
+
+        BVHBox box;
+        box.reset();
+
+        for (size_t i = 0; i < count; i++)
+            box.expand(primitives[i].box);
+
+        nodes[current].boundingBox = box.toBoundingBox();
+
+        if (count <= 1)
+            return makeLeaf(current, primitives);
+
+        std::vector<BVHPrimitive> left, right;
+        size_t axis = box.getMaximumExtent();
+
+        // Profundidade mxima: diviso pela mediana, como nos demais construtores
+        if (depth >= maximumDepth) {
+            if (count <= maximumLeafSize)
+                return makeLeaf(current, primitives);
+
+            BVHBox centerBox;
+            computePrimitiveBounds(&primitives[0], 0, count, box, centerBox);
+
+            axis = centerBox.getMaximumExtent();
+
+            std::nth_element(primitives.begin(), primitives.begin() + count / 2,
+                primitives.end(), BVHPrimitiveCompare(axis));
+
+            left.assign(primitives.begin(), primitives.begin() + count / 2);
+            right.assign(primitives.begin() + count / 2, primitives.end());
+
+            return buildChildren(current, primitives, left, right, axis, depth, budget);
+        }
+
+        ObjectSplit objectSplit;
+        findObjectSplit(primitives, objectSplit);
+
+        SpatialSplit spatialSplit;
+        spatialSplit.cost = AURORA_INFINITY;
+        spatialSplit.axis = 0;
+        spatialSplit.position = 0;
+
+        // Diviso espacial s  avaliada quando os filhos da diviso por objeto se sobrepem
+        if (budget > 0 && objectSplit.cost < AURORA_INFINITY) {
+            BVHBox overlap;
+
+            for (size_t k = 0; k < 3; k++) {
+                overlap.min[k] = std::max(objectSplit.left.min[k], objectSplit.right.min[k]);
+                overlap.max[k] = std::min(objectSplit.left.max[k], objectSplit.right.max[k]);
+            }
+
+            if (!isEmpty(overlap) && overlap.getSurfaceArea() > minimumOverlap)
+                findSpatialSplit(primitives, box, spatialSplit);
+        }
+
+        double area = box.getSurfaceArea();
+        double bestCost = std::min(objectSplit.cost, spatialSplit.cost);
+
+        bestCost = traversalCost + intersectionCost * (area > 0 ? bestCost / area : count);
+
+        if (count <= maximumLeafSize && bestCost >= intersectionCost * count)
+            return makeLeaf(current, primitives);
+
+        if (spatialSplit.cost < objectSplit.cost) {
+            partitionSpatial(primitives, spatialSplit, left, right);
+
+            size_t duplicates = left.size() + right.size() - count;
+
+            if (left.empty() || right.empty() || duplicates > budget) {
+                left.clear();
+                right.clear();
+            }
+            else {
+                budget -= duplicates;
+                axis = spatialSplit.axis;
+            }
+        }
+
+        if (left.empty() && objectSplit.cost < AURORA_INFINITY) {
+            partitionObject(primitives, objectSplit, left, right);
+            axis = objectSplit.axis;
+        }
+
+        // Centros coincidentes: diviso pela metade da lista
+        if (left.empty() || right.empty()) {
+            if (count <= maximumLeafSize)
+                return makeLeaf(current, primitives);
+
+            left.assign(primitives.begin(), primitives.begin() + count / 2);
+            right.assign(primitives.begin() + count / 2, primitives.end());
+        }
+
+        return buildChildren(current, primitives, left, right, axis, depth, budget);
+    }
+
+    size_t buildChildren(size_t current, std::vector<BVHPrimitive> & primitives,
+        std::vector<BVHPrimitive> & left, std::vector<BVHPrimitive> & right,
+        size_t axis, size_t depth, size_t budget) {
+        std::vector<BVHPrimitive>().swap(primitives);
+
+        size_t leftBudget = (size_t)((double)budget * left.size() / (left.size() + right.size()));
+
+        buildRecursive(left, depth + 1, leftBudget);
+        size_t rightNode = buildRecursive(right, depth + 1, budget - leftBudget);
+
+        nodes[current].offset = rightNode;
+        nodes[current].count = 0;
+        nodes[current].axis = axis;
+
+        return current;
+    }
+
+public:
+    SpatialBuilder(const TriangleMesh * triangleMesh, std::vector<BVHPrimitive> & primitives,
+        std::vector<BVHNode> & nodes, size_t maximumLeafSize, double splitBudget)
+        : triangleMesh(triangleMesh), source(primitives), nodes(nodes), maximumLeafSize(maximumLeafSize),
+        splitBudget((size_t)(primitives.size() * std::max(splitBudget, 0.0))), minimumOverlap(0.0) {}
+
+    void build() {
+        BVHBox box;
+        box.reset();
+
+        for (size_t i = 0; i < source.size(); i++)
+            box.expand(source[i].box);
+
+        minimumOverlap = box.getSurfaceArea() * 1e-5;
+
+        references.reserve(source.size() + splitBudget);
+        nodes.reserve(2 * (source.size() + splitBudget));
+
+        buildRecursive(source, 0, splitBudget);
+
+        source.swap(references);
+    }
+};
+
+inline uint64_t expandBits(uint64_t x, size_t bits) {
+    if (bits == 10) {
+        x &= 0x3ff;
+        x = (x | (x << 16)) & 0x30000ff;
+        x = (x | (x << 8)) & 0x300f00f;
+        x = (x | (x << 4)) & 0x30c30c3;
+        x = (x | (x << 2)) & 0x9249249;
+
+        return x;
+    }
+
+    x &= 0x1fffff;
+    x = (x | (x << 32)) & 0x1f00000000ffffULL;
+    x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x << 2)) & 0x1249249249249249ULL;
+
+    return x;
+}
+
+inline int countLeadingZeros(uint64_t x) {
+    return x == 0 ? 64 : __builtin_clzll(x);
+}
+
+// Ordena pares (cdigo, valor) por radix sort LSD com histogramas por thread
+void radixSort(std::vector<uint64_t> & keys, std::vector<size_t> & values, size_t bits, size_t threadCount) {
+    const size_t digitBits = 8;
+    const size_t digitCount = 1 << digitBits;
+
+    size_t count = keys.size();
+    size_t passes = (bits + digitBits - 1) / digitBits;
+
+    threadCount = std::max(size_t(1), std::min(threadCount, count / 4096));
+
+    std::vector<uint64_t> keyBuffer(count);
+    std::vector<size_t> valueBuffer(count);
+    std::vector<size_t> histograms(threadCount * digitCount);
+
+    for (size_t pass = 0; pass < passes; pass++) {
+        size_t shift = pass * digitBits;
+
+        std::fill(histograms.begin(), histograms.end(), 0);
+
+        parallelFor(count, threadCount, [&](size_t task, size_t begin, size_t end) {
+            size_t * histogram = &histograms[task * digitCount];
+
+            for (size_t i = begin; i < end; i++)
+                histogram[(keys[i] >> shift) & (digitCount - 1)]++;
+        });
+
+        size_t offset = 0;
+
+        for (size_t digit = 0; digit < digitCount; digit++) {
+            for (size_t task = 0; task < threadCount; task++) {
+                size_t & value = histograms[task * digitCount + digit];
+                size_t digitTotal = value;
+
+                value = offset;
+                offset += digitTotal;
+            }
+        }
+
+        parallelFor(count, threadCount, [&](size_t task, size_t begin, size_t end) {
+            size_t * histogram = &histograms[task * digitCount];
+
+            for (size_t i = begin; i < end; i++) {
+                size_t j = histogram[(keys[i] >> shift) & (digitCount - 1)]++;
+
+                keyBuffer[j] = keys[i];
+                valueBuffer[j] = values[i];
+            }
+        });
+
+        keys.swap(keyBuffer);
+        values.swap(valueBuffer);
+    }
+}
+
+struct LinearNode {
+    BVHBox box;
+    size_t children[2];
+    size_t parent;
+};
+
+// Construtor linear (LBVH): primitivas ordenadas por cdigo de Morton e hierarquia emitida
+// por n interno independentemente (Karras, 2012), opcionalmente com nveis superiores SAH (HLBVH)
+class LinearBuilder {
+private:
+    std::vector<BVHPrimitive> & primitives;
+    std::vector<uint64_t> codes;
+    std::vector<LinearNode> linearNodes;
+    size_t threadCount;
+    size_t mortonBits;
+    bool hierarchical;
+
+    // Retorna prefixo comum entre cdigos "i" e "j" do intervalo (ndice desempata cdigos iguais)
+    int delta(size_t begin, size_t end, size_t i, long long j) const {
+        if (j < (long long)begin || j >= (long long)end)
+            return -1;
+
+        uint64_t a = codes[i], b = codes[j];
+
+        return a == b ? 64 + countLeadingZeros(i ^ (size_t)j) : countLeadingZeros(a ^ b);
+    }
+
+    // Constri ns internos do intervalo [begin, end) e retorna ndice da raiz
+    size_t buildRange(size_t begin, size_t end) {
+        size_t count = end - begin;
+        size_t leafBase = primitives.size() - 1;
+
+        if (count == 1) {
+            linearNodes[leafBase + begin].parent = size_t(-1);
+            return leafBase + begin;
+        }
+
+        // Ns internos do intervalo ocupam ndices [begin, end - 1)
+        parallelFor(count - 1, hierarchical ? 1 : threadCount, [&](size_t, size_t first, size_t last) {
+            for (size_t k = first; k < last; k++) {
+                long long i = begin + k;
+                int direction = delta(begin, end, i, i + 1) - delta(begin, end, i, i - 1) > 0 ? 1 : -1;
+                int minimum = delta(begin, end, i, i - direction);
+
+                long long maximumLength = 2;
+
+                while (delta(begin, end, i, i + maximumLength * direction) > minimum)
+                    maximumLength *= 2;
+
+                long long length = 0;
+
+                for (long long t = maximumLength / 2; t >= 1; t /= 2) {
+                    if (delta(begin, end, i, i + (length + t) * direction) > minimum)
+                        length += t;
+                }
+
+                long long j = i + length * direction;
+                int node = delta(begin, end, i, j);
+
+                long long split = 0;
+                long long divisor = 2;
+                long long t;
+
+                do {
+                    t = (length + divisor - 1) / divisor;
+
+                    if (delta(begin, end, i, i + (split + t) * direction) > node)
+                        split += t;
+
+                    divisor *= 2;
+                } while (t > 1);
+
+                size_t gamma = i + split * direction + std::min(direction, 0);
+
+                LinearNode & linearNode = linearNodes[i];
+
+                linearNode.children[0] = (size_t)std::min(i, j) == gamma ? leafBase + gamma : gamma;
+                linearNode.children[1] = (size_t)std::max(i, j) == gamma + 1 ? leafBase + gamma + 1 : gamma + 1;
+
+                linearNodes[linearNode.children[0]].parent = i;
+                linearNodes[linearNode.children[1]].parent = i;
+            }
+        });
+
+        size_t root = begin;
+        linearNodes[root].parent = size_t(-1);
+
+        return root;
+    }
+
+    // Calcula caixas dos ns internos de baixo para cima (segundo filho a chegar calcula o pai)
+    void computeBounds() {
+        size_t count = primitives.size();
+        size_t leafBase = count - 1;
+
+        std::unique_ptr<std::atomic<unsigned char>[]> visits(new std::atomic<unsigned char>[count]);
+
+        for (size_t i = 0; i < count; i++)
+            visits[i] = 0;
+
+        parallelFor(count, threadCount, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                size_t node = leafBase + i;
+                linearNodes[node].box = primitives[i].box;
+
+                size_t parent = linearNodes[node].parent;
+
+                while (parent != size_t(-1) && parent < leafBase && visits[parent].fetch_add(1) == 1) {
+                    LinearNode & linearNode = linearNodes[parent];
+
+                    linearNode.box = linearNodes[linearNode.children[0]].box;
+                    linearNode.box.expand(linearNodes[linearNode.children[1]].box);
+
+                    parent = linearNode.parent;
+                }
+            }
+        });
+    }
+
+    void emit(size_t root, std::vector<BVHNode> & output, size_t parent) {
+        size_t leafBase = primitives.size() - 1;
+
+        std::vector<std::pair<size_t, size_t> > stack;
+        stack.push_back(std::make_pair(root, parent));
+
+        while (!stack.empty()) {
+            size_t node = stack.back().first;
+            size_t patch = stack.back().second;
+            stack.pop_back();
+
+            const LinearNode & linearNode = linearNodes[node];
+
+            size_t current = output.size();
+            output.push_back(BVHNode());
+
+            BVHNode & bvhNode = output.back();
+            bvhNode.boundingBox = linearNode.box.toBoundingBox();
+            bvhNode.axis = linearNode.box.getMaximumExtent();
+
+            if (patch != size_t(-1))
+                output[patch].offset = current;
+
+            if (node >= leafBase) {
+                bvhNode.offset = node - leafBase;
+                bvhNode.count = 1;
+            }
+            else {
+                stack.push_back(std::make_pair(linearNode.children[1], current));
+                stack.push_back(std::make_pair(linearNode.children[0], size_t(-1)));
+            }
+        }
+    }
+
+public:
+    LinearBuilder(std::vector<BVHPrimitive> & primitives, size_t threadCount, bool hierarchical)
+        : primitives(primitives), threadCount(threadCount), hierarchical(hierarchical) {
+        mortonBits = primitives.size() < (1 << 20) ? 10 : 21;
+    }
+
+    void build(std::vector<BVHNode> & output) {
+        size_t count = primitives.size();
+
+        BVHBox centerBox;
+        centerBox.reset();
+
+        for (size_t i = 0; i < count; i++)
+            centerBox.expand(primitives[i].center);
+
+        double scale[3];
+
+        for (size_t k = 0; k < 3; k++) {
+            double extent = centerBox.max[k] - centerBox.min[k];
+            scale[k] = extent > 0 ? ((1 << mortonBits) - 1) / extent : 0;
+        }
+
+        codes.resize(count);
+        std::vector<size_t> order(count);
+
+        parallelFor(count, threadCount, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                uint64_t code = 0;
+
+                for (size_t k = 0; k < 3; k++) {
+                    uint64_t cell = (uint64_t)((primitives[i].center[k] - centerBox.min[k]) * scale[k]);
+                    code |= expandBits(cell, mortonBits) << (2 - k);
+                }
+
+                codes[i] = code;
+                order[i] = i;
+            }
+        });
+
+        radixSort(codes, order, 3 * mortonBits, threadCount);
+
+        std::vector<BVHPrimitive> sorted(count);
+
+        parallelFor(count, threadCount, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                sorted[i] = primitives[order[i]];
+        });
+
+        primitives.swap(sorted);
+
+        linearNodes.resize(2 * count - 1);
+
+        output.clear();
+        output.reserve(2 * count - 1);
+
+        if (!hierarchical) {
+            size_t root = buildRange(0, count);
+            computeBounds();
+            emit(root, output, size_t(-1));
+
+            return;
+        }
+
+        // Agrupa primitivas pelos bits mais significativos do cdigo de Morton
+        size_t clusterShift = 3 * mortonBits - std::min(size_t(15), 3 * mortonBits);
+
+        std::vector<size_t> clusterBegins;
+
+        for (size_t i = 0; i < count; i++) {
+            if (i == 0 || (codes[i] >> clusterShift) != (codes[i - 1] >> clusterShift))
+                clusterBegins.push_back(i);
+        }
+
+        clusterBegins.push_back(count);
+
+        size_t clusterCount = clusterBegins.size() - 1;
+        std::vector<size_t> clusterRoots(clusterCount);
+        std::atomic<size_t> next(0);
+
+        parallelFor(threadCount, threadCount, [&](size_t, size_t, size_t) {
+            for (size_t i = next++; i < clusterCount; i = next++)
+                clusterRoots[i] = buildRange(clusterBegins[i], clusterBegins[i + 1]);
+        });
+
+        for (size_t i = 0; i < clusterCount; i++)
+            linearNodes[clusterRoots[i]].parent = size_t(-1);
+
+        computeBounds();
+
+        // Nveis superiores construdos com SAH sobre as caixas dos grupos
+        std::vector<BVHPrimitive> clusters(clusterCount);
+
+        for (size_t i = 0; i < clusterCount; i++) {
+            clusters[i].box = linearNodes[clusterRoots[i]].box;
+            clusters[i].index = i;
+
+            for (size_t k = 0; k < 3; k++)
+                clusters[i].center[k] = (clusters[i].box.min[k] + clusters[i].box.max[k]) * 0.5;
+        }
+
+        std::vector<BVHNode> top;
+        BinnedBuilder(clusters, 1, threadCount).build(top);
+
+        std::vector<std::pair<size_t, size_t> > stack;
+        stack.push_back(std::make_pair(size_t(0), size_t(-1)));
+
+        while (!stack.empty()) {
+            const BVHNode & node = top[stack.back().first];
+            size_t patch = stack.back().second;
+            stack.pop_back();
+
+            if (node.isLeaf()) {
+                emit(clusterRoots[clusters[node.offset].index], output, patch);
+                continue;
+            }
+
+            size_t current = output.size();
+            output.push_back(node);
+
+            if (patch != size_t(-1))
+                output[patch].offset = current;
+
+            stack.push_back(std::make_pair(node.offset, current));
+            stack.push_back(std::make_pair(size_t(&node - &top[0]) + 1, size_t(-1)));
+        }
+    }
+};
+
+void computeTriangleBox(const TriangleMesh * triangleMesh, size_t index, BVHBox & box) {
+    size_t v0, v1, v2;
+    triangleMesh->getVertexIndices(index, v0, v1, v2);
+
+    box.reset();
+    box.expand(&triangleMesh->getVertex(v0).x);
+    box.expand(&triangleMesh->getVertex(v1).x);
+    box.expand(&triangleMesh->getVertex(v2).x);
+}
+
+inline double getSurfaceArea(const BoundingBox3 & boundingBox) {
+    double x = boundingBox.max.x - boundingBox.min.x;
+    double y = boundingBox.max.y - boundingBox.min.y;
+    double z = boundingBox.max.z - boundingBox.min.z;
+
+    return x < 0 ? 0 : 2.0 * (x * y + y * z + z * x);
+}
+
+// Percorre ns em ordem reversa (filhos antes dos pais no layout em profundidade),
+// recalculando caixas se solicitado, e retorna custo SAH no normalizado do intervalo
+double refitRange(std::vector<BVHNode> & nodes, const std::vector<size_t> & indices,
+    const TriangleMesh * triangleMesh, size_t begin, size_t end, bool updateBounds) {
+    double cost = 0;
+
+    for (size_t i = end; i-- > begin;) {
+        BVHNode & node = nodes[i];
+
+        if (updateBounds) {
+            BVHBox box, child;
+            box.reset();
+
+            if (node.isLeaf()) {
+                for (size_t j = node.offset; j < node.offset + node.count; j++) {
+                    computeTriangleBox(triangleMesh, indices[j], child);
+                    box.expand(child);
+                }
+            }
+            else {
+                box.expand(&nodes[i + 1].boundingBox.min.x);
+                box.expand(&nodes[i + 1].boundingBox.max.x);
+                box.expand(&nodes[node.offset].boundingBox.min.x);
+                box.expand(&nodes[node.offset].boundingBox.max.x);
+            }
+
+            box.store(node.boundingBox);
+        }
+
+        double area = getSurfaceArea(node.boundingBox);
+
+        cost += node.isLeaf() ? area * intersectionCost * node.count : area * traversalCost;
+    }
+
+    return cost;
+}
+
+void buildNodes(std::vector<BVHPrimitive> & primitives, const TriangleMesh * triangleMesh,
+    BVHBuildMethod buildMethod, size_t maximumLeafSize, size_t threads, double splitBudget,
+    std::vector<BVHNode> & nodes, std::vector<size_t> & indices) {
+    if (buildMethod == BVHBuildMethod::SweepSAH) {
+        nodes.reserve(2 * primitives.size());
+        buildSweepRecursive(nodes, primitives, 0, primitives.size(), 0, maximumLeafSize);
+    }
+    else if (buildMethod == BVHBuildMethod::BinnedSAH)
+        BinnedBuilder(primitives, maximumLeafSize, threads).build(nodes);
+    else if (buildMethod == BVHBuildMethod::SpatialSAH)
+        SpatialBuilder(triangleMesh, primitives, nodes, maximumLeafSize, splitBudget).build();
+    else
+        LinearBuilder(primitives, threads, buildMethod == BVHBuildMethod::HierarchicalLinear).build(nodes);
+
+    indices.resize(primitives.size());
+
+    for (size_t i = 0; i < primitives.size(); i++)
+        indices[i] = primitives[i].index;
+}
+
+// Teste de caixa expandida por "margin" (zero exceto com o teste estanque de tringulos)
+inline bool intersectBoundingBox(
+    const BoundingBox3 & boundingBox, const Vector3 & origin, const Vector3 & inverseDirection,
+    double minimum, double maximum, double margin) {
+    double t0 = minimum, t1 = maximum;
+
+    for (size_t i = 0; i < 3; i++) {
+        double tNear = (boundingBox.min[i] - margin - origin[i]) * inverseDirection[i];
+        double tFar = (boundingBox.max[i] + margin - origin[i]) * inverseDirection[i];
+
+        if (tNear > tFar)
+            std::swap(tNear, tFar);
+
+        tFar *= AURORA_SLAB_ROUNDING;
+
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+
+        if (t0 > t1)
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+BVHNode::BVHNode() : offset(0), count(0), axis(0) {}
+BVHNode::BVHNode(const BVHNode & bvhNode)
+    : boundingBox(bvhNode.boundingBox), offset(bvhNode.offset), count(bvhNode.count), axis(bvhNode.axis) {}
+BVHNode::~BVHNode() {}
+
+bool BVHNode::isLeaf() const {
+    return count != 0;
+}
+
+BVH::BVH()
+    : triangleMesh(nullptr), buildMethod(BVHBuildMethod::BinnedSAH),
+    maximumLeafSize(4), threadCount(0), splitBudget(0.3), buildTime(0),
+    cost(0), buildCost(0), rebuildThreshold(1.3), updateTime(0),
+    layout(BVHLayout::DepthFirst), trianglePacking(false) {}
+BVH::BVH(const BVH & bvh)
+    : triangleMesh(bvh.triangleMesh), nodes(bvh.nodes), indices(bvh.indices),
+    buildMethod(bvh.buildMethod), maximumLeafSize(bvh.maximumLeafSize),
+    threadCount(bvh.threadCount), splitBudget(bvh.splitBudget), buildTime(bvh.buildTime),
+    subtrees(bvh.subtrees), subtreeCosts(bvh.subtreeCosts), cost(bvh.cost), buildCost(bvh.buildCost),
+    rebuildThreshold(bvh.rebuildThreshold), updateTime(bvh.updateTime),
+    layout(bvh.layout), trianglePacking(bvh.trianglePacking), triangleVertices(bvh.triangleVertices) {}
+BVH::BVH(const TriangleMesh * triangleMesh, BVHBuildMethod buildMethod, size_t maximumLeafSize)
+    : triangleMesh(nullptr), buildMethod(buildMethod),
+    maximumLeafSize(maximumLeafSize), threadCount(0), splitBudget(0.3), buildTime(0),
+    cost(0), buildCost(0), rebuildThreshold(1.3), updateTime(0),
+    layout(BVHLayout::DepthFirst), trianglePacking(false) {
+    build(triangleMesh);
+}
+BVH::~BVH() {}
+
+std::ostream & operator <<(std::ostream & lhs, const BVH & rhs) {
+    return lhs << "Triangles: " << (rhs.triangleMesh ? rhs.triangleMesh->getTriangleCount() : 0) << std::endl
+        << "References: " << rhs.indices.size() << std::endl
+        << "Nodes: " << rhs.getNodeCount() << std::endl
+        << "Bounding box: " << rhs.getBoundingBox() << std::endl
+        << "SAH cost: " << rhs.cost << std::endl
+        << "Build time: " << rhs.buildTime << " ms";
+}
+
+BVH & BVH::setBuildMethod(BVHBuildMethod buildMethod) {
+    this->buildMethod = buildMethod;
+    return *this;
+}
+BVHBuildMethod BVH::getBuildMethod() const {
+    return buildMethod;
+}
+
+BVH & BVH::setMaximumLeafSize(size_t maximumLeafSize) {
+    this->maximumLeafSize = maximumLeafSize > 0 ? maximumLeafSize : 1;
+    return *this;
+}
+size_t BVH::getMaximumLeafSize() const {
+    return maximumLeafSize;
+}
+BVH & BVH::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+    return *this;
+}
+size_t BVH::getThreadCount() const {
+    return threadCount;
+}
+BVH & BVH::setSplitBudget(double splitBudget) {
+    this->splitBudget = splitBudget > 0 ? splitBudget : 0;
+    return *this;
+}
+double BVH::getSplitBudget() const {
+    return splitBudget;
+}
+size_t BVH::getBuildTime() const {
+    return buildTime;
+}
+BVH & BVH::setRebuildThreshold(double rebuildThreshold) {
+    this->rebuildThreshold = rebuildThreshold > 1.0 ? rebuildThreshold : 1.0;
+    return *this;
+}
+double BVH::getRebuildThreshold() const {
+    return rebuildThreshold;
+}
+double BVH::getCost() const {
+    return cost;
+}
+double BVH::getBuildCost() const {
+    return buildCost;
+}
+size_t BVH::getUpdateTime() const {
+    return updateTime;
+}
+BVH & BVH::setLayout(BVHLayout layout) {
+    this->layout = layout;
+    return *this;
+}
+BVHLayout BVH::getLayout() const {
+    return layout;
+}
+BVH & BVH::setTrianglePacking(bool trianglePacking) {
+    this->trianglePacking = trianglePacking;
+    return *this;
+}
+bool BVH::getTrianglePacking() const {
+    return trianglePacking;
+}
+const std::vector<Vector3> & BVH::getTriangleVertices() const {
+    return triangleVertices;
+}
+const TriangleMesh * BVH::getTriangleMesh() const {
+    return triangleMesh;
+}
+const std::vector<BVHNode> & BVH::getNodes() const {
+    return nodes;
+}
+const std::vector<size_t> & BVH::getIndices() const {
+    return indices;
+}
+size_t BVH::getNodeCount() const {
+    return nodes.size();
+}
+BoundingBox3 BVH::getBoundingBox() const {
+    return nodes.empty() ? BoundingBox3() : nodes[0].boundingBox;
+}
+
+BVH & BVH::build(const TriangleMesh * triangleMesh) {
+    size_t start = time();
+
+    this->triangleMesh = triangleMesh;
+
+    nodes.clear();
+    indices.clear();
+    triangleVertices.clear();
+    subtrees.clear();
+    subtreeCosts.clear();
+    cost = buildCost = 0;
+    buildTime = 0;
+
+    if (triangleMesh == nullptr || triangleMesh->getTriangleCount() == 0)
+        return *this;
+
+    size_t triangleCount = triangleMesh->getTriangleCount();
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<BVHPrimitive> primitives(triangleCount);
+
+    parallelFor(triangleCount, threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            BVHPrimitive & primitive = primitives[i];
+
+            computeTriangleBox(triangleMesh, i, primitive.box);
+
+            for (size_t k = 0; k < 3; k++)
+                primitive.center[k] = (primitive.box.min[k] + primitive.box.max[k]) * 0.5;
+            primitive.index = i;
+        }
+    });
+
+    buildNodes(primitives, triangleMesh, buildMethod, maximumLeafSize, threads, splitBudget, nodes, indices);
+
+    computeSubtrees();
+    evaluate(false, subtreeCosts);
+    buildCost = cost;
+
+    if (layout != BVHLayout::DepthFirst || trianglePacking)
+        reorder();
+
+    buildTime = time() - start;
+
+    return *this;
+}
+BVH & BVH::build(const std::vector<BoundingBox3> & boundingBoxes) {
+    size_t start = time();
+
+    triangleMesh = nullptr;
+
+    nodes.clear();
+    indices.clear();
+    triangleVertices.clear();
+    subtrees.clear();
+    subtreeCosts.clear();
+    cost = buildCost = 0;
+    buildTime = 0;
+
+    if (boundingBoxes.empty())
+        return *this;
+
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<BVHPrimitive> primitives(boundingBoxes.size());
+
+    parallelFor(boundingBoxes.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            BVHPrimitive & primitive = primitives[i];
+
+            primitive.box.reset();
+            primitive.box.expand(&boundingBoxes[i].min.x);
+            primitive.box.expand(&boundingBoxes[i].max.x);
+
+            for (size_t k = 0; k < 3; k++)
+                primitive.center[k] = (primitive.box.min[k] + primitive.box.max[k]) * 0.5;
+            primitive.index = i;
+        }
+    });
+
+    // Divises espaciais exigem tringulos: caixas usam SAH por intervalos
+    BVHBuildMethod method = buildMethod == BVHBuildMethod::SpatialSAH ? BVHBuildMethod::BinnedSAH : buildMethod;
+
+    buildNodes(primitives, nullptr, method, maximumLeafSize, threads, 0, nodes, indices);
+
+    computeSubtrees();
+    evaluate(false, subtreeCosts);
+    buildCost = cost;
+
+    if (layout != BVHLayout::DepthFirst)
+        reorder();
+
+    buildTime = time() - start;
+
+    return *this;
+}
+bool BVH::load(const TriangleMesh * triangleMesh, const BVHCache & bvhCache) {
+    size_t start = time();
+
+    if (triangleMesh == nullptr || !bvhCache.isOpen() ||
+        bvhCache.getTriangleCount() != triangleMesh->getTriangleCount())
+        return false;
+
+    std::vector<BVHNode> cachedNodes;
+    std::vector<size_t> cachedIndices;
+
+    if (!bvhCache.read(cachedNodes, cachedIndices))
+        return false;
+
+    this->triangleMesh = triangleMesh;
+
+    nodes.swap(cachedNodes);
+    indices.swap(cachedIndices);
+    triangleVertices.clear();
+
+    // Custos e subrvores recalculados como aps a construo (ordem dos ns mantida do arquivo)
+    computeSubtrees();
+    evaluate(false, subtreeCosts);
+    buildCost = cost;
+
+    if (layout != BVHLayout::DepthFirst || trianglePacking)
+        reorder();
+
+    buildTime = time() - start;
+
+    return true;
+}
+BVH & BVH::refit() {
+    size_t start = time();
+
+    if (triangleMesh != nullptr) {
+        std::vector<double> costs;
+        evaluate(true, costs);
+
+        if (trianglePacking)
+            packTriangleVertices();
+    }
+
+    updateTime = time() - start;
+
+    return *this;
+}
+BVH & BVH::update() {
+    size_t start = time();
+
+    if (triangleMesh == nullptr || nodes.empty())
+        return *this;
+
+    std::vector<double> costs;
+    evaluate(true, costs);
+
+    if (cost > buildCost * rebuildThreshold) {
+        std::vector<size_t> degraded;
+        double degradedCost = 0, totalCost = 0;
+
+        for (size_t i = 0; i < subtrees.size(); i++) {
+            totalCost += costs[i];
+
+            if (costs[i] > subtreeCosts[i] * rebuildThreshold) {
+                degraded.push_back(i);
+                degradedCost += costs[i];
+            }
+        }
+
+        // Degradao concentrada em poucas subrvores: reconstruo parcial
+        if (!degraded.empty() && degradedCost < 0.5 * totalCost) {
+            rebuildSubtrees(degraded);
+            evaluate(false, costs);
+
+            for (size_t i = 0; i < degraded.size(); i++)
+                subtreeCosts[degraded[i]] = costs[degraded[i]];
+        }
+
+        if (cost > buildCost * rebuildThreshold)
+            build(triangleMesh);
+        else if (layout != BVHLayout::DepthFirst)
+            reorder();
+    }
+
+    if (trianglePacking)
+        packTriangleVertices();
+
+    updateTime = time() - start;
+
+    return *this;
+}
+void BVH::computeSubtrees() {
+    subtrees.clear();
+
+    if (nodes.empty())
+        return;
+
+    subtrees.push_back(std::make_pair(size_t(0), nodes.size()));
+
+    // Divide a maior subrvore interna at obter o nmero desejado
+    while (subtrees.size() < subtreeCount) {
+        size_t largest = subtrees.size();
+
+        for (size_t i = 0; i < subtrees.size(); i++) {
+            if (!nodes[subtrees[i].first].isLeaf() && (largest == subtrees.size() ||
+                subtrees[i].second - subtrees[i].first > subtrees[largest].second - subtrees[largest].first))
+                largest = i;
+        }
+
+        if (largest == subtrees.size())
+            break;
+
+        size_t begin = subtrees[largest].first, end = subtrees[largest].second;
+        size_t right = nodes[begin].offset;
+
+        subtrees[largest] = std::make_pair(begin + 1, right);
+        subtrees.push_back(std::make_pair(right, end));
+    }
+
+    std::sort(subtrees.begin(), subtrees.end());
+}
+void BVH::evaluate(bool updateBounds, std::vector<double> & costs) {
+    costs.assign(subtrees.size(), 0);
+
+    if (nodes.empty()) {
+        cost = 0;
+        return;
+    }
+
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    parallelFor(subtrees.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            costs[i] = refitRange(nodes, indices, triangleMesh, subtrees[i].first, subtrees[i].second, updateBounds);
+    });
+
+    double total = 0;
+
+    for (size_t i = 0; i < costs.size(); i++)
+        total += costs[i];
+
+    // Nveis superiores (fora das subrvores) depois de todas as subrvores
+    size_t i = nodes.size(), subtree = subtrees.size();
+
+    while (i > 0) {
+        if (subtree > 0 && subtrees[subtree - 1].second == i) {
+            i = subtrees[--subtree].first;
+            continue;
+        }
+
+        i--;
+        total += refitRange(nodes, indices, triangleMesh, i, i + 1, updateBounds);
+    }
+
+    double area = getSurfaceArea(nodes[0].boundingBox);
+
+    cost = area > 0 ? total / area : total;
+}
+void BVH::rebuildSubtrees(const std::vector<size_t> & degraded) {
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<std::vector<BVHNode> > rebuilt(degraded.size());
+
+    // Cada subrvore ocupa intervalo contguo de ndices: reconstruo no prprio intervalo
+    parallelFor(degraded.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            const std::pair<size_t, size_t> & range = subtrees[degraded[k]];
+            size_t first = indices.size(), last = 0;
+
+            for (size_t i = range.first; i < range.second; i++) {
+                if (nodes[i].isLeaf()) {
+                    first = std::min(first, nodes[i].offset);
+                    last = std::max(last, nodes[i].offset + nodes[i].count);
+                }
+            }
+
+            std::vector<BVHPrimitive> primitives(last - first);
+
+            for (size_t i = 0; i < primitives.size(); i++) {
+                BVHPrimitive & primitive = primitives[i];
+
+                computeTriangleBox(triangleMesh, indices[first + i], primitive.box);
+
+                for (size_t j = 0; j < 3; j++)
+                    primitive.center[j] = (primitive.box.min[j] + primitive.box.max[j]) * 0.5;
+                primitive.index = indices[first + i];
+            }
+
+            BinnedBuilder(primitives, maximumLeafSize, 1).build(rebuilt[k]);
+
+            for (size_t i = 0; i < primitives.size(); i++)
+                indices[first + i] = primitives[i].index;
+
+            for (size_t i = 0; i < rebuilt[k].size(); i++) {
+                if (rebuilt[k][i].isLeaf())
+                    rebuilt[k][i].offset += first;
+            }
+        }
+    });
+
+    // Novo ndice de um n antigo: deslocado pela variao de tamanho das subrvores anteriores
+    auto remap = [&](size_t node) {
+        size_t result = node;
+
+        for (size_t k = 0; k < degraded.size() && subtrees[degraded[k]].second <= node; k++)
+            result = result + rebuilt[k].size() - (subtrees[degraded[k]].second - subtrees[degraded[k]].first);
+
+        return result;
+    };
+
+    std::vector<BVHNode> output;
+    output.reserve(nodes.size());
+
+    for (size_t i = 0, k = 0; i < nodes.size();) {
+        if (k < degraded.size() && subtrees[degraded[k]].first == i) {
+            size_t base = output.size();
+
+            for (size_t j = 0; j < rebuilt[k].size(); j++) {
+                output.push_back(rebuilt[k][j]);
+
+                if (!rebuilt[k][j].isLeaf())
+                    output.back().offset += base;
+            }
+
+            i = subtrees[degraded[k++]].second;
+        }
+        else {
+            output.push_back(nodes[i]);
+
+            if (!nodes[i].isLeaf())
+                output.back().offset = remap(nodes[i].offset);
+            i++;
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t> > ranges(subtrees.size());
+
+    for (size_t i = 0; i < subtrees.size(); i++)
+        ranges[i] = std::make_pair(remap(subtrees[i].first), remap(subtrees[i].second));
+
+    subtrees.swap(ranges);
+    nodes.swap(output);
+}
+BVH & BVH::reorder() {
+    if (nodes.empty())
+        return *this;
+
+    std::vector<BVHNode> output;
+    std::vector<size_t> ordered, remap(nodes.size());
+    output.reserve(nodes.size());
+    ordered.reserve(indices.size());
+
+    // Pilha de pares (n antigo, pai que aponta para ele pelo deslocamento)
+    std::vector<std::pair<size_t, size_t> > stack;
+    stack.push_back(std::make_pair(size_t(0), nodes.size()));
+
+    while (!stack.empty()) {
+        size_t node = stack.back().first, parent = stack.back().second;
+        stack.pop_back();
+
+        size_t current = output.size();
+        output.push_back(nodes[node]);
+        remap[node] = current;
+
+        if (parent != nodes.size())
+            output[parent].offset = current;
+
+        BVHNode & result = output.back();
+
+        if (result.isLeaf()) {
+            result.offset = ordered.size();
+            ordered.insert(ordered.end(), indices.begin() + nodes[node].offset,
+                indices.begin() + nodes[node].offset + nodes[node].count);
+            continue;
+        }
+
+        // Filhos esquerdo e direito da diviso (independente da ordem atual)
+        bool swapped = (nodes[node].axis & 4) != 0;
+        size_t left = swapped ? nodes[node].offset : node + 1;
+        size_t right = swapped ? node + 1 : nodes[node].offset;
+
+        swapped = layout == BVHLayout::LargerChildFirst &&
+            getSurfaceArea(nodes[right].boundingBox) > getSurfaceArea(nodes[left].boundingBox);
+        result.axis = (nodes[node].axis & 3) | (swapped ? 4 : 0);
+
+        // Filho empilhado por ltimo  emitido logo aps o pai
+        stack.push_back(std::make_pair(swapped ? left : right, current));
+        stack.push_back(std::make_pair(swapped ? right : left, nodes.size()));
+    }
+
+    nodes.swap(output);
+    indices.swap(ordered);
+
+    // Subrvores continuam contguas: mantm custos de referncia com razes nas novas posies
+    std::vector<std::pair<size_t, size_t> > ranges;
+    std::vector<double> costs;
+    std::vector<size_t> order(subtrees.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return remap[subtrees[a].first] < remap[subtrees[b].first];
+    });
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const std::pair<size_t, size_t> & range = subtrees[order[i]];
+        size_t first = remap[range.first];
+
+        ranges.push_back(std::make_pair(first, first + range.second - range.first));
+        costs.push_back(subtreeCosts[order[i]]);
+    }
+
+    subtrees.swap(ranges);
+    subtreeCosts.swap(costs);
+
+    triangleVertices.clear();
+
+    if (trianglePacking && triangleMesh != nullptr)
+        packTriangleVertices();
+
+    return *this;
+}
+void BVH::packTriangleVertices() {
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    triangleVertices.resize(3 * indices.size());
+
+    parallelFor(indices.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            size_t v0, v1, v2;
+            triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+            triangleVertices[3 * i] = triangleMesh->getVertex(v0);
+            triangleVertices[3 * i + 1] = triangleMesh->getVertex(v1);
+            triangleVertices[3 * i + 2] = triangleMesh->getVertex(v2);
+        }
+    });
+}
+bool BVH::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (nodes.empty() || triangleMesh == nullptr)
+        return false;
+
+    bool negative[3] = {
+        ray3.inverseDirection.x < 0,
+        ray3.inverseDirection.y < 0,
+        ray3.inverseDirection.z < 0
+    };
+
+    double maximum = ray3.maximum;
+    double margin = getTriangleIntersectionMargin(&nodes[0].boundingBox.min.x, &nodes[0].boundingBox.max.x,
+        ray3.origin);
+    bool hit = false;
+    bool packed = !triangleVertices.empty();
+
+    size_t stack[stackSize];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+
+        if (intersectBoundingBox(node.boundingBox, ray3.origin, ray3.inverseDirection, ray3.minimum, maximum, margin)) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    const Vector3 * vertices[3];
+
+                    if (packed)
+                        vertices[0] = &triangleVertices[3 * i], vertices[1] = vertices[0] + 1, vertices[2] = vertices[0] + 2;
+                    else {
+                        size_t v0, v1, v2;
+                        triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+                        vertices[0] = &triangleMesh->getVertex(v0);
+                        vertices[1] = &triangleMesh->getVertex(v1);
+                        vertices[2] = &triangleMesh->getVertex(v2);
+                    }
+
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction, *vertices[0], *vertices[1], *vertices[2],
+                        distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                        maximum = distance;
+                        hit = true;
+
+                        rayHit.distance = distance;
+                        rayHit.u = u;
+                        rayHit.v = v;
+                        rayHit.index = indices[i];
+                    }
+                }
+            }
+            else {
+                // Filho direito da diviso  o seguinte quando o bit 2 do eixo est ativo
+                if (negative[node.axis & 3] != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return hit;
+}
+bool BVH::occluded(const Ray3 & ray3) const {
+    if (nodes.empty() || triangleMesh == nullptr)
+        return false;
+
+    double margin = getTriangleIntersectionMargin(&nodes[0].boundingBox.min.x, &nodes[0].boundingBox.max.x,
+        ray3.origin);
+    bool packed = !triangleVertices.empty();
+
+    size_t stack[stackSize];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+
+        if (intersectBoundingBox(node.boundingBox, ray3.origin, ray3.inverseDirection, ray3.minimum, ray3.maximum,
+            margin)) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    const Vector3 * vertices[3];
+
+                    if (packed)
+                        vertices[0] = &triangleVertices[3 * i], vertices[1] = vertices[0] + 1, vertices[2] = vertices[0] + 2;
+                    else {
+                        size_t v0, v1, v2;
+                        triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+                        vertices[0] = &triangleMesh->getVertex(v0);
+                        vertices[1] = &triangleMesh->getVertex(v1);
+                        vertices[2] = &triangleMesh->getVertex(v2);
+                    }
+
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction, *vertices[0], *vertices[1], *vertices[2],
+                        distance, u, v) && distance > ray3.minimum && distance < ray3.maximum)
+                        return true;
+                }
+            }
+            else {
+                // Qualquer interseo encerra a busca: filho seguinte primeiro, na ordem da memria
+                // (filho de maior rea, mais provvel de conter oclusor, em BVHLayout::LargerChildFirst)
+                stack[size++] = node.offset;
+                current = current + 1;
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return false;
+}
+
+AURORA_NAMESPACE_END
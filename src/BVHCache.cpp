@@ -0,0 +1,568 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/BVHCache.h>
+#include <aurora/BVH.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AURORA_NAMESPACE_BEGIN
+
+// Cabealho do arquivo (sees alinhadas em 64 bytes a partir do incio do arquivo)
+struct BVHCacheHeader {
+    char magic[8]; // Identificador do formato
+    uint32_t version; // Verso do formato
+    uint32_t byteOrder; // Marca de ordem dos bytes da mquina que escreveu o arquivo
+    uint64_t hash; // Hash do contedo da geometria
+    uint64_t triangleCount; // Nmero de tringulos da geometria
+    uint64_t nodeCount; // Nmero de ns
+    uint64_t referenceCount; // Nmero de referncias a tringulos nas folhas
+    uint64_t nodeOffset; // Posio da lista de ns
+    uint64_t indexOffset; // Posio da lista de ndices originais
+    uint64_t triangleOffset; // Posio da lista de vrtices reordenados
+    uint64_t size; // Tamanho total do arquivo
+};
+
+// N no arquivo (64 bytes, uma linha de cache)
+struct BVHCacheNode {
+    double min[3], max[3]; // Caixa delimitadora
+    uint32_t offset; // ndice do filho direito (n interno) ou da primeira referncia (folha)
+    uint32_t count; // Nmero de referncias (zero em ns internos)
+    uint32_t axis; // Eixo de diviso e ordem dos filhos (ns internos, como em BVHNode)
+    uint32_t padding; // Alinhamento
+};
+
+namespace {
+
+const char magic[8] = { 'A', 'U', 'R', 'B', 'V', 'H', '0', '1' };
+const uint32_t version = 1;
+const uint32_t byteOrder = 0x01020304;
+const size_t alignment = 64;
+const size_t stackSize = 128;
+const size_t writeBlockSize = 1 << 16;
+
+inline uint64_t align(uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+inline uint64_t mix(uint64_t hash, uint64_t value) {
+    hash ^= value * 0x9E3779B97F4A7C15ull;
+    hash = (hash << 27) | (hash >> 37);
+
+    return hash * 0xC2B2AE3D27D4EB4Full;
+}
+
+inline uint64_t mix(uint64_t hash, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    return mix(hash, bits);
+}
+
+// Teste de caixa expandida por "margin" (zero exceto com o teste estanque de tringulos)
+inline bool intersectBoundingBox(const BVHCacheNode & node, const Vector3 & origin, const Vector3 & inverseDirection,
+    double minimum, double maximum, double margin) {
+    double t0 = minimum, t1 = maximum;
+
+    for (size_t i = 0; i < 3; i++) {
+        double tNear = (node.min[i] - margin - origin[i]) * inverseDirection[i];
+        double tFar = (node.max[i] + margin - origin[i]) * inverseDirection[i];
+
+        if (tNear > tFar)
+            std::swap(tNear, tFar);
+
+        tFar *= AURORA_SLAB_ROUNDING;
+
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+
+        if (t0 > t1)
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+BVHCache::BVHCache()
+    : data(nullptr), size(0), mapping(nullptr), header(nullptr),
+    nodes(nullptr), indices(nullptr), triangles(nullptr) {}
+BVHCache::~BVHCache() {
+    close();
+}
+
+std::ostream & operator <<(std::ostream & lhs, const BVHCache & rhs) {
+    return lhs << "Triangles: " << rhs.getTriangleCount() << std::endl
+        << "Nodes: " << rhs.getNodeCount() << std::endl
+        << "Size: " << rhs.size << " bytes";
+}
+
+uint64_t BVHCache::computeHash(const TriangleMesh * triangleMesh) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    const std::vector<Vector3> & vertices = triangleMesh->getVertices();
+    const std::vector<size_t> & vertexIndices = triangleMesh->getVertexIndices();
+
+    hash = mix(hash, (uint64_t)vertices.size());
+    hash = mix(hash, (uint64_t)vertexIndices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        hash = mix(hash, vertices[i].x);
+        hash = mix(hash, vertices[i].y);
+        hash = mix(hash, vertices[i].z);
+    }
+
+    for (size_t i = 0; i < vertexIndices.size(); i++)
+        hash = mix(hash, (uint64_t)vertexIndices[i]);
+
+    // Finalizao (avalanche); zero  reservado para "qualquer geometria"
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+
+    return hash != 0 ? hash : 1;
+}
+bool BVHCache::write(const std::string & filename, const BVH & bvh, uint64_t hash) {
+    const TriangleMesh * triangleMesh = bvh.getTriangleMesh();
+    const std::vector<BVHNode> & bvhNodes = bvh.getNodes();
+    const std::vector<size_t> & bvhIndices = bvh.getIndices();
+
+    if (triangleMesh == nullptr || bvhNodes.empty() || bvhNodes.size() > UINT32_MAX || bvhIndices.size() > UINT32_MAX)
+        return false;
+
+    std::ofstream file(filename, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+    if (!file.is_open())
+        return false;
+
+    BVHCacheHeader fileHeader;
+    std::memset(&fileHeader, 0, sizeof(fileHeader));
+    std::memcpy(fileHeader.magic, magic, sizeof(magic));
+
+    fileHeader.version = version;
+    fileHeader.byteOrder = byteOrder;
+    fileHeader.hash = hash;
+    fileHeader.triangleCount = triangleMesh->getTriangleCount();
+    fileHeader.nodeCount = bvhNodes.size();
+    fileHeader.referenceCount = bvhIndices.size();
+    fileHeader.nodeOffset = align(sizeof(BVHCacheHeader));
+    fileHeader.indexOffset = align(fileHeader.nodeOffset + fileHeader.nodeCount * sizeof(BVHCacheNode));
+    fileHeader.triangleOffset = align(fileHeader.indexOffset + fileHeader.referenceCount * sizeof(uint32_t));
+    fileHeader.size = fileHeader.triangleOffset + fileHeader.referenceCount * 9 * sizeof(double);
+
+    char padding[alignment] = {};
+
+    file.write((const char *)&fileHeader, sizeof(fileHeader));
+    file.write(padding, fileHeader.nodeOffset - sizeof(fileHeader));
+
+    // Sees escritas em blocos para limitar memria temporria
+    std::vector<BVHCacheNode> nodeBlock;
+    nodeBlock.reserve(writeBlockSize);
+
+    for (size_t i = 0; i < bvhNodes.size(); i++) {
+        const BVHNode & bvhNode = bvhNodes[i];
+        BVHCacheNode node;
+
+        for (size_t k = 0; k < 3; k++) {
+            node.min[k] = bvhNode.boundingBox.min[k];
+            node.max[k] = bvhNode.boundingBox.max[k];
+        }
+
+        node.offset = (uint32_t)bvhNode.offset;
+        node.count = (uint32_t)bvhNode.count;
+        node.axis = (uint32_t)bvhNode.axis;
+        node.padding = 0;
+
+        nodeBlock.push_back(node);
+
+        if (nodeBlock.size() == writeBlockSize || i + 1 == bvhNodes.size()) {
+            file.write((const char *)&nodeBlock[0], nodeBlock.size() * sizeof(BVHCacheNode));
+            nodeBlock.clear();
+        }
+    }
+
+    file.write(padding, fileHeader.indexOffset - (fileHeader.nodeOffset + fileHeader.nodeCount * sizeof(BVHCacheNode)));
+
+    std::vector<uint32_t> indexBlock;
+    indexBlock.reserve(writeBlockSize);
+
+    for (size_t i = 0; i < bvhIndices.size(); i++) {
+        indexBlock.push_back((uint32_t)bvhIndices[i]);
+
+        if (indexBlock.size() == writeBlockSize || i + 1 == bvhIndices.size()) {
+            file.write((const char *)&indexBlock[0], indexBlock.size() * sizeof(uint32_t));
+            indexBlock.clear();
+        }
+    }
+
+    file.write(padding, fileHeader.triangleOffset - (fileHeader.indexOffset + fileHeader.referenceCount * sizeof(uint32_t)));
+
+    std::vector<double> triangleBlock;
+    triangleBlock.reserve(writeBlockSize * 9);
+
+    for (size_t i = 0; i < bvhIndices.size(); i++) {
+        size_t v[3];
+        triangleMesh->getVertexIndices(bvhIndices[i], v[0], v[1], v[2]);
+
+        for (size_t j = 0; j < 3; j++) {
+            const Vector3 & vertex = triangleMesh->getVertex(v[j]);
+
+            triangleBlock.push_back(vertex.x);
+            triangleBlock.push_back(vertex.y);
+            triangleBlock.push_back(vertex.z);
+        }
+
+        if (triangleBlock.size() == writeBlockSize * 9 || i + 1 == bvhIndices.size()) {
+            file.write((const char *)&triangleBlock[0], triangleBlock.size() * sizeof(double));
+            triangleBlock.clear();
+        }
+    }
+
+    bool success = file.good();
+
+    file.close();
+
+    return success;
+}
+
+bool BVHCache::open(const std::string & filename, uint64_t hash) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(BVHCacheHeader)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (fileMapping == nullptr)
+        return false;
+
+    data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+        CloseHandle(fileMapping);
+        return false;
+    }
+
+    mapping = fileMapping;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = ::open(filename.c_str(), O_RDONLY);
+
+    if (file < 0)
+        return false;
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(BVHCacheHeader)) {
+        ::close(file);
+        return false;
+    }
+
+    void * address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    data = address;
+    size = (size_t)status.st_size;
+#endif
+
+    const char * bytes = (const char *)data;
+    header = (const BVHCacheHeader *)bytes;
+
+    // Arquivo invlido, de outra verso, de outra ordem de bytes, truncado ou de outra geometria
+    // (contagens limitadas pelo tamanho do arquivo antes dos produtos, sees alinhadas)
+    if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version ||
+        header->byteOrder != byteOrder || header->size != size || (hash != 0 && header->hash != hash) ||
+        header->nodeCount == 0 || header->nodeCount > size / sizeof(BVHCacheNode) ||
+        header->referenceCount > size / (9 * sizeof(double)) ||
+        header->nodeOffset % alignment != 0 || header->indexOffset % alignment != 0 ||
+        header->triangleOffset % alignment != 0 ||
+        header->nodeOffset + header->nodeCount * sizeof(BVHCacheNode) > header->indexOffset ||
+        header->indexOffset + header->referenceCount * sizeof(uint32_t) > header->triangleOffset ||
+        header->triangleOffset + header->referenceCount * 9 * sizeof(double) > size) {
+        close();
+        return false;
+    }
+
+    nodes = (const BVHCacheNode *)(bytes + header->nodeOffset);
+    indices = (const uint32_t *)(bytes + header->indexOffset);
+    triangles = (const double *)(bytes + header->triangleOffset);
+
+    if (!validate()) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+bool BVHCache::validate() const {
+    size_t nodeCount = (size_t)header->nodeCount;
+    size_t referenceCount = (size_t)header->referenceCount;
+
+    // Filhos com ndices maiores que o pai (travessia termina) e profundidade menor que a pilha;
+    // pais sempre antes dos filhos, logo a profundidade de cada n j  conhecida ao visit-lo
+    std::vector<unsigned char> depths(nodeCount, 0);
+
+    for (size_t i = 0; i < nodeCount; i++) {
+        const BVHCacheNode & node = nodes[i];
+
+        if (node.count != 0) {
+            if (node.offset > referenceCount || node.count > referenceCount - node.offset)
+                return false;
+        }
+        else {
+            if (i + 1 >= nodeCount || node.offset <= i + 1 || node.offset >= nodeCount ||
+                (size_t)depths[i] + 1 >= stackSize)
+                return false;
+
+            depths[i + 1] = std::max(depths[i + 1], (unsigned char)(depths[i] + 1));
+            depths[node.offset] = std::max(depths[node.offset], (unsigned char)(depths[i] + 1));
+        }
+    }
+
+    for (size_t i = 0; i < referenceCount; i++)
+        if (indices[i] >= header->triangleCount)
+            return false;
+
+    return true;
+}
+void BVHCache::close() {
+    if (data != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle((HANDLE)mapping);
+#else
+        munmap(data, size);
+#endif
+    }
+
+    data = nullptr;
+    size = 0;
+    mapping = nullptr;
+    header = nullptr;
+    nodes = nullptr;
+    indices = nullptr;
+    triangles = nullptr;
+}
+bool BVHCache::isOpen() const {
+    return data != nullptr;
+}
+
+uint64_t BVHCache::getHash() const {
+    return header ? header->hash : 0;
+}
+size_t BVHCache::getTriangleCount() const {
+    return header ? (size_t)header->triangleCount : 0;
+}
+size_t BVHCache::getNodeCount() const {
+    return header ? (size_t)header->nodeCount : 0;
+}
+size_t BVHCache::getSize() const {
+    return size;
+}
+
+bool BVHCache::read(std::vector<BVHNode> & bvhNodes, std::vector<size_t> & bvhIndices) const {
+    if (header == nullptr)
+        return false;
+
+    bvhNodes.resize((size_t)header->nodeCount);
+    bvhIndices.resize((size_t)header->referenceCount);
+
+    for (size_t i = 0; i < bvhNodes.size(); i++) {
+        const BVHCacheNode & node = nodes[i];
+        BVHNode & bvhNode = bvhNodes[i];
+
+        for (size_t k = 0; k < 3; k++) {
+            bvhNode.boundingBox.min[k] = node.min[k];
+            bvhNode.boundingBox.max[k] = node.max[k];
+        }
+
+        bvhNode.offset = node.offset;
+        bvhNode.count = node.count;
+        bvhNode.axis = node.axis;
+    }
+
+    for (size_t i = 0; i < bvhIndices.size(); i++)
+        bvhIndices[i] = indices[i];
+
+    return true;
+}
+
+bool BVHCache::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (header == nullptr)
+        return false;
+
+    bool negative[3] = {
+        ray3.inverseDirection.x < 0,
+        ray3.inverseDirection.y < 0,
+        ray3.inverseDirection.z < 0
+    };
+
+    double maximum = ray3.maximum;
+    double margin = getTriangleIntersectionMargin(nodes[0].min, nodes[0].max, ray3.origin);
+    bool hit = false;
+
+    size_t stack[stackSize];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHCacheNode & node = nodes[current];
+
+        if (intersectBoundingBox(node, ray3.origin, ray3.inverseDirection, ray3.minimum, maximum, margin)) {
+            if (node.count != 0) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    const double * triangle = triangles + 9 * i;
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction,
+                        Vector3(triangle[0], triangle[1], triangle[2]),
+                        Vector3(triangle[3], triangle[4], triangle[5]),
+                        Vector3(triangle[6], triangle[7], triangle[8]),
+                        distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                        maximum = distance;
+                        hit = true;
+
+                        rayHit.distance = distance;
+                        rayHit.u = u;
+                        rayHit.v = v;
+                        rayHit.index = indices[i];
+                    }
+                }
+            }
+            else {
+                if (negative[node.axis & 3] != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return hit;
+}
+bool BVHCache::occluded(const Ray3 & ray3) const {
+    if (header == nullptr)
+        return false;
+
+    bool negative[3] = {
+        ray3.inverseDirection.x < 0,
+        ray3.inverseDirection.y < 0,
+        ray3.inverseDirection.z < 0
+    };
+
+    double margin = getTriangleIntersectionMargin(nodes[0].min, nodes[0].max, ray3.origin);
+
+    size_t stack[stackSize];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHCacheNode & node = nodes[current];
+
+        if (intersectBoundingBox(node, ray3.origin, ray3.inverseDirection, ray3.minimum, ray3.maximum, margin)) {
+            if (node.count != 0) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    const double * triangle = triangles + 9 * i;
+                    double distance, u, v;
+
+                    if (intersectTriangle(ray3.origin, ray3.direction,
+                        Vector3(triangle[0], triangle[1], triangle[2]),
+                        Vector3(triangle[3], triangle[4], triangle[5]),
+                        Vector3(triangle[6], triangle[7], triangle[8]),
+                        distance, u, v) && distance > ray3.minimum && distance < ray3.maximum)
+                        return true;
+                }
+            }
+            else {
+                if (negative[node.axis & 3] != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return false;
+}
+
+AURORA_NAMESPACE_END
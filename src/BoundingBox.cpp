@@ -0,0 +1,118 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/BoundingBox.h>
+#include <aurora/Math.h>
+#include <aurora/Ray.h>
+
+AURORA_NAMESPACE_BEGIN
+
+BoundingBox3::BoundingBox3()
+    : min(AURORA_INFINITY, AURORA_INFINITY, AURORA_INFINITY),
+    max(-AURORA_INFINITY, -AURORA_INFINITY, -AURORA_INFINITY) {}
+BoundingBox3::BoundingBox3(const BoundingBox3 & boundingBox3)
+    : min(boundingBox3.min), max(boundingBox3.max) {}
+BoundingBox3::BoundingBox3(const Vector3 & min, const Vector3 & max) : min(min), max(max) {}
+BoundingBox3::~BoundingBox3() {}
+
+bool BoundingBox3::operator ==(const BoundingBox3 & rhs) const {
+    return min == rhs.min && max == rhs.max;
+}
+bool BoundingBox3::operator !=(const BoundingBox3 & rhs) const {
+    return !(*this == rhs);
+}
+std::ostream & operator <<(std::ostream & lhs, const BoundingBox3 & rhs) {
+    return lhs << '[' << rhs.min << ' ' << rhs.max << ']';
+}
+
+BoundingBox3 & BoundingBox3::expand(const Vector3 & point) {
+    min = min.min(point);
+    max = max.max(point);
+
+    return *this;
+}
+BoundingBox3 & BoundingBox3::expand(const BoundingBox3 & boundingBox3) {
+    min = min.min(boundingBox3.min);
+    max = max.max(boundingBox3.max);
+
+    return *this;
+}
+Vector3 BoundingBox3::getCenter() const {
+    return (min + max) * 0.5;
+}
+Vector3 BoundingBox3::getSize() const {
+    return max - min;
+}
+double BoundingBox3::getSurfaceArea() const {
+    if (isEmpty())
+        return 0;
+
+    Vector3 size = getSize();
+
+    return 2.0 * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+size_t BoundingBox3::getMaximumExtent() const {
+    Vector3 size = getSize();
+
+    if (size.x > size.y && size.x > size.z)
+        return 0;
+
+    return size.y > size.z ? 1 : 2;
+}
+bool BoundingBox3::isEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+bool BoundingBox3::intersects(const Ray3 & ray3, double & near, double & far) const {
+    double t0 = ray3.minimum;
+    double t1 = ray3.maximum;
+
+    for (size_t i = 0; i < 3; i++) {
+        double tNear = (min[i] - ray3.origin[i]) * ray3.inverseDirection[i];
+        double tFar = (max[i] - ray3.origin[i]) * ray3.inverseDirection[i];
+
+        if (tNear > tFar) {
+            double t = tNear;
+            tNear = tFar;
+            tFar = t;
+        }
+
+        tFar *= AURORA_SLAB_ROUNDING;
+
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+
+        if (t0 > t1)
+            return false;
+    }
+
+    near = t0;
+    far = t1;
+
+    return true;
+}
+
+AURORA_NAMESPACE_END
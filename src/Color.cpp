@@ -147,6 +147,9 @@ Color3 & Color3::saturate() {
 
     return *this;
 }
+double Color3::luminance() const {
+    return 0.2126 * r + 0.7152 * g + 0.0722 * b;
+}
 
 Color4::Color4() : r(0), g(0), b(0), a(0) {}
 Color4::Color4(const Color4 & color4) : r(color4.r), g(color4.g), b(color4.b), a(color4.a) {}
@@ -0,0 +1,231 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Instance.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+
+#include <algorithm>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const size_t stackSize = 128;
+
+// Transformao "v * M" de ponto (com translao) e de vetor (sem translao)
+inline Vector3 transformPoint(const Vector3 & point, const Matrix4 & matrix) {
+    const double * m0 = matrix[0], * m1 = matrix[1], * m2 = matrix[2], * m3 = matrix[3];
+
+    return Vector3(
+        point.x * m0[0] + point.y * m1[0] + point.z * m2[0] + m3[0],
+        point.x * m0[1] + point.y * m1[1] + point.z * m2[1] + m3[1],
+        point.x * m0[2] + point.y * m1[2] + point.z * m2[2] + m3[2]);
+}
+
+inline Vector3 transformVector(const Vector3 & vector, const Matrix4 & matrix) {
+    const double * m0 = matrix[0], * m1 = matrix[1], * m2 = matrix[2];
+
+    return Vector3(
+        vector.x * m0[0] + vector.y * m1[0] + vector.z * m2[0],
+        vector.x * m0[1] + vector.y * m1[1] + vector.z * m2[1],
+        vector.x * m0[2] + vector.y * m1[2] + vector.z * m2[2]);
+}
+
+inline bool intersectBoundingBox(
+    const BoundingBox3 & boundingBox, const Vector3 & origin, const Vector3 & inverseDirection,
+    double minimum, double maximum) {
+    double t0 = minimum, t1 = maximum;
+
+    for (size_t i = 0; i < 3; i++) {
+        double tNear = (boundingBox.min[i] - origin[i]) * inverseDirection[i];
+        double tFar = (boundingBox.max[i] - origin[i]) * inverseDirection[i];
+
+        if (tNear > tFar)
+            std::swap(tNear, tFar);
+
+        tFar *= AURORA_SLAB_ROUNDING;
+
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+
+        if (t0 > t1)
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+Instance::Instance() : bvh(nullptr) {}
+Instance::Instance(const Instance & instance)
+    : bvh(instance.bvh), transform(instance.transform), inverseTransform(instance.inverseTransform) {}
+Instance::Instance(const BVH * bvh, const Matrix4 & transform)
+    : bvh(bvh), transform(transform), inverseTransform(transform.inverse()) {}
+Instance::~Instance() {}
+
+BoundingBox3 Instance::getBoundingBox() const {
+    BoundingBox3 boundingBox;
+
+    if (bvh == nullptr || bvh->getNodeCount() == 0)
+        return boundingBox;
+
+    BoundingBox3 objectBox = bvh->getBoundingBox();
+
+    // Caixa em espao de mundo envolve os 8 vrtices transformados
+    for (size_t i = 0; i < 8; i++) {
+        Vector3 corner(
+            i & 1 ? objectBox.max.x : objectBox.min.x,
+            i & 2 ? objectBox.max.y : objectBox.min.y,
+            i & 4 ? objectBox.max.z : objectBox.min.z);
+
+        boundingBox.expand(transformPoint(corner, transform));
+    }
+
+    return boundingBox;
+}
+bool Instance::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    // Direo no normalizada preserva a distncia paramtrica entre os espaos
+    Ray3 query(transformPoint(ray3.origin, inverseTransform), transformVector(ray3.direction, inverseTransform),
+        ray3.minimum, ray3.maximum);
+
+    return bvh->intersect(query, rayHit);
+}
+
+InstanceBVH::InstanceBVH() {
+    bvh.setMaximumLeafSize(1);
+}
+InstanceBVH::InstanceBVH(const InstanceBVH & instanceBVH)
+    : instances(instanceBVH.instances), bvh(instanceBVH.bvh) {}
+InstanceBVH::~InstanceBVH() {}
+
+std::ostream & operator <<(std::ostream & lhs, const InstanceBVH & rhs) {
+    return lhs << "Instances: " << rhs.instances.size() << std::endl
+        << "Nodes: " << rhs.bvh.getNodeCount() << std::endl
+        << "Bounding box: " << rhs.bvh.getBoundingBox() << std::endl
+        << "Memory: " << rhs.getMemorySize() << " bytes" << std::endl
+        << "Build time: " << rhs.bvh.getBuildTime() << " ms";
+}
+
+size_t InstanceBVH::addInstance(const BVH * bvh, const Matrix4 & transform) {
+    instances.push_back(Instance(bvh, transform));
+    return instances.size() - 1;
+}
+InstanceBVH & InstanceBVH::clear() {
+    std::vector<Instance>().swap(instances);
+    bvh.build(std::vector<BoundingBox3>());
+    return *this;
+}
+const Instance & InstanceBVH::getInstance(size_t i) const {
+    return instances[i];
+}
+size_t InstanceBVH::getInstanceCount() const {
+    return instances.size();
+}
+const BVH & InstanceBVH::getBVH() const {
+    return bvh;
+}
+size_t InstanceBVH::getMemorySize() const {
+    return instances.capacity() * sizeof(Instance)
+        + bvh.getNodes().capacity() * sizeof(BVHNode)
+        + bvh.getIndices().capacity() * sizeof(size_t);
+}
+
+InstanceBVH & InstanceBVH::build(BVHBuildMethod buildMethod) {
+    std::vector<BoundingBox3> boundingBoxes(instances.size());
+
+    for (size_t i = 0; i < instances.size(); i++)
+        boundingBoxes[i] = instances[i].getBoundingBox();
+
+    bvh.setBuildMethod(buildMethod);
+    bvh.build(boundingBoxes);
+
+    return *this;
+}
+bool InstanceBVH::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    const std::vector<BVHNode> & nodes = bvh.getNodes();
+    const std::vector<size_t> & indices = bvh.getIndices();
+
+    if (nodes.empty())
+        return false;
+
+    bool negative[3] = {
+        ray3.inverseDirection.x < 0,
+        ray3.inverseDirection.y < 0,
+        ray3.inverseDirection.z < 0
+    };
+
+    Ray3 query(ray3);
+    bool hit = false;
+
+    size_t stack[stackSize];
+    size_t size = 0;
+    size_t current = 0;
+
+    while (true) {
+        const BVHNode & node = nodes[current];
+
+        if (intersectBoundingBox(node.boundingBox, query.origin, query.inverseDirection, query.minimum, query.maximum)) {
+            if (node.isLeaf()) {
+                for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                    RayHit instanceHit;
+
+                    if (instances[indices[i]].intersect(query, instanceHit)) {
+                        query.maximum = instanceHit.distance;
+                        hit = true;
+
+                        rayHit = instanceHit;
+                        rayHit.instance = indices[i];
+                    }
+                }
+            }
+            else {
+                if (negative[node.axis & 3] != ((node.axis & 4) != 0)) {
+                    stack[size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[size++] = node.offset;
+                    current = current + 1;
+                }
+
+                continue;
+            }
+        }
+
+        if (size == 0)
+            break;
+
+        current = stack[--size];
+    }
+
+    return hit;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,91 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Random.h>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const uint64_t pcgMultiplier = 6364136223846793005ULL;
+const double uint32Scale = 1.0 / 4294967296.0; // Converte inteiro de 32 bits para "[0, 1)"
+
+// Finalizador de SplitMix64: cada bit de entrada afeta todos os bits de sada
+inline uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+}
+
+PCG32::PCG32(uint64_t seed, uint64_t sequence) {
+    setSeed(seed, sequence);
+}
+PCG32::PCG32(const PCG32 & pcg32) : state(pcg32.state), increment(pcg32.increment) {}
+PCG32::~PCG32() {}
+
+PCG32 & PCG32::setSeed(uint64_t seed, uint64_t sequence) {
+    state = 0;
+    increment = (sequence << 1) | 1;
+
+    nextUInt();
+    state += seed;
+    nextUInt();
+
+    return *this;
+}
+uint64_t PCG32::getSequence() const {
+    return increment >> 1;
+}
+
+uint32_t PCG32::nextUInt() {
+    uint64_t previous = state;
+
+    state = previous * pcgMultiplier + increment;
+
+    // Sada XSH-RR: bits altos misturados por deslocamento e rotao dependente do estado
+    uint32_t shifted = (uint32_t)(((previous >> 18) ^ previous) >> 27);
+    uint32_t rotation = (uint32_t)(previous >> 59);
+
+    return (shifted >> rotation) | (shifted << ((32 - rotation) & 31));
+}
+double PCG32::nextDouble() {
+    return nextUInt() * uint32Scale;
+}
+
+uint32_t hashRandom(uint64_t pixel, uint32_t sampleIndex, uint32_t dimension, uint32_t seed) {
+    uint64_t hash = mix(pixel + 0x9E3779B97F4A7C15ULL * ((uint64_t)seed + 1));
+
+    return (uint32_t)(mix(hash ^ (((uint64_t)sampleIndex << 32) | dimension)) >> 32);
+}
+double hashUniform(uint64_t pixel, uint32_t sampleIndex, uint32_t dimension, uint32_t seed) {
+    return hashRandom(pixel, sampleIndex, dimension, seed) * uint32Scale;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,349 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Rasterizer.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const double behindEpsilon = 1e-12; // Profundidade do plano de recorte (tringulos atrs da cmera so cortados nele)
+
+// Tringulo preparado: funes de aresta lineares nas coordenadas de pixel "E(x, y) = a x + b y + c"
+// (produto misto da direo de cmera com os vrtices de cada aresta) e pixels cobertos pela projeo
+struct RasterTriangle {
+    double edges[3][3]; // Coeficientes das funes de aresta opostas aos vrtices 0, 1 e 2
+    double inverseVolume; // Inverso do produto misto dos vrtices relativos  cmera (sinal define face)
+    int bounds[4]; // Pixels mnimos (x, y) e mximos (x, y) inclusive (mnimo maior que mximo se invisvel)
+};
+
+template <typename Function>
+void parallelFor(size_t count, size_t threadCount, const Function & function) {
+    threadCount = std::min(threadCount, count);
+
+    if (threadCount <= 1) {
+        function(0, 0, count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(std::cref(function),
+            i, count * i / threadCount, count * (i + 1) / threadCount));
+
+    for (size_t i = 0; i < threadCount; i++)
+        threads[i].join();
+}
+
+inline void cross(const double * lhs, const double * rhs, double * result) {
+    result[0] = lhs[1] * rhs[2] - lhs[2] * rhs[1];
+    result[1] = lhs[2] * rhs[0] - lhs[0] * rhs[2];
+    result[2] = lhs[0] * rhs[1] - lhs[1] * rhs[0];
+}
+
+inline double dot(const double * lhs, const double * rhs) {
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+}
+
+}
+
+Rasterizer::Rasterizer() : fieldOfView(AURORA_PI / 4), width(0), height(0), tileSize(32), threadCount(0) {
+    worldMatrix.setIdentity();
+}
+Rasterizer::Rasterizer(const Rasterizer & rasterizer)
+    : worldMatrix(rasterizer.worldMatrix), fieldOfView(rasterizer.fieldOfView), width(rasterizer.width),
+    height(rasterizer.height), tileSize(rasterizer.tileSize), threadCount(rasterizer.threadCount) {}
+Rasterizer::~Rasterizer() {}
+
+Rasterizer & Rasterizer::setCamera(const Matrix4 & worldMatrix, double fieldOfView, size_t width, size_t height) {
+    this->worldMatrix = worldMatrix;
+    this->fieldOfView = fieldOfView;
+    this->width = width;
+    this->height = height;
+    return *this;
+}
+Rasterizer & Rasterizer::setTileSize(size_t tileSize) {
+    this->tileSize = std::max(tileSize, (size_t)1);
+    return *this;
+}
+size_t Rasterizer::getTileSize() const {
+    return tileSize;
+}
+Rasterizer & Rasterizer::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+    return *this;
+}
+size_t Rasterizer::getThreadCount() const {
+    return threadCount;
+}
+size_t Rasterizer::getWidth() const {
+    return width;
+}
+size_t Rasterizer::getHeight() const {
+    return height;
+}
+
+void Rasterizer::rasterize(const TriangleMesh * triangleMesh, const Vector2 * samples,
+    std::vector<RayHit> & rayHits) const {
+    rayHits.assign(width * height, RayHit());
+
+    if (triangleMesh == nullptr || width == 0 || height == 0)
+        return;
+
+    size_t threads = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Direo de cmera do ponto "(x, y)" em pixels: "D = x Dx + y Dy + D0" (afim, como nos raios de cmera)
+    double aspectRatio = (double)width / height;
+    double scale = std::tan(fieldOfView / 2);
+    double axes[3][3], origin[3];
+
+    for (size_t k = 0; k < 3; k++) {
+        for (size_t i = 0; i < 3; i++)
+            axes[i][k] = worldMatrix[i][k];
+
+        origin[k] = worldMatrix[3][k];
+    }
+
+    double directionX[3], directionY[3], direction0[3];
+
+    for (size_t k = 0; k < 3; k++) {
+        directionX[k] = 2 * aspectRatio * scale / width * axes[0][k];
+        directionY[k] = -2 * scale / height * axes[1][k];
+        direction0[k] = -aspectRatio * scale * axes[0][k] + scale * axes[1][k] - axes[2][k];
+    }
+
+    Matrix4 inverseMatrix = worldMatrix.inverse();
+
+    const std::vector<Vector3> & vertices = triangleMesh->getVertices();
+    const std::vector<size_t> & vertexIndices = triangleMesh->getVertexIndices();
+    size_t triangleCount = vertexIndices.size() / 3;
+    std::vector<RasterTriangle> triangles(triangleCount);
+
+    parallelFor(triangleCount, threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            RasterTriangle & triangle = triangles[t];
+            double points[3][3], cameraPoints[3][3];
+            double minimum[2] = { AURORA_INFINITY, AURORA_INFINITY };
+            double maximum[2] = { -AURORA_INFINITY, -AURORA_INFINITY };
+            size_t behind = 0;
+
+            triangle.bounds[0] = triangle.bounds[1] = 0;
+            triangle.bounds[2] = triangle.bounds[3] = -1;
+
+            for (size_t i = 0; i < 3; i++) {
+                const double * position = &vertices[vertexIndices[3 * t + i]].x;
+
+                // Vrtices relativos  cmera calculados sempre da mesma forma (arestas compartilhadas exatas)
+                for (size_t k = 0; k < 3; k++) {
+                    points[i][k] = position[k] - origin[k];
+                    cameraPoints[i][k] = position[0] * inverseMatrix[0][k] + position[1] * inverseMatrix[1][k] +
+                        position[2] * inverseMatrix[2][k] + inverseMatrix[3][k];
+                }
+
+                if (-cameraPoints[i][2] < behindEpsilon)
+                    behind++;
+            }
+
+            if (behind == 3)
+                continue;
+
+            // Limites da parte  frente da cmera: vrtices  frente e cortes das arestas no plano de recorte
+            for (size_t i = 0; i < 3; i++) {
+                const double * a = cameraPoints[i];
+                const double * b = cameraPoints[(i + 1) % 3];
+                double projected[2][3];
+                size_t count = 0;
+
+                if (-a[2] >= behindEpsilon)
+                    std::copy(a, a + 3, projected[count++]);
+
+                if ((-a[2] < behindEpsilon) != (-b[2] < behindEpsilon)) {
+                    double s = (-behindEpsilon - a[2]) / (b[2] - a[2]);
+
+                    for (size_t k = 0; k < 3; k++)
+                        projected[count][k] = a[k] + s * (b[k] - a[k]);
+
+                    projected[count++][2] = -behindEpsilon;
+                }
+
+                for (size_t j = 0; j < count; j++) {
+                    double x = (projected[j][0] / -projected[j][2] / (aspectRatio * scale) + 1) * width / 2;
+                    double y = (1 - projected[j][1] / -projected[j][2] / scale) * height / 2;
+
+                    minimum[0] = std::min(minimum[0], x);
+                    minimum[1] = std::min(minimum[1], y);
+                    maximum[0] = std::max(maximum[0], x);
+                    maximum[1] = std::max(maximum[1], y);
+                }
+            }
+
+            double normals[3][3];
+
+            cross(points[1], points[2], normals[0]);
+            cross(points[2], points[0], normals[1]);
+            cross(points[0], points[1], normals[2]);
+
+            double volume = dot(points[0], normals[0]);
+
+            // Plano do tringulo passa pela cmera (visto de perfil)
+            if (volume == 0)
+                continue;
+
+            for (size_t i = 0; i < 3; i++) {
+                triangle.edges[i][0] = dot(directionX, normals[i]);
+                triangle.edges[i][1] = dot(directionY, normals[i]);
+                triangle.edges[i][2] = dot(direction0, normals[i]);
+            }
+
+            triangle.inverseVolume = 1.0 / volume;
+
+            // Amostras do pixel "x" ficam em [x, x + 1): margem de um pixel cobre arredondamento da projeo
+            // (limites presos  tela antes da converso: projees perto do plano de recorte so enormes)
+            triangle.bounds[0] = (int)std::min(std::max(std::floor(minimum[0]) - 1, 0.0), (double)width);
+            triangle.bounds[1] = (int)std::min(std::max(std::floor(minimum[1]) - 1, 0.0), (double)height);
+            triangle.bounds[2] = (int)std::max(std::min(std::floor(maximum[0]) + 1, width - 1.0), -1.0);
+            triangle.bounds[3] = (int)std::max(std::min(std::floor(maximum[1]) + 1, height - 1.0), -1.0);
+        }
+    });
+
+    // Distribui tringulos pelos blocos cobertos (ordem dos tringulos preservada: empates determinsticos)
+    size_t tilesX = (width + tileSize - 1) / tileSize;
+    size_t tilesY = (height + tileSize - 1) / tileSize;
+    std::vector<std::vector<uint32_t> > bins(tilesX * tilesY);
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        const int * bounds = triangles[t].bounds;
+
+        if (bounds[0] > bounds[2] || bounds[1] > bounds[3])
+            continue;
+
+        for (size_t ty = bounds[1] / tileSize; ty <= bounds[3] / tileSize; ty++) {
+            for (size_t tx = bounds[0] / tileSize; tx <= bounds[2] / tileSize; tx++)
+                bins[ty * tilesX + tx].push_back((uint32_t)t);
+        }
+    }
+
+    std::atomic<size_t> next(0);
+
+    parallelFor(threads, threads, [&](size_t, size_t, size_t) {
+        std::vector<double> depths(tileSize * tileSize);
+
+        for (size_t tile = next++; tile < bins.size(); tile = next++) {
+            int x0 = (int)((tile % tilesX) * tileSize), y0 = (int)((tile / tilesX) * tileSize);
+            int x1 = std::min(x0 + (int)tileSize, (int)width) - 1, y1 = std::min(y0 + (int)tileSize, (int)height) - 1;
+
+            // Inverso da profundidade (maior  mais prximo, zero sem tringulo)
+            std::fill(depths.begin(), depths.end(), 0.0);
+
+            for (size_t b = 0; b < bins[tile].size(); b++) {
+                size_t t = bins[tile][b];
+                const RasterTriangle & triangle = triangles[t];
+                const double (&edges)[3][3] = triangle.edges;
+
+                int xMin = std::max(triangle.bounds[0], x0), xMax = std::min(triangle.bounds[2], x1);
+                int yMin = std::max(triangle.bounds[1], y0), yMax = std::min(triangle.bounds[3], y1);
+
+                for (int y = yMin; y <= yMax; y++) {
+                    for (int x = xMin; x <= xMax; x++) {
+                        size_t pixel = (size_t)y * width + x;
+                        double px = x + 0.5, py = y + 0.5;
+
+                        if (samples != nullptr) {
+                            px += samples[pixel].x;
+                            py += samples[pixel].y;
+                        }
+
+                        double e0 = edges[0][0] * px + edges[0][1] * py + edges[0][2];
+                        double e1 = edges[1][0] * px + edges[1][1] * py + edges[1][2];
+                        double e2 = edges[2][0] * px + edges[2][1] * py + edges[2][2];
+
+                        // Mesmo sinal do volume em todas as arestas: dentro do tringulo e  frente da cmera
+                        // (arestas inclusivas: pixel sobre aresta compartilhada coberto pelos dois tringulos)
+                        double sum = e0 + e1 + e2;
+                        double inverseDepth = sum * triangle.inverseVolume;
+
+                        if (e0 * triangle.inverseVolume < 0 || e1 * triangle.inverseVolume < 0 ||
+                            e2 * triangle.inverseVolume < 0 || !(inverseDepth > 0))
+                            continue;
+
+                        double & depth = depths[(y - y0) * tileSize + (x - x0)];
+
+                        if (inverseDepth <= depth)
+                            continue;
+
+                        depth = inverseDepth;
+
+                        RayHit & rayHit = rayHits[pixel];
+
+                        rayHit.index = t;
+                        rayHit.u = e1 / sum;
+                        rayHit.v = e2 / sum;
+                        rayHit.distance = inverseDepth;
+                    }
+                }
+            }
+
+            // Distncia paramtrica da direo de cmera convertida para direo normalizada
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    size_t pixel = (size_t)y * width + x;
+                    RayHit & rayHit = rayHits[pixel];
+
+                    if (!rayHit.hasHit())
+                        continue;
+
+                    double px = x + 0.5, py = y + 0.5;
+
+                    if (samples != nullptr) {
+                        px += samples[pixel].x;
+                        py += samples[pixel].y;
+                    }
+
+                    double direction[3];
+
+                    for (size_t k = 0; k < 3; k++)
+                        direction[k] = directionX[k] * px + directionY[k] * py + direction0[k];
+
+                    rayHit.distance = std::sqrt(dot(direction, direction)) / rayHit.distance;
+                }
+            }
+        }
+    });
+}
+
+AURORA_NAMESPACE_END
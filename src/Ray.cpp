@@ -0,0 +1,67 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Ray.h>
+
+AURORA_NAMESPACE_BEGIN
+
+Ray3::Ray3() : minimum(AURORA_EPSILON), maximum(AURORA_INFINITY) {}
+Ray3::Ray3(const Ray3 & ray3)
+    : origin(ray3.origin), direction(ray3.direction), inverseDirection(ray3.inverseDirection),
+    minimum(ray3.minimum), maximum(ray3.maximum) {}
+Ray3::Ray3(const Vector3 & origin, const Vector3 & direction, double minimum, double maximum)
+    : origin(origin), minimum(minimum), maximum(maximum) {
+    setDirection(direction);
+}
+Ray3::~Ray3() {}
+
+Vector3 Ray3::operator ()(double t) const {
+    return origin + direction * t;
+}
+std::ostream & operator <<(std::ostream & lhs, const Ray3 & rhs) {
+    return lhs << "Origin: " << rhs.origin << std::endl
+        << "Direction: " << rhs.direction << std::endl
+        << "Interval: [" << rhs.minimum << ", " << rhs.maximum << ']';
+}
+
+Ray3 & Ray3::setDirection(const Vector3 & direction) {
+    this->direction = direction;
+    inverseDirection = Vector3(1.0 / direction.x, 1.0 / direction.y, 1.0 / direction.z);
+
+    return *this;
+}
+
+RayHit::RayHit() : distance(AURORA_INFINITY), u(0), v(0), index(size_t(-1)), instance(size_t(-1)) {}
+RayHit::RayHit(const RayHit & rayHit)
+    : distance(rayHit.distance), u(rayHit.u), v(rayHit.v), index(rayHit.index), instance(rayHit.instance) {}
+RayHit::~RayHit() {}
+
+bool RayHit::hasHit() const {
+    return index != size_t(-1);
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,181 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/RayStream.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/Accelerator.h>
+
+#include <algorithm>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const double cellCount = 1024.0;
+
+// Intercala 10 bits de cada coordenada (cdigo de Morton de 30 bits)
+inline uint64_t expandBits(uint64_t x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x30000ff;
+    x = (x | (x << 8)) & 0x300f00f;
+    x = (x | (x << 4)) & 0x30c30c3;
+    x = (x | (x << 2)) & 0x9249249;
+
+    return x;
+}
+
+// Cdigo de Morton de ponto normalizado para [0, 1] por eixo
+inline uint64_t encodeMorton(const double * point, const double * minimum, const double * scale) {
+    uint64_t code = 0;
+
+    for (size_t k = 0; k < 3; k++) {
+        double cell = (point[k] - minimum[k]) * scale[k];
+        cell = cell < 0 ? 0 : (cell > cellCount - 1 ? cellCount - 1 : cell);
+
+        code |= expandBits((uint64_t)cell) << (2 - k);
+    }
+
+    return code;
+}
+
+}
+
+RayStream::RayStream() : sorted(true) {}
+RayStream::RayStream(const RayStream & rayStream)
+    : rays(rayStream.rays), keys(rayStream.keys), order(rayStream.order), sorted(rayStream.sorted) {}
+RayStream::~RayStream() {}
+
+size_t RayStream::add(const Ray3 & ray3) {
+    rays.push_back(ray3);
+    sorted = false;
+
+    return rays.size() - 1;
+}
+void RayStream::clear() {
+    rays.clear();
+    keys.clear();
+    order.clear();
+    sorted = true;
+}
+size_t RayStream::getRayCount() const {
+    return rays.size();
+}
+const Ray3 & RayStream::getRay(size_t i) const {
+    return rays[i];
+}
+const std::vector<size_t> & RayStream::getOrder() {
+    sort();
+
+    return order;
+}
+
+void RayStream::intersect(const BVH & bvh, RayHit * rayHits, bool * hits) {
+    sort();
+
+    for (size_t i = 0; i < order.size(); i++)
+        hits[order[i]] = bvh.intersect(rays[order[i]], rayHits[order[i]]);
+}
+void RayStream::intersect(const WideBVH & wideBVH, RayHit * rayHits, bool * hits) {
+    sort();
+
+    // Raios vizinhos na ordem coerente visitam os mesmos ns (pacotes no compensam com direes dispersas)
+    for (size_t i = 0; i < order.size(); i++)
+        hits[order[i]] = wideBVH.intersect(rays[order[i]], rayHits[order[i]]);
+}
+void RayStream::intersect(const Accelerator & accelerator, RayHit * rayHits, bool * hits) {
+    sort();
+
+    for (size_t i = 0; i < order.size(); i++)
+        hits[order[i]] = accelerator.intersect(rays[order[i]], rayHits[order[i]]);
+}
+void RayStream::occluded(const BVH & bvh, bool * results) {
+    sort();
+
+    for (size_t i = 0; i < order.size(); i++)
+        results[order[i]] = bvh.occluded(rays[order[i]]);
+}
+void RayStream::occluded(const WideBVH & wideBVH, bool * results) {
+    sort();
+
+    for (size_t i = 0; i < order.size(); i++)
+        results[order[i]] = wideBVH.occluded(rays[order[i]]);
+}
+void RayStream::occluded(const Accelerator & accelerator, bool * results) {
+    sort();
+
+    for (size_t i = 0; i < order.size(); i++)
+        results[order[i]] = accelerator.occluded(rays[order[i]]);
+}
+
+void RayStream::sort() {
+    if (sorted)
+        return;
+
+    double minimum[3], maximum[3], scale[3];
+
+    for (size_t k = 0; k < 3; k++) {
+        minimum[k] = AURORA_INFINITY;
+        maximum[k] = -AURORA_INFINITY;
+    }
+
+    for (size_t i = 0; i < rays.size(); i++) {
+        for (size_t k = 0; k < 3; k++) {
+            minimum[k] = std::min(minimum[k], rays[i].origin[k]);
+            maximum[k] = std::max(maximum[k], rays[i].origin[k]);
+        }
+    }
+
+    for (size_t k = 0; k < 3; k++)
+        scale[k] = maximum[k] > minimum[k] ? cellCount / (maximum[k] - minimum[k]) : 0;
+
+    // Direes normalizadas: componentes em [-1, 1]
+    const double directionMinimum[3] = { -1.0, -1.0, -1.0 };
+    const double directionScale[3] = { cellCount * 0.5, cellCount * 0.5, cellCount * 0.5 };
+
+    keys.resize(rays.size());
+    order.resize(rays.size());
+
+    // Chave: octante da direo (3 bits), clula da origem (30 bits) e direo (30 bits)
+    for (size_t i = 0; i < rays.size(); i++) {
+        const Ray3 & ray3 = rays[i];
+        uint64_t octant = (ray3.inverseDirection.x < 0 ? 1 : 0) | (ray3.inverseDirection.y < 0 ? 2 : 0) |
+            (ray3.inverseDirection.z < 0 ? 4 : 0);
+
+        keys[i] = octant << 60 | encodeMorton(&ray3.origin.x, minimum, scale) << 30 |
+            encodeMorton(&ray3.direction.x, directionMinimum, directionScale);
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return keys[a] < keys[b];
+    });
+
+    sorted = true;
+}
+
+AURORA_NAMESPACE_END
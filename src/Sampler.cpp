@@ -0,0 +1,345 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/Sampler.h>
+#include <aurora/Random.h>
+#include <aurora/Vector.h>
+
+#include <algorithm>
+#include <vector>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const double uint32Scale = 1.0 / 4294967296.0; // Converte inteiro de 32 bits para "[0, 1)"
+const double oneMinusEpsilon = 1.0 - 1e-16; // Maior real representvel menor que 1 (com folga)
+
+// Parmetros de Joe e Kuo ("new-joe-kuo-6.21201") das dimenses 1 a 63: polinmio primitivo
+// (com termos de maior e menor grau) e nmeros de direo iniciais "m" (um por grau)
+struct SobolParameters {
+    uint32_t polynomial;
+    uint32_t m[9];
+};
+
+const SobolParameters sobolParameters[] = {
+    { 3, { 1 } },
+    { 7, { 1, 3 } },
+    { 11, { 1, 3, 1 } },
+    { 13, { 1, 1, 1 } },
+    { 19, { 1, 1, 3, 3 } },
+    { 25, { 1, 3, 5, 13 } },
+    { 37, { 1, 1, 5, 5, 17 } },
+    { 41, { 1, 1, 5, 5, 5 } },
+    { 47, { 1, 1, 7, 11, 19 } },
+    { 55, { 1, 1, 5, 1, 1 } },
+    { 59, { 1, 1, 1, 3, 11 } },
+    { 61, { 1, 3, 5, 5, 31 } },
+    { 67, { 1, 3, 3, 9, 7, 49 } },
+    { 91, { 1, 1, 1, 15, 21, 21 } },
+    { 97, { 1, 3, 1, 13, 27, 49 } },
+    { 103, { 1, 1, 1, 15, 7, 5 } },
+    { 109, { 1, 3, 1, 15, 13, 25 } },
+    { 115, { 1, 1, 5, 5, 19, 61 } },
+    { 131, { 1, 3, 7, 11, 23, 15, 103 } },
+    { 137, { 1, 3, 7, 13, 13, 15, 69 } },
+    { 143, { 1, 1, 3, 13, 7, 35, 63 } },
+    { 145, { 1, 3, 5, 9, 1, 25, 53 } },
+    { 157, { 1, 3, 1, 13, 9, 35, 107 } },
+    { 167, { 1, 3, 1, 5, 27, 61, 31 } },
+    { 171, { 1, 1, 5, 11, 19, 41, 61 } },
+    { 185, { 1, 3, 5, 3, 3, 13, 69 } },
+    { 191, { 1, 1, 7, 13, 1, 19, 1 } },
+    { 193, { 1, 3, 7, 5, 13, 19, 59 } },
+    { 203, { 1, 1, 3, 9, 25, 29, 41 } },
+    { 211, { 1, 3, 5, 13, 23, 1, 55 } },
+    { 213, { 1, 3, 7, 3, 13, 59, 17 } },
+    { 229, { 1, 3, 1, 3, 5, 53, 69 } },
+    { 239, { 1, 1, 5, 5, 23, 33, 13 } },
+    { 241, { 1, 1, 7, 7, 1, 61, 123 } },
+    { 247, { 1, 1, 7, 9, 13, 61, 49 } },
+    { 253, { 1, 3, 3, 5, 3, 55, 33 } },
+    { 285, { 1, 3, 1, 15, 31, 13, 49, 245 } },
+    { 299, { 1, 3, 5, 15, 31, 59, 63, 97 } },
+    { 301, { 1, 3, 1, 11, 11, 11, 77, 249 } },
+    { 333, { 1, 3, 1, 11, 27, 43, 71, 9 } },
+    { 351, { 1, 1, 7, 15, 21, 11, 81, 45 } },
+    { 355, { 1, 3, 7, 3, 25, 31, 65, 79 } },
+    { 357, { 1, 3, 1, 1, 19, 11, 3, 205 } },
+    { 361, { 1, 1, 5, 9, 19, 21, 29, 157 } },
+    { 369, { 1, 3, 7, 11, 1, 33, 89, 185 } },
+    { 391, { 1, 3, 3, 3, 15, 9, 79, 71 } },
+    { 397, { 1, 3, 7, 11, 15, 39, 119, 27 } },
+    { 425, { 1, 1, 3, 1, 11, 31, 97, 225 } },
+    { 451, { 1, 1, 1, 3, 23, 43, 57, 177 } },
+    { 463, { 1, 3, 7, 7, 17, 17, 37, 71 } },
+    { 487, { 1, 3, 1, 5, 27, 63, 123, 213 } },
+    { 501, { 1, 1, 3, 5, 11, 43, 53, 133 } },
+    { 529, { 1, 3, 5, 5, 29, 17, 47, 173, 479 } },
+    { 539, { 1, 3, 3, 11, 3, 1, 109, 9, 69 } },
+    { 545, { 1, 1, 1, 5, 17, 39, 23, 5, 343 } },
+    { 557, { 1, 3, 1, 5, 25, 15, 31, 103, 499 } },
+    { 563, { 1, 1, 1, 11, 11, 17, 63, 105, 183 } },
+    { 601, { 1, 1, 5, 11, 9, 29, 97, 231, 363 } },
+    { 607, { 1, 1, 5, 15, 19, 45, 41, 7, 383 } },
+    { 617, { 1, 3, 7, 7, 31, 19, 83, 137, 221 } },
+    { 623, { 1, 1, 1, 3, 23, 15, 111, 223, 83 } },
+    { 631, { 1, 1, 5, 13, 31, 15, 55, 25, 161 } },
+    { 637, { 1, 1, 3, 13, 25, 47, 39, 87, 257 } },
+};
+
+const size_t sobolDimensions = sizeof(sobolParameters) / sizeof(SobolParameters) + 1;
+
+// Bases primas da sequncia de Halton
+const uint32_t haltonBases[] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+};
+
+const size_t haltonDimensions = sizeof(haltonBases) / sizeof(uint32_t);
+
+// Matrizes geradoras (32 colunas por dimenso) calculadas uma nica vez pela recorrncia dos nmeros de direo
+const std::vector<uint32_t> & getSobolMatrices() {
+    static const std::vector<uint32_t> matrices = [] {
+        std::vector<uint32_t> matrices(sobolDimensions * 32);
+
+        // Dimenso 0: sequncia de van der Corput (matriz identidade invertida)
+        for (size_t k = 0; k < 32; k++)
+            matrices[k] = 1u << (31 - k);
+
+        for (size_t d = 1; d < sobolDimensions; d++) {
+            const SobolParameters & parameters = sobolParameters[d - 1];
+            uint32_t * v = &matrices[d * 32];
+            uint32_t degree = 0;
+
+            while (parameters.polynomial >> (degree + 1))
+                degree++;
+
+            for (size_t k = 0; k < 32; k++) {
+                if (k < degree) {
+                    v[k] = parameters.m[k] << (31 - k);
+                    continue;
+                }
+
+                v[k] = v[k - degree] ^ (v[k - degree] >> degree);
+
+                // Coeficientes internos do polinmio (do maior para o menor grau)
+                for (size_t l = 1; l < degree; l++) {
+                    if ((parameters.polynomial >> (degree - l)) & 1)
+                        v[k] ^= v[k - l];
+                }
+            }
+        }
+
+        return matrices;
+    }();
+
+    return matrices;
+}
+
+inline uint32_t reverseBits(uint32_t x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00FF00FFu) << 8) | ((x & 0xFF00FF00u) >> 8);
+    x = ((x & 0x0F0F0F0Fu) << 4) | ((x & 0xF0F0F0F0u) >> 4);
+    x = ((x & 0x33333333u) << 2) | ((x & 0xCCCCCCCCu) >> 2);
+
+    return ((x & 0x55555555u) << 1) | ((x & 0xAAAAAAAAu) >> 1);
+}
+
+// Mistura de 32 bits (constantes "lowbias32" de C. Wellons): semente de cada n da rvore de Owen
+inline uint32_t mixBits(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+
+    return x ^ (x >> 16);
+}
+
+// Elemento "i" de permutao pseudoaleatria de "[0, count)" escolhida por "seed" (Kensler, 2013)
+uint32_t permutationElement(uint32_t i, uint32_t count, uint32_t seed) {
+    uint32_t w = count - 1;
+
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+
+    // Bijeo nos bits de "w" repetida at cair em "[0, count)"
+    do {
+        i ^= seed;
+        i *= 0xE170893Du;
+        i ^= seed >> 16;
+        i ^= (i & w) >> 4;
+        i ^= seed >> 8;
+        i *= 0x0929EB3Fu;
+        i ^= seed >> 23;
+        i ^= (i & w) >> 1;
+        i *= 1 | seed >> 27;
+        i *= 0x6935FA69u;
+        i ^= (i & w) >> 11;
+        i *= 0x74DCB303u;
+        i ^= (i & w) >> 2;
+        i *= 0x9E501CC3u;
+        i ^= (i & w) >> 2;
+        i *= 0xC860A3DFu;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= count);
+
+    // Rotao final por deslocamento em "[0, count)" (multiplicao no lugar do resto da diviso)
+    i += (uint32_t)(((uint64_t)seed * count) >> 32);
+
+    return i < count ? i : i - count;
+}
+
+}
+
+Sampler::Sampler(SamplerType type, uint32_t seed) : type(type), seed(seed), pixel(0), sampleIndex(0), dimension(0) {}
+Sampler::Sampler(const Sampler & sampler)
+    : type(sampler.type), seed(sampler.seed), pixel(sampler.pixel), sampleIndex(sampler.sampleIndex),
+    dimension(sampler.dimension) {}
+Sampler::~Sampler() {}
+
+Sampler & Sampler::setType(SamplerType type) {
+    this->type = type;
+    return *this;
+}
+SamplerType Sampler::getType() const {
+    return type;
+}
+Sampler & Sampler::setSeed(uint32_t seed) {
+    this->seed = seed;
+    return *this;
+}
+uint32_t Sampler::getSeed() const {
+    return seed;
+}
+Sampler & Sampler::setDimension(size_t dimension) {
+    this->dimension = (uint32_t)dimension;
+    return *this;
+}
+size_t Sampler::getSampleIndex() const {
+    return sampleIndex;
+}
+size_t Sampler::getDimension() const {
+    return dimension;
+}
+
+void Sampler::startPixelSample(size_t x, size_t y, size_t sampleIndex) {
+    pixel = ((uint64_t)y << 32) | (uint32_t)x;
+    this->sampleIndex = (uint32_t)sampleIndex;
+    dimension = 0;
+}
+double Sampler::get1D() {
+    uint32_t current = dimension++;
+
+    // Todos os pixels percorrem a mesma sequncia, decorrelacionados pelo embaralhamento prprio de cada
+    // pixel e dimenso (ndice da amostra independente do nmero total de amostras)
+    if (type == SamplerType::Sobol && current < sobolDimensions) {
+        uint32_t scramble = hashRandom(pixel, 0, current, seed);
+
+        return owenScramble(sobolSample(sampleIndex, current), scramble) * uint32Scale;
+    }
+
+    if (type == SamplerType::Halton && current < haltonDimensions)
+        return haltonSample(sampleIndex, current, hashRandom(pixel, 0, current, seed));
+
+    return hashUniform(pixel, sampleIndex, current, seed);
+}
+Vector2 Sampler::get2D() {
+    double x = get1D();
+
+    return Vector2(x, get1D());
+}
+
+size_t getSobolDimensionCount() {
+    return sobolDimensions;
+}
+uint32_t sobolSample(uint32_t index, uint32_t dimension) {
+    const uint32_t * matrix = &getSobolMatrices()[dimension * 32];
+    uint32_t value = 0;
+
+    for (; index != 0; index >>= 1, matrix++) {
+        if (index & 1)
+            value ^= *matrix;
+    }
+
+    return value;
+}
+size_t getHaltonDimensionCount() {
+    return haltonDimensions;
+}
+double haltonSample(uint32_t index, uint32_t dimension, uint32_t seed) {
+    uint32_t base = haltonBases[dimension];
+
+    // Base 2: inverso radical  a inverso de bits (embaralhamento de Owen direto nos bits)
+    if (base == 2)
+        return owenScramble(reverseBits((uint32_t)index), seed) * uint32Scale;
+
+    double inverseBase = 1.0 / base;
+    double inverseBaseM = 1.0;
+    uint64_t reversedDigits = 0;
+
+    // Dgitos at a resoluo de 32 bits permutados conforme posio e dgitos anteriores (n da rvore de Owen);
+    // zeros alm dos dgitos do ndice tambm permutados: estratificao exata para qualquer ndice de 32 bits
+    uint32_t position = 0;
+
+    for (; inverseBaseM >= uint32Scale; position++) {
+        uint32_t next = index / base;
+        uint32_t digit = index - next * base;
+        uint32_t nodeSeed = mixBits(seed ^ (uint32_t)reversedDigits ^ mixBits((uint32_t)(reversedDigits >> 32) + position));
+
+        digit = permutationElement(digit, base, nodeSeed);
+        reversedDigits = reversedDigits * base + digit;
+        inverseBaseM *= inverseBase;
+        index = next;
+    }
+
+    // Demais dgitos so zeros permutados de forma independente em cada n: equivalem a deslocamento uniforme
+    // dentro da clula, sorteado uma nica vez pelo n (sem estouro dos dgitos acumulados)
+    double tail = hashUniform(reversedDigits, position, dimension, seed);
+
+    return std::min((reversedDigits + tail) * inverseBaseM, oneMinusEpsilon);
+}
+uint32_t owenScramble(uint32_t value, uint32_t seed) {
+    // Permutao de Laine-Karras aprimorada (Burley, 2020) nos bits invertidos: cada bit s depende dos bits
+    // menos significativos, que aps a inverso so os mais significativos do valor
+    value = reverseBits(value);
+    value += seed;
+    value ^= value * 0x6C50B47Cu;
+    value ^= value * 0xB82F1E52u;
+    value ^= value * 0xC7AFE638u;
+    value ^= value * 0x8D22F6E6u;
+
+    return reverseBits(value);
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,180 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/ThreadPool.h>
+
+#include <algorithm>
+
+AURORA_NAMESPACE_BEGIN
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    create(threadCount);
+}
+ThreadPool::ThreadPool(const ThreadPool & threadPool) {
+    create(threadPool.threadCount);
+}
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    started.notify_all();
+
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+void ThreadPool::create(size_t threadCount) {
+    this->threadCount = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+    queues.reset(new Queue[this->threadCount]);
+    function = nullptr;
+    generation = 0;
+    running = 0;
+    stopping = false;
+    stealCount = 0;
+
+    for (size_t i = 0; i < this->threadCount; i++)
+        queues[i].begin = queues[i].end = 0;
+
+    // Thread que chama "run"  a thread 0
+    for (size_t i = 1; i < this->threadCount; i++)
+        threads.push_back(std::thread(&ThreadPool::work, this, i));
+}
+void ThreadPool::work(size_t thread) {
+    size_t current = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            started.wait(lock, [&] { return stopping || generation != current; });
+
+            if (stopping)
+                return;
+
+            current = generation;
+        }
+
+        execute(thread);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (--running == 0)
+                finished.notify_one();
+        }
+    }
+}
+void ThreadPool::execute(size_t thread) {
+    Queue & queue = queues[thread];
+
+    while (true) {
+        size_t task = 0;
+        bool found = false;
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.begin < queue.end) {
+                task = queue.begin++;
+                found = true;
+            }
+        }
+
+        if (found) {
+            (*function)(thread, task);
+            continue;
+        }
+
+        // Prpria faixa vazia: rouba metade final da faixa da prxima thread com tarefas
+        // (tarefas s mudam de faixa, nunca surgem: todas vazias encerra a execuo)
+        size_t begin = 0, end = 0;
+
+        for (size_t i = 1; i < threadCount && begin == end; i++) {
+            Queue & victim = queues[(thread + i) % threadCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            end = victim.end;
+            begin = victim.end - (victim.end - victim.begin) / 2;
+
+            // ltima tarefa restante  roubada inteira
+            if (begin == end && victim.begin < victim.end)
+                begin = victim.begin;
+
+            victim.end = begin;
+        }
+
+        if (begin == end)
+            return;
+
+        stealCount++;
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        queue.begin = begin;
+        queue.end = end;
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return threadCount;
+}
+size_t ThreadPool::getStealCount() const {
+    return stealCount;
+}
+
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t, size_t)> & function) {
+    if (taskCount == 0)
+        return;
+
+    // Faixas contguas iniciais preservam localidade (blocos vizinhos na mesma thread)
+    for (size_t i = 0; i < threadCount; i++) {
+        queues[i].begin = taskCount * i / threadCount;
+        queues[i].end = taskCount * (i + 1) / threadCount;
+    }
+
+    this->function = &function;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        running = threads.size();
+        generation++;
+    }
+
+    started.notify_all();
+    execute(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    finished.wait(lock, [&] { return running == 0; });
+    this->function = nullptr;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,471 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/UniformGrid.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <algorithm>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const uint32_t maximumResolution = 512;
+const size_t maximumReferenceRatio = 4; // Referncias por tringulo acima das quais grade aninhada  descartada
+
+// Recorta raio pela caixa da grade e retorna intervalo paramtrico de entrada e sada
+inline bool clipRay(const UniformGridLevel & level, const Ray3 & ray3, double & t0, double & t1) {
+    const double * origin = &ray3.origin.x;
+    const double * inverseDirection = &ray3.inverseDirection.x;
+
+    for (size_t k = 0; k < 3; k++) {
+        double tNear = (level.min[k] - origin[k]) * inverseDirection[k];
+        double tFar = (level.max[k] - origin[k]) * inverseDirection[k];
+
+        if (tNear > tFar)
+            std::swap(tNear, tFar);
+
+        tFar *= AURORA_SLAB_ROUNDING;
+
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+
+        if (t0 > t1)
+            return false;
+    }
+
+    return true;
+}
+
+// Intervalo de clulas [first, last] ocupado pela caixa de um tringulo
+inline void getCellRange(const UniformGridLevel & level, const double * box, int * first, int * last) {
+    for (size_t k = 0; k < 3; k++) {
+        int maximumCell = (int)level.resolution[k] - 1;
+
+        first[k] = (int)((box[k] - level.min[k]) * level.inverseCellSize[k]);
+        last[k] = (int)((box[k + 3] - level.min[k]) * level.inverseCellSize[k]);
+
+        first[k] = first[k] < 0 ? 0 : (first[k] > maximumCell ? maximumCell : first[k]);
+        last[k] = last[k] < 0 ? 0 : (last[k] > maximumCell ? maximumCell : last[k]);
+    }
+}
+
+}
+
+UniformGrid::UniformGrid()
+    : triangleMesh(nullptr), density(2.0), maximumCellSize(32), maximumDepth(2), buildTime(0) {}
+UniformGrid::UniformGrid(const UniformGrid & uniformGrid)
+    : triangleMesh(uniformGrid.triangleMesh), grids(uniformGrid.grids), cells(uniformGrid.cells),
+    indices(uniformGrid.indices), density(uniformGrid.density), maximumCellSize(uniformGrid.maximumCellSize),
+    maximumDepth(uniformGrid.maximumDepth), buildTime(uniformGrid.buildTime) {}
+UniformGrid::~UniformGrid() {}
+
+void UniformGrid::print(std::ostream & output) const {
+    output << "Accelerator: uniform grid" << std::endl
+        << "Resolution: ";
+
+    if (grids.empty())
+        output << "0 0 0";
+    else
+        output << grids[0].resolution[0] << " " << grids[0].resolution[1] << " " << grids[0].resolution[2];
+
+    output << std::endl
+        << "Grids: " << grids.size() << std::endl
+        << "Cells: " << cells.size() << std::endl
+        << "References: " << indices.size() << std::endl
+        << "Build time: " << buildTime << " ms";
+}
+
+UniformGrid & UniformGrid::setDensity(double density) {
+    this->density = density;
+    return *this;
+}
+double UniformGrid::getDensity() const {
+    return density;
+}
+UniformGrid & UniformGrid::setMaximumCellSize(size_t maximumCellSize) {
+    this->maximumCellSize = maximumCellSize;
+    return *this;
+}
+size_t UniformGrid::getMaximumCellSize() const {
+    return maximumCellSize;
+}
+size_t UniformGrid::getGridCount() const {
+    return grids.size();
+}
+size_t UniformGrid::getCellCount() const {
+    return cells.size();
+}
+size_t UniformGrid::getReferenceCount() const {
+    return indices.size();
+}
+size_t UniformGrid::getBuildTime() const {
+    return buildTime;
+}
+
+AcceleratorType UniformGrid::getType() const {
+    return AcceleratorType::UniformGrid;
+}
+size_t UniformGrid::getMemorySize() const {
+    return grids.size() * sizeof(UniformGridLevel) + cells.size() * sizeof(UniformGridCell) +
+        indices.size() * sizeof(uint32_t);
+}
+const TriangleMesh * UniformGrid::getTriangleMesh() const {
+    return triangleMesh;
+}
+
+void UniformGrid::build(const TriangleMesh * triangleMesh) {
+    size_t start = time();
+
+    this->triangleMesh = triangleMesh;
+
+    grids.clear();
+    cells.clear();
+    indices.clear();
+    buildTime = 0;
+
+    if (triangleMesh == nullptr || triangleMesh->getTriangleCount() == 0)
+        return;
+
+    size_t triangleCount = triangleMesh->getTriangleCount();
+
+    // Caixas dos tringulos (mnimo e mximo por eixo) reaproveitadas pelas grades aninhadas
+    std::vector<double> boxes(6 * triangleCount);
+    std::vector<uint32_t> triangles(triangleCount);
+    double min[3] = { AURORA_INFINITY, AURORA_INFINITY, AURORA_INFINITY };
+    double max[3] = { -AURORA_INFINITY, -AURORA_INFINITY, -AURORA_INFINITY };
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        size_t v[3];
+        triangleMesh->getVertexIndices(i, v[0], v[1], v[2]);
+
+        double * box = &boxes[6 * i];
+
+        for (size_t k = 0; k < 3; k++) {
+            box[k] = AURORA_INFINITY;
+            box[k + 3] = -AURORA_INFINITY;
+        }
+
+        for (size_t j = 0; j < 3; j++) {
+            const Vector3 & vertex = triangleMesh->getVertex(v[j]);
+
+            for (size_t k = 0; k < 3; k++) {
+                box[k] = std::min(box[k], vertex[k]);
+                box[k + 3] = std::max(box[k + 3], vertex[k]);
+            }
+        }
+
+        for (size_t k = 0; k < 3; k++) {
+            min[k] = std::min(min[k], box[k]);
+            max[k] = std::max(max[k], box[k + 3]);
+        }
+
+        triangles[i] = (uint32_t)i;
+    }
+
+    // Caixas expandidas pela margem do teste estanque de tringulos (avaliada para origens na caixa da geometria):
+    // o tringulo aceito pelo teste em preciso simples pode estar em clula vizinha s percorridas pelo raio
+    double margin = getTriangleIntersectionMargin(min, max, Vector3(min[0], min[1], min[2]));
+
+    if (margin > 0) {
+        for (size_t i = 0; i < triangleCount; i++)
+            for (size_t k = 0; k < 3; k++) {
+                boxes[6 * i + k] -= margin;
+                boxes[6 * i + k + 3] += margin;
+            }
+
+        for (size_t k = 0; k < 3; k++) {
+            min[k] -= margin;
+            max[k] += margin;
+        }
+    }
+
+    buildLevel(boxes, min, max, triangles, 0);
+
+    buildTime = time() - start;
+}
+int32_t UniformGrid::buildLevel(const std::vector<double> & boxes, const double * min, const double * max,
+    const std::vector<uint32_t> & triangles, size_t depth) {
+    int32_t index = (int32_t)grids.size();
+    UniformGridLevel level;
+
+    double extent[3], maximumExtent = 0;
+
+    for (size_t k = 0; k < 3; k++)
+        maximumExtent = std::max(maximumExtent, max[k] - min[k]);
+
+    maximumExtent = maximumExtent > 0 ? maximumExtent : 1.0;
+
+    // Margem evita clulas de tamanho nulo em geometria plana
+    for (size_t k = 0; k < 3; k++) {
+        double margin = maximumExtent * 1e-6;
+
+        level.min[k] = min[k] - margin;
+        level.max[k] = max[k] + margin;
+        extent[k] = level.max[k] - level.min[k];
+    }
+
+    // Clulas proporcionais s dimenses com "density" clulas por tringulo (eixos degenerados com uma clula)
+    double volume = 1.0, dimensions = 0;
+
+    for (size_t k = 0; k < 3; k++) {
+        if (extent[k] > maximumExtent * 1e-3) {
+            volume *= extent[k];
+            dimensions++;
+        }
+    }
+
+    double factor = std::pow(density * triangles.size() / volume, 1.0 / dimensions);
+
+    for (size_t k = 0; k < 3; k++) {
+        double resolution = extent[k] > maximumExtent * 1e-3 ? std::floor(extent[k] * factor + 0.5) : 1.0;
+
+        level.resolution[k] = (uint32_t)std::max(1.0, std::min(resolution, (double)maximumResolution));
+        level.cellSize[k] = extent[k] / level.resolution[k];
+        level.inverseCellSize[k] = 1.0 / level.cellSize[k];
+    }
+
+    size_t cellCount = (size_t)level.resolution[0] * level.resolution[1] * level.resolution[2];
+
+    level.cellOffset = (uint32_t)cells.size();
+    grids.push_back(level);
+    cells.resize(cells.size() + cellCount);
+
+    // Contagem por clula, somas de prefixo e preenchimento (ordenao por contagem)
+    std::vector<uint32_t> offsets(cellCount + 1, 0);
+    int first[3], last[3];
+
+    for (size_t i = 0; i < triangles.size(); i++) {
+        getCellRange(level, &boxes[6 * triangles[i]], first, last);
+
+        for (int z = first[2]; z <= last[2]; z++)
+            for (int y = first[1]; y <= last[1]; y++)
+                for (int x = first[0]; x <= last[0]; x++)
+                    offsets[((size_t)z * level.resolution[1] + y) * level.resolution[0] + x + 1]++;
+    }
+
+    for (size_t i = 0; i < cellCount; i++)
+        offsets[i + 1] += offsets[i];
+
+    // Grade aninhada descartada se no separa os tringulos (tringulos grandes em relao  clula)
+    if (depth > 0 && offsets[cellCount] > maximumReferenceRatio * triangles.size()) {
+        grids.pop_back();
+        cells.resize(level.cellOffset);
+
+        return -1;
+    }
+
+    std::vector<uint32_t> references(offsets[cellCount]);
+    std::vector<uint32_t> positions(offsets.begin(), offsets.end() - 1);
+
+    for (size_t i = 0; i < triangles.size(); i++) {
+        getCellRange(level, &boxes[6 * triangles[i]], first, last);
+
+        for (int z = first[2]; z <= last[2]; z++)
+            for (int y = first[1]; y <= last[1]; y++)
+                for (int x = first[0]; x <= last[0]; x++)
+                    references[positions[((size_t)z * level.resolution[1] + y) * level.resolution[0] + x]++] = triangles[i];
+    }
+
+    for (size_t i = 0; i < cellCount; i++) {
+        size_t count = offsets[i + 1] - offsets[i];
+        UniformGridCell cell;
+
+        cell.count = (uint32_t)count;
+        cell.grid = -1;
+
+        // Clulas densas (sem conter todos os tringulos da grade) recebem grade aninhada
+        if (count > maximumCellSize && depth < maximumDepth && count < triangles.size()) {
+            size_t x = i % level.resolution[0];
+            size_t y = (i / level.resolution[0]) % level.resolution[1];
+            size_t z = i / ((size_t)level.resolution[0] * level.resolution[1]);
+            size_t coordinates[3] = { x, y, z };
+            double cellMin[3], cellMax[3];
+
+            // Grade aninhada limitada  interseo da clula com as caixas dos seus tringulos
+            for (size_t k = 0; k < 3; k++) {
+                cellMin[k] = AURORA_INFINITY;
+                cellMax[k] = -AURORA_INFINITY;
+            }
+
+            for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                const double * box = &boxes[6 * references[j]];
+
+                for (size_t k = 0; k < 3; k++) {
+                    cellMin[k] = std::min(cellMin[k], box[k]);
+                    cellMax[k] = std::max(cellMax[k], box[k + 3]);
+                }
+            }
+
+            for (size_t k = 0; k < 3; k++) {
+                cellMin[k] = std::max(cellMin[k], level.min[k] + coordinates[k] * level.cellSize[k]);
+                cellMax[k] = std::min(cellMax[k], level.min[k] + (coordinates[k] + 1) * level.cellSize[k]);
+            }
+
+            std::vector<uint32_t> subset(references.begin() + offsets[i], references.begin() + offsets[i + 1]);
+
+            cell.grid = buildLevel(boxes, cellMin, cellMax, subset, depth + 1);
+        }
+
+        if (cell.grid >= 0) {
+            cell.offset = 0;
+            cell.count = 0;
+        }
+        else {
+            cell.offset = (uint32_t)indices.size();
+            indices.insert(indices.end(), references.begin() + offsets[i], references.begin() + offsets[i + 1]);
+        }
+
+        cells[level.cellOffset + i] = cell;
+    }
+
+    return index;
+}
+bool UniformGrid::traverse(size_t grid, const Ray3 & ray3, double t0, double t1, double & maximum,
+    RayHit * rayHit) const {
+    const UniformGridLevel & level = grids[grid];
+    const double * origin = &ray3.origin.x;
+    const double * direction = &ray3.direction.x;
+    const double * inverseDirection = &ray3.inverseDirection.x;
+
+    int cell[3], step[3], out[3];
+    double next[3], delta[3];
+
+    for (size_t k = 0; k < 3; k++) {
+        double point = origin[k] + direction[k] * t0;
+        int maximumCell = (int)level.resolution[k] - 1;
+
+        cell[k] = (int)((point - level.min[k]) * level.inverseCellSize[k]);
+        cell[k] = cell[k] < 0 ? 0 : (cell[k] > maximumCell ? maximumCell : cell[k]);
+
+        if (direction[k] > 0) {
+            step[k] = 1;
+            out[k] = (int)level.resolution[k];
+            next[k] = (level.min[k] + (cell[k] + 1) * level.cellSize[k] - origin[k]) * inverseDirection[k];
+            delta[k] = level.cellSize[k] * inverseDirection[k];
+        }
+        else if (direction[k] < 0) {
+            step[k] = -1;
+            out[k] = -1;
+            next[k] = (level.min[k] + cell[k] * level.cellSize[k] - origin[k]) * inverseDirection[k];
+            delta[k] = -level.cellSize[k] * inverseDirection[k];
+        }
+        else {
+            step[k] = 0;
+            out[k] = -1;
+            next[k] = AURORA_INFINITY;
+            delta[k] = 0;
+        }
+    }
+
+    const Vector3 * vertices = triangleMesh->getVertices().data();
+    const size_t * vertexIndices = triangleMesh->getVertexIndices().data();
+    bool hit = false;
+
+    while (true) {
+        size_t axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+        double exit = next[axis] < t1 ? next[axis] : t1;
+
+        const UniformGridCell & current = cells[level.cellOffset +
+            ((size_t)cell[2] * level.resolution[1] + cell[1]) * level.resolution[0] + cell[0]];
+
+        if (current.grid >= 0) {
+            double entry = t0, end = exit;
+
+            if (clipRay(grids[current.grid], ray3, entry, end) &&
+                traverse(current.grid, ray3, entry, end, maximum, rayHit)) {
+                if (rayHit == nullptr)
+                    return true;
+
+                hit = true;
+            }
+        }
+        else {
+            for (size_t i = current.offset; i < current.offset + current.count; i++) {
+                const size_t * v = &vertexIndices[3 * (size_t)indices[i]];
+                double distance, u, w;
+
+                if (intersectTriangle(ray3.origin, ray3.direction, vertices[v[0]], vertices[v[1]], vertices[v[2]],
+                    distance, u, w) && distance > ray3.minimum && distance < maximum) {
+                    if (rayHit == nullptr)
+                        return true;
+
+                    maximum = distance;
+                    hit = true;
+
+                    rayHit->distance = distance;
+                    rayHit->u = u;
+                    rayHit->v = w;
+                    rayHit->index = indices[i];
+                }
+            }
+        }
+
+        // Interseo dentro da clula atual no pode ser superada por clulas seguintes
+        if ((hit && maximum <= exit) || exit >= t1 || exit >= maximum)
+            break;
+
+        cell[axis] += step[axis];
+
+        if (cell[axis] == out[axis])
+            break;
+
+        t0 = exit;
+        next[axis] += delta[axis];
+    }
+
+    return hit;
+}
+bool UniformGrid::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (grids.empty() || triangleMesh == nullptr)
+        return false;
+
+    double t0 = ray3.minimum, t1 = ray3.maximum, maximum = ray3.maximum;
+
+    if (!clipRay(grids[0], ray3, t0, t1))
+        return false;
+
+    return traverse(0, ray3, t0, t1, maximum, &rayHit);
+}
+bool UniformGrid::occluded(const Ray3 & ray3) const {
+    if (grids.empty() || triangleMesh == nullptr)
+        return false;
+
+    double t0 = ray3.minimum, t1 = ray3.maximum, maximum = ray3.maximum;
+
+    if (!clipRay(grids[0], ray3, t0, t1))
+        return false;
+
+    return traverse(0, ray3, t0, t1, maximum, nullptr);
+}
+
+AURORA_NAMESPACE_END
@@ -31,16 +31,33 @@
 #include <aurora/Color.h>
 #include <aurora/Image.h>
 #include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
 
 #include <vector>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
 #include <chrono>
 
+// Funes de aresta do teste estanque ("x * y - y * x") avaliadas com o mesmo arredondamento
+// nos dois tringulos que compartilham a aresta
+AURORA_FP_CONTRACT_OFF
+
 AURORA_NAMESPACE_BEGIN
 
+namespace {
+
+TriangleIntersection selectedTriangleIntersection = TriangleIntersection::MollerTrumbore;
+
+// Gerador de "uniformRandom" por thread, cada um em sequncia prpria (sem estado global compartilhado)
+std::atomic<uint64_t> randomSequences(0);
+thread_local PCG32 randomGenerator(0, randomSequences++);
+
+}
+
 Image3 * readImage(const std::string & filename) {
     std::ifstream file(filename, std::ifstream::in | std::ofstream::binary);
 
@@ -277,6 +294,128 @@ Vector3 calculateNormal(
     const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2) {
     return (vertex1 - vertex0).cross(vertex2 - vertex0).normalize();
 }
+void setTriangleIntersection(TriangleIntersection triangleIntersection) {
+    selectedTriangleIntersection = triangleIntersection;
+}
+TriangleIntersection getTriangleIntersection() {
+    return selectedTriangleIntersection;
+}
+double getTriangleIntersectionMargin(const double * min, const double * max, const Vector3 & origin) {
+    if (selectedTriangleIntersection != TriangleIntersection::Watertight)
+        return 0;
+
+    const double * o = &origin.x;
+    double magnitude = 0;
+
+    for (size_t k = 0; k < 3; k++)
+        magnitude = std::max(magnitude, std::max(std::abs(min[k] - o[k]), std::abs(max[k] - o[k])));
+
+    // 2^-18: algumas unidades de arredondamento de preciso simples (translao, cisalhamento e funes de aresta)
+    return magnitude * 3.814697265625e-6;
+}
+
+bool intersectTriangle(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v) {
+    if (selectedTriangleIntersection == TriangleIntersection::Watertight)
+        return intersectTriangleWatertight(origin, direction, vertex0, vertex1, vertex2, distance, u, v);
+
+    return intersectTriangleMollerTrumbore(origin, direction, vertex0, vertex1, vertex2, distance, u, v);
+}
+bool intersectTriangleMollerTrumbore(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v) {
+    Vector3 edge0 = vertex1 - vertex0;
+    Vector3 edge1 = vertex2 - vertex0;
+
+    Vector3 p = direction.cross(edge1);
+    double d = edge0.dot(p);
+
+    if (std::abs(d) < AURORA_EPSILON)
+        return false;
+
+    double inverseD = 1.0 / d;
+    Vector3 t = origin - vertex0;
+
+    u = t.dot(p) * inverseD;
+
+    if (u < 0 || u > 1.0)
+        return false;
+
+    Vector3 q = t.cross(edge0);
+
+    v = direction.dot(q) * inverseD;
+
+    if (v < 0 || u + v > 1.0)
+        return false;
+
+    distance = edge1.dot(q) * inverseD;
+
+    return true;
+}
+bool intersectTriangleWatertight(
+    const Vector3 & origin, const Vector3 & direction,
+    const Vector3 & vertex0, const Vector3 & vertex1, const Vector3 & vertex2,
+    double & distance, double & u, double & v) {
+    const double * o = &origin.x;
+    const double * d = &direction.x;
+    const double * vertices[3] = { &vertex0.x, &vertex1.x, &vertex2.x };
+
+    // Eixo dominante da direo passa a ser "z"
+    size_t kz = std::abs(d[0]) > std::abs(d[1]) ?
+        (std::abs(d[0]) > std::abs(d[2]) ? 0 : 2) : (std::abs(d[1]) > std::abs(d[2]) ? 1 : 2);
+    size_t kx = kz == 2 ? 0 : kz + 1;
+    size_t ky = kx == 2 ? 0 : kx + 1;
+
+    float dx = (float)d[kx], dy = (float)d[ky], dz = (float)d[kz];
+
+    // Vrtices relativos  origem e cisalhados para raio na direo "z" (escalados por "dz" em vez de
+    // divididos: funes de aresta mudam por fator positivo "dz * dz"). Cada vrtice  transformado
+    // sempre da mesma forma, logo tringulos vizinhos avaliam a aresta compartilhada com os mesmos valores
+    float x[3], y[3], z[3];
+
+    for (size_t i = 0; i < 3; i++) {
+        float ax = (float)(vertices[i][kx] - o[kx]);
+        float ay = (float)(vertices[i][ky] - o[ky]);
+        float az = (float)(vertices[i][kz] - o[kz]);
+
+        x[i] = ax * dz - dx * az;
+        y[i] = ay * dz - dy * az;
+        z[i] = az;
+    }
+
+    // Funes de aresta (coordenadas baricntricas no normalizadas)
+    float e0 = x[2] * y[1] - y[2] * x[1];
+    float e1 = x[0] * y[2] - y[0] * x[2];
+    float e2 = x[1] * y[0] - y[1] * x[0];
+
+    // Raio exatamente sobre uma aresta: produtos de preciso simples so exatos em preciso dupla
+    // e a diferena arredondada preserva o sinal
+    if (e0 == 0 || e1 == 0 || e2 == 0) {
+        e0 = (float)((double)x[2] * y[1] - (double)y[2] * x[1]);
+        e1 = (float)((double)x[0] * y[2] - (double)y[0] * x[2]);
+        e2 = (float)((double)x[1] * y[0] - (double)y[1] * x[0]);
+    }
+
+    // Teste dos dois lados: interseo exige funes de aresta de mesmo sinal
+    if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0))
+        return false;
+
+    float determinant = e0 + e1 + e2;
+
+    if (determinant == 0)
+        return false;
+
+    float inverseDeterminant = 1.0f / determinant;
+
+    distance = (e0 * z[0] + e1 * z[1] + e2 * z[2]) * inverseDeterminant / dz;
+    u = e1 * inverseDeterminant;
+    v = e2 * inverseDeterminant;
+
+    return true;
+}
 
 size_t time() {
     std::chrono::system_clock::time_point time = std::chrono::system_clock::now();
@@ -296,10 +435,10 @@ void calculateTangents(
 }
 
 void randomSeed(size_t seed) {
-    std::srand(seed);
+    randomGenerator.setSeed(seed, randomGenerator.getSequence());
 }
 double uniformRandom() {
-    return std::rand() / (RAND_MAX + 1.0);
+    return randomGenerator.nextDouble();
 }
 Vector2 uniformSampleDisk(const Vector2 & sample) {
     double radius = std::sqrt(sample.x);
@@ -31,6 +31,9 @@
 
 #include <cmath>
 
+// Produtos escalar e vetorial usados pelo teste de Mller-Trumbore: mesmo resultado com ou sem FMA
+AURORA_FP_CONTRACT_OFF
+
 AURORA_NAMESPACE_BEGIN
 
 Vector2::Vector2() : x(0), y(0) {}
@@ -0,0 +1,1653 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <aurora/WideBVH.h>
+#include <aurora/BVH.h>
+#include <aurora/Math.h>
+#include <aurora/Vector.h>
+#include <aurora/Ray.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// Testes vetoriais e referncia escalar com a mesma aritmtica; arredondamento conservador das caixas preservado
+AURORA_FP_CONTRACT_OFF
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const size_t stackSize = 1024;
+const size_t packetSize = 64;
+const size_t blockSize = 4;
+const float filterMargin = 1e-3f;
+const float slabRounding = 1.0000004f;
+
+inline float roundDown(double x) {
+    float f = (float)x;
+    return f > x ? std::nextafter(f, -HUGE_VALF) : f;
+}
+
+inline float roundUp(double x) {
+    float f = (float)x;
+    return f < x ? std::nextafter(f, HUGE_VALF) : f;
+}
+
+inline float exponentToScale(int exponent) {
+    uint32_t bits = (uint32_t)(exponent + 127) << 23;
+    float scale;
+
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return scale;
+}
+
+// Seleciona at "width" descendentes da hierarquia binria que formam os filhos de um n largo
+size_t selectCandidates(const std::vector<BVHNode> & binary, size_t root, size_t * candidates, size_t width) {
+    size_t count = 0;
+
+    if (binary[root].isLeaf())
+        candidates[count++] = root;
+    else {
+        candidates[count++] = root + 1;
+        candidates[count++] = binary[root].offset;
+    }
+
+    // Substitui o candidato interno de maior rea pelos seus filhos at preencher o n
+    while (count < width) {
+        size_t best = width;
+        double bestArea = -1.0;
+
+        for (size_t i = 0; i < count; i++) {
+            const BVHNode & node = binary[candidates[i]];
+
+            if (!node.isLeaf() && node.boundingBox.getSurfaceArea() > bestArea) {
+                best = i;
+                bestArea = node.boundingBox.getSurfaceArea();
+            }
+        }
+
+        if (best == width)
+            break;
+
+        size_t node = candidates[best];
+
+        candidates[best] = node + 1;
+        candidates[count++] = binary[node].offset;
+    }
+
+    return count;
+}
+
+template <size_t N>
+unsigned int collapse(const std::vector<BVHNode> & binary, size_t root, std::vector<WideBVHNode<N> > & nodes) {
+    unsigned int current = (unsigned int)nodes.size();
+    nodes.push_back(WideBVHNode<N>());
+
+    size_t candidates[N];
+    size_t count = selectCandidates(binary, root, candidates, N);
+
+    WideBVHNode<N> wideNode;
+
+    for (size_t i = 0; i < N; i++) {
+        for (size_t k = 0; k < 3; k++) {
+            wideNode.bounds[k][i] = HUGE_VALF;
+            wideNode.bounds[k + 3][i] = -HUGE_VALF;
+        }
+
+        wideNode.children[i] = 0;
+        wideNode.counts[i] = 0;
+    }
+
+    Vector3 centers[N];
+
+    for (size_t i = 0; i < count; i++) {
+        const BVHNode & node = binary[candidates[i]];
+
+        for (size_t k = 0; k < 3; k++) {
+            wideNode.bounds[k][i] = roundDown(node.boundingBox.min[k]);
+            wideNode.bounds[k + 3][i] = roundUp(node.boundingBox.max[k]);
+        }
+
+        wideNode.children[i] = (unsigned int)node.offset;
+        wideNode.counts[i] = (unsigned int)node.count;
+
+        centers[i] = node.boundingBox.getCenter();
+    }
+
+    // Ordena filhos pela projeo do centro na direo representativa de cada octante
+    for (size_t octant = 0; octant < 8; octant++) {
+        Vector3 direction(
+            octant & 1 ? -1.0 : 1.0,
+            octant & 2 ? -1.0 : 1.0,
+            octant & 4 ? -1.0 : 1.0);
+
+        size_t order[N];
+
+        for (size_t i = 0; i < count; i++)
+            order[i] = i;
+
+        std::sort(order, order + count, [&](size_t lhs, size_t rhs) {
+            return centers[lhs].dot(direction) < centers[rhs].dot(direction);
+        });
+
+        for (size_t i = 0; i < N; i++)
+            wideNode.order[octant][i] = (unsigned char)(i < count ? order[i] : i);
+    }
+
+    wideNode.childCount = (unsigned char)count;
+
+    nodes[current] = wideNode;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!binary[candidates[i]].isLeaf()) {
+            unsigned int child = collapse<N>(binary, candidates[i], nodes);
+            nodes[current].children[i] = child;
+        }
+    }
+
+    return current;
+}
+
+// Reorganiza ndices por n (tringulos das folhas de um n contguos, grupo iniciado em novo bloco
+// quando no cabe no restante do bloco atual) e copia tringulos para blocos de preciso simples na
+// ordem dos ndices (posies excedentes zeradas, tringulo degenerado)
+template <size_t N>
+void packTriangles(const TriangleMesh * triangleMesh, const std::vector<size_t> & source,
+    std::vector<WideBVHNode<N> > & nodes, std::vector<size_t> & indices, std::vector<TriangleBlock> & triangles) {
+    std::vector<bool> padding;
+
+    indices.clear();
+
+    for (size_t n = 0; n < nodes.size(); n++) {
+        WideBVHNode<N> & node = nodes[n];
+        size_t groupSize = 0;
+
+        for (size_t i = 0; i < node.childCount; i++)
+            groupSize += node.counts[i];
+
+        if (groupSize == 0)
+            continue;
+
+        size_t lane = indices.size() % blockSize;
+
+        if (lane != 0 && lane + groupSize > blockSize) {
+            while (indices.size() % blockSize != 0) {
+                indices.push_back(indices.back());
+                padding.push_back(true);
+            }
+        }
+
+        for (size_t i = 0; i < node.childCount; i++) {
+            if (node.counts[i] == 0)
+                continue;
+
+            size_t first = node.children[i];
+            node.children[i] = (unsigned int)indices.size();
+
+            for (size_t j = first; j < first + node.counts[i]; j++) {
+                indices.push_back(source[j]);
+                padding.push_back(false);
+            }
+        }
+    }
+
+    triangles.assign((indices.size() + blockSize - 1) / blockSize, TriangleBlock());
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (padding[i])
+            continue;
+
+        TriangleBlock & block = triangles[i / blockSize];
+        size_t lane = i % blockSize;
+        size_t v0, v1, v2;
+        triangleMesh->getVertexIndices(indices[i], v0, v1, v2);
+
+        const double * vertex0 = &triangleMesh->getVertex(v0).x;
+        const double * vertex1 = &triangleMesh->getVertex(v1).x;
+        const double * vertex2 = &triangleMesh->getVertex(v2).x;
+
+        for (size_t k = 0; k < 3; k++) {
+            block.vertex[k][lane] = (float)vertex0[k];
+            block.edges[k][lane] = (float)(vertex1[k] - vertex0[k]);
+            block.edges[k + 3][lane] = (float)(vertex2[k] - vertex0[k]);
+        }
+    }
+}
+
+template <size_t N>
+inline unsigned int intersectChildren(const float (&bounds)[6][N], size_t childCount,
+    const float * nearOrigin, const float * farOrigin, const float * inverseDirection,
+    const size_t * near, const size_t * far, float minimum, float maximum) {
+    unsigned int mask = 0;
+
+    for (size_t i = 0; i < childCount; i++) {
+        float t0 = minimum, t1 = maximum;
+
+        for (size_t k = 0; k < 3; k++) {
+            float tNear = (bounds[near[k]][i] - nearOrigin[k]) * inverseDirection[k];
+            float tFar = (bounds[far[k]][i] - farOrigin[k]) * inverseDirection[k] * slabRounding;
+
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+        }
+
+        if (t0 <= t1)
+            mask |= 1 << i;
+    }
+
+    return mask;
+}
+
+#if defined(__SSE__) || defined(_M_X64)
+template <>
+inline unsigned int intersectChildren<4>(const float (&bounds)[6][4], size_t childCount,
+    const float * nearOrigin, const float * farOrigin, const float * inverseDirection,
+    const size_t * near, const size_t * far, float minimum, float maximum) {
+    __m128 t0 = _mm_set1_ps(minimum);
+    __m128 t1 = _mm_set1_ps(maximum);
+    __m128 rounding = _mm_set1_ps(slabRounding);
+
+    for (size_t k = 0; k < 3; k++) {
+        __m128 oNear = _mm_set1_ps(nearOrigin[k]);
+        __m128 oFar = _mm_set1_ps(farOrigin[k]);
+        __m128 inverse = _mm_set1_ps(inverseDirection[k]);
+
+        __m128 tNear = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bounds[near[k]]), oNear), inverse);
+        __m128 tFar = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bounds[far[k]]), oFar), inverse), rounding);
+
+        // Operandos NaN (0 * inf) preservam o intervalo atual
+        t0 = _mm_max_ps(tNear, t0);
+        t1 = _mm_min_ps(tFar, t1);
+    }
+
+    return (unsigned int)_mm_movemask_ps(_mm_cmple_ps(t0, t1)) & ((1u << childCount) - 1);
+}
+#endif
+
+#if defined(__AVX__)
+template <>
+inline unsigned int intersectChildren<8>(const float (&bounds)[6][8], size_t childCount,
+    const float * nearOrigin, const float * farOrigin, const float * inverseDirection,
+    const size_t * near, const size_t * far, float minimum, float maximum) {
+    __m256 t0 = _mm256_set1_ps(minimum);
+    __m256 t1 = _mm256_set1_ps(maximum);
+    __m256 rounding = _mm256_set1_ps(slabRounding);
+
+    for (size_t k = 0; k < 3; k++) {
+        __m256 oNear = _mm256_set1_ps(nearOrigin[k]);
+        __m256 oFar = _mm256_set1_ps(farOrigin[k]);
+        __m256 inverse = _mm256_set1_ps(inverseDirection[k]);
+
+        __m256 tNear = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(bounds[near[k]]), oNear), inverse);
+        __m256 tFar = _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(bounds[far[k]]), oFar), inverse), rounding);
+
+        t0 = _mm256_max_ps(tNear, t0);
+        t1 = _mm256_min_ps(tFar, t1);
+    }
+
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(t0, t1, _CMP_LE_OQ)) & ((1u << childCount) - 1);
+}
+#endif
+
+// Teste conservativo das caixas contra o pacote inteiro por aritmtica de intervalos: origens em
+// [originMin, originMax] e inversos das direes em [inverseMin, inverseMax] (mesmo sinal por eixo)
+template <size_t N>
+inline unsigned int intersectChildrenInterval(const float (&bounds)[6][N], size_t childCount,
+    const float * originMin, const float * originMax, const float * inverseMin, const float * inverseMax,
+    const size_t * near, const size_t * far, float minimum, float maximum) {
+    unsigned int mask = 0;
+
+    for (size_t i = 0; i < childCount; i++) {
+        float t0 = minimum, t1 = maximum;
+
+        for (size_t k = 0; k < 3; k++) {
+            // Arredondamento monotnico: extremos nos cantos dos intervalos limitam todos os raios
+            float nearLow = bounds[near[k]][i] - originMax[k], nearHigh = bounds[near[k]][i] - originMin[k];
+            float farLow = bounds[far[k]][i] - originMax[k], farHigh = bounds[far[k]][i] - originMin[k];
+
+            float tNear = std::min(std::min(nearLow * inverseMin[k], nearLow * inverseMax[k]),
+                std::min(nearHigh * inverseMin[k], nearHigh * inverseMax[k]));
+            float tFar = std::max(std::max(farLow * inverseMin[k], farLow * inverseMax[k]),
+                std::max(farHigh * inverseMin[k], farHigh * inverseMax[k])) * slabRounding;
+
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+        }
+
+        if (t0 <= t1)
+            mask |= 1 << i;
+    }
+
+    return mask;
+}
+
+// Origem de n quantizado: n da hierarquia binria ou parte de folha com mais de 255 primitivas
+struct QuantizedSource {
+    size_t node; // N binrio (em folha dividida, a folha original)
+    size_t begin, end; // Intervalo de primitivas da folha dividida (vazio em ns binrios)
+
+    QuantizedSource(size_t node, size_t begin = 0, size_t end = 0) : node(node), begin(begin), end(end) {}
+};
+
+// Ns processados em largura: filhos internos de cada n alocados em bloco contguo. Folhas com mais
+// de 255 primitivas (contador de 8 bits) so divididas em ns internos adicionais com a caixa da folha
+template <size_t N>
+void quantize(const std::vector<BVHNode> & binary, const std::vector<size_t> & binaryIndices,
+    std::vector<QuantizedBVHNode<N> > & nodes, std::vector<unsigned int> & indices) {
+    const size_t maximumCount = 255;
+
+    std::vector<QuantizedSource> sources(1, QuantizedSource(0));
+    nodes.resize(1);
+
+    for (size_t current = 0; current < nodes.size(); current++) {
+        QuantizedSource source = sources[current];
+
+        // Filhos: caixa, intervalo de primitivas (folhas) e origem (filhos internos)
+        const BoundingBox3 * boxes[N];
+        size_t begins[N], ends[N];
+        bool leaves[N];
+        std::vector<QuantizedSource> children;
+        size_t count = 0;
+
+        if (source.begin == source.end) {
+            size_t candidates[N];
+            count = selectCandidates(binary, source.node, candidates, N);
+
+            for (size_t i = 0; i < count; i++) {
+                const BVHNode & child = binary[candidates[i]];
+
+                boxes[i] = &child.boundingBox;
+                begins[i] = child.offset;
+                ends[i] = child.offset + child.count;
+                leaves[i] = child.isLeaf() && child.count <= maximumCount;
+
+                if (!leaves[i])
+                    children.push_back(child.isLeaf() ?
+                        QuantizedSource(candidates[i], begins[i], ends[i]) : QuantizedSource(candidates[i]));
+            }
+        }
+        else {
+            size_t total = source.end - source.begin;
+            size_t chunk = (total + N - 1) / N;
+
+            for (size_t begin = source.begin; begin < source.end; begin += chunk, count++) {
+                boxes[count] = &binary[source.node].boundingBox;
+                begins[count] = begin;
+                ends[count] = std::min(begin + chunk, source.end);
+                leaves[count] = ends[count] - begin <= maximumCount;
+
+                if (!leaves[count])
+                    children.push_back(QuantizedSource(source.node, begin, ends[count]));
+            }
+        }
+
+        QuantizedBVHNode<N> node;
+        float childBounds[6][N];
+        double lower[3], upper[3];
+
+        for (size_t k = 0; k < 3; k++) {
+            lower[k] = HUGE_VAL;
+            upper[k] = -HUGE_VAL;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            for (size_t k = 0; k < 3; k++) {
+                childBounds[k][i] = roundDown(boxes[i]->min[k]);
+                childBounds[k + 3][i] = roundUp(boxes[i]->max[k]);
+
+                lower[k] = std::min(lower[k], (double)childBounds[k][i]);
+                upper[k] = std::max(upper[k], (double)childBounds[k + 3][i]);
+            }
+        }
+
+        // Menor escala potncia de 2 que cobre a caixa do n em 255 passos
+        double scales[3];
+
+        for (size_t k = 0; k < 3; k++) {
+            int exponent;
+            std::frexp((upper[k] - lower[k]) / 255.0, &exponent);
+
+            exponent = std::max(std::min(exponent, 127), -126);
+
+            node.origin[k] = (float)lower[k];
+            node.exponents[k] = (signed char)exponent;
+            scales[k] = exponentToScale(exponent);
+        }
+
+        node.childCount = (unsigned char)count;
+        node.nodeBase = (unsigned int)nodes.size();
+        node.primitiveBase = (unsigned int)indices.size();
+
+        for (size_t i = 0; i < N; i++) {
+            node.counts[i] = 0;
+
+            for (size_t k = 0; k < 6; k++)
+                node.bounds[k][i] = 0;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (leaves[i]) {
+                node.counts[i] = (unsigned char)(ends[i] - begins[i]);
+
+                for (size_t j = begins[i]; j < ends[i]; j++)
+                    indices.push_back((unsigned int)binaryIndices[j]);
+            }
+
+            // Arredondamento conservador: a decodificao "origem + q * escala" em preciso simples
+            // tem um nico arredondamento (produto exato), monotnico em relao ao valor exato
+            for (size_t k = 0; k < 3; k++) {
+                double minimum = std::floor((childBounds[k][i] - lower[k]) / scales[k]);
+                double maximum = std::ceil((childBounds[k + 3][i] - lower[k]) / scales[k]);
+
+                minimum = std::max(std::min(minimum, 255.0), 0.0);
+                maximum = std::max(std::min(maximum, 255.0), 0.0);
+
+                while (minimum > 0 && lower[k] + minimum * scales[k] > childBounds[k][i])
+                    minimum--;
+                while (maximum < 255 && lower[k] + maximum * scales[k] < childBounds[k + 3][i])
+                    maximum++;
+
+                node.bounds[k][i] = (unsigned char)minimum;
+                node.bounds[k + 3][i] = (unsigned char)maximum;
+            }
+        }
+
+        sources.insert(sources.end(), children.begin(), children.end());
+        nodes.resize(nodes.size() + children.size());
+
+        nodes[current] = node;
+    }
+}
+
+template <typename Index>
+inline bool intersectLeaf(const TriangleMesh * triangleMesh, const Index * indices, size_t count,
+    const Ray3 & ray3, double & maximum, RayHit & rayHit) {
+    bool hit = false;
+
+    for (size_t j = 0; j < count; j++) {
+        size_t v0, v1, v2;
+        triangleMesh->getVertexIndices(indices[j], v0, v1, v2);
+
+        double distance, u, v;
+
+        if (intersectTriangle(ray3.origin, ray3.direction,
+            triangleMesh->getVertex(v0), triangleMesh->getVertex(v1), triangleMesh->getVertex(v2),
+            distance, u, v) && distance > ray3.minimum && distance < maximum) {
+            maximum = distance;
+            hit = true;
+
+            rayHit.distance = distance;
+            rayHit.u = u;
+            rayHit.v = v;
+            rayHit.index = indices[j];
+        }
+    }
+
+    return hit;
+}
+
+template <typename Index>
+inline bool occludedLeaf(const TriangleMesh * triangleMesh, const Index * indices, size_t count, const Ray3 & ray3) {
+    for (size_t j = 0; j < count; j++) {
+        size_t v0, v1, v2;
+        triangleMesh->getVertexIndices(indices[j], v0, v1, v2);
+
+        double distance, u, v;
+
+        if (intersectTriangle(ray3.origin, ray3.direction,
+            triangleMesh->getVertex(v0), triangleMesh->getVertex(v1), triangleMesh->getVertex(v2),
+            distance, u, v) && distance > ray3.minimum && distance < ray3.maximum)
+            return true;
+    }
+
+    return false;
+}
+
+// Raio em preciso simples para o filtro de tringulos
+struct FilterRay {
+    float origin[3];
+    float direction[3];
+    float inverseNorm; // Inverso da norma L1 da direo (converte distncias espaciais em paramtricas)
+};
+
+inline void setupFilterRay(const Ray3 & ray3, FilterRay & filterRay) {
+    const double * origin = &ray3.origin.x;
+    const double * direction = &ray3.direction.x;
+
+    for (size_t k = 0; k < 3; k++) {
+        filterRay.origin[k] = (float)origin[k];
+        filterRay.direction[k] = (float)direction[k];
+    }
+
+    filterRay.inverseNorm = (float)(1.0 / (std::abs(direction[0]) + std::abs(direction[1]) + std::abs(direction[2])));
+}
+
+// Teste de tringulo do bloco em preciso simples (Mller-Trumbore com margem nas coordenadas
+// baricntricas e na distncia): referncia escalar dos testes vetoriais (mesma aritmtica)
+inline bool testTriangle(const TriangleBlock & block, size_t lane, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float & distance, float & u, float & v) {
+    const float * origin = filterRay.origin;
+    const float * direction = filterRay.direction;
+
+    float edge0[3] = { block.edges[0][lane], block.edges[1][lane], block.edges[2][lane] };
+    float edge1[3] = { block.edges[3][lane], block.edges[4][lane], block.edges[5][lane] };
+
+    float p[3] = {
+        direction[1] * edge1[2] - direction[2] * edge1[1],
+        direction[2] * edge1[0] - direction[0] * edge1[2],
+        direction[0] * edge1[1] - direction[1] * edge1[0]
+    };
+    float d = edge0[0] * p[0] + edge0[1] * p[1] + edge0[2] * p[2];
+
+    if (d == 0)
+        return false;
+
+    float inverseD = 1.0f / d;
+    float t[3] = {
+        origin[0] - block.vertex[0][lane],
+        origin[1] - block.vertex[1][lane],
+        origin[2] - block.vertex[2][lane]
+    };
+    u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2]) * inverseD;
+
+    if (u < -margin || u > 1.0f + margin)
+        return false;
+
+    float q[3] = {
+        t[1] * edge0[2] - t[2] * edge0[1],
+        t[2] * edge0[0] - t[0] * edge0[2],
+        t[0] * edge0[1] - t[1] * edge0[0]
+    };
+    v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseD;
+
+    if (v < -margin || u + v > 1.0f + margin)
+        return false;
+
+    distance = (edge1[0] * q[0] + edge1[1] * q[1] + edge1[2] * q[2]) * inverseD;
+
+    float error = margin * (std::abs(distance) +
+        (std::abs(t[0]) + std::abs(t[1]) + std::abs(t[2])) * filterRay.inverseNorm);
+
+    return distance + error > minimum && distance - error < maximum;
+}
+
+// Testa "W" tringulos consecutivos a partir do primeiro bloco: retorna mscara dos aceitos e
+// distncias e coordenadas baricntricas por posio (especializaes vetoriais para 4, 8 e 16)
+template <size_t W>
+inline unsigned int testBlocks(const TriangleBlock * blocks, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float * distances, float * us, float * vs) {
+    unsigned int mask = 0;
+
+    for (size_t i = 0; i < W; i++) {
+        if (testTriangle(blocks[i / blockSize], i % blockSize, filterRay, margin, minimum, maximum,
+            distances[i], us[i], vs[i]))
+            mask |= 1u << i;
+    }
+
+    return mask;
+}
+
+#if defined(__SSE__) || defined(_M_X64)
+template <>
+inline unsigned int testBlocks<4>(const TriangleBlock * blocks, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float * distances, float * us, float * vs) {
+    const TriangleBlock & block = blocks[0];
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 one = _mm_set1_ps(1.0f);
+
+    __m128 dx = _mm_set1_ps(filterRay.direction[0]);
+    __m128 dy = _mm_set1_ps(filterRay.direction[1]);
+    __m128 dz = _mm_set1_ps(filterRay.direction[2]);
+
+    __m128 e0x = _mm_load_ps(block.edges[0]), e0y = _mm_load_ps(block.edges[1]), e0z = _mm_load_ps(block.edges[2]);
+    __m128 e1x = _mm_load_ps(block.edges[3]), e1y = _mm_load_ps(block.edges[4]), e1z = _mm_load_ps(block.edges[5]);
+
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e1z), _mm_mul_ps(dz, e1y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e1x), _mm_mul_ps(dx, e1z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e1y), _mm_mul_ps(dy, e1x));
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e0x, px), _mm_mul_ps(e0y, py)), _mm_mul_ps(e0z, pz));
+    __m128 inverseD = _mm_div_ps(one, d);
+
+    __m128 tx = _mm_sub_ps(_mm_set1_ps(filterRay.origin[0]), _mm_load_ps(block.vertex[0]));
+    __m128 ty = _mm_sub_ps(_mm_set1_ps(filterRay.origin[1]), _mm_load_ps(block.vertex[1]));
+    __m128 tz = _mm_sub_ps(_mm_set1_ps(filterRay.origin[2]), _mm_load_ps(block.vertex[2]));
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inverseD);
+
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e0z), _mm_mul_ps(tz, e0y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e0x), _mm_mul_ps(tx, e0z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e0y), _mm_mul_ps(ty, e0x));
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseD);
+    __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, qx), _mm_mul_ps(e1y, qy)), _mm_mul_ps(e1z, qz)), inverseD);
+
+    __m128 norm = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(sign, tx), _mm_andnot_ps(sign, ty)), _mm_andnot_ps(sign, tz));
+    __m128 error = _mm_mul_ps(_mm_set1_ps(margin),
+        _mm_add_ps(_mm_andnot_ps(sign, distance), _mm_mul_ps(norm, _mm_set1_ps(filterRay.inverseNorm))));
+
+    // Rejeies negadas (e no aceitaes) mantm o tratamento de NaN da referncia escalar
+    __m128 lower = _mm_set1_ps(-margin), upper = _mm_set1_ps(1.0f + margin);
+    __m128 reject = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(u, lower), _mm_cmpgt_ps(u, upper)),
+        _mm_or_ps(_mm_cmplt_ps(v, lower), _mm_cmpgt_ps(_mm_add_ps(u, v), upper)));
+    __m128 accept = _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(d, _mm_setzero_ps()),
+        _mm_cmpgt_ps(_mm_add_ps(distance, error), _mm_set1_ps(minimum))),
+        _mm_cmplt_ps(_mm_sub_ps(distance, error), _mm_set1_ps(maximum)));
+
+    _mm_storeu_ps(distances, distance);
+    _mm_storeu_ps(us, u);
+    _mm_storeu_ps(vs, v);
+
+    return (unsigned int)_mm_movemask_ps(_mm_andnot_ps(reject, accept));
+}
+#endif
+
+#if defined(__AVX__)
+// Componente de 2 blocos consecutivos (vrtice 0 e arestas numerados de 0 a 8)
+inline __m256 loadBlocks(const TriangleBlock * blocks, size_t component) {
+    const float * first = component < 3 ? blocks[0].vertex[component] : blocks[0].edges[component - 3];
+    const float * second = component < 3 ? blocks[1].vertex[component] : blocks[1].edges[component - 3];
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(first)), _mm_load_ps(second), 1);
+}
+
+template <>
+inline unsigned int testBlocks<8>(const TriangleBlock * blocks, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float * distances, float * us, float * vs) {
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 dx = _mm256_set1_ps(filterRay.direction[0]);
+    __m256 dy = _mm256_set1_ps(filterRay.direction[1]);
+    __m256 dz = _mm256_set1_ps(filterRay.direction[2]);
+
+    __m256 e0x = loadBlocks(blocks, 3), e0y = loadBlocks(blocks, 4), e0z = loadBlocks(blocks, 5);
+    __m256 e1x = loadBlocks(blocks, 6), e1y = loadBlocks(blocks, 7), e1z = loadBlocks(blocks, 8);
+
+    __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e1z), _mm256_mul_ps(dz, e1y));
+    __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e1x), _mm256_mul_ps(dx, e1z));
+    __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e1y), _mm256_mul_ps(dy, e1x));
+    __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e0x, px), _mm256_mul_ps(e0y, py)), _mm256_mul_ps(e0z, pz));
+    __m256 inverseD = _mm256_div_ps(one, d);
+
+    __m256 tx = _mm256_sub_ps(_mm256_set1_ps(filterRay.origin[0]), loadBlocks(blocks, 0));
+    __m256 ty = _mm256_sub_ps(_mm256_set1_ps(filterRay.origin[1]), loadBlocks(blocks, 1));
+    __m256 tz = _mm256_sub_ps(_mm256_set1_ps(filterRay.origin[2]), loadBlocks(blocks, 2));
+    __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, px), _mm256_mul_ps(ty, py)),
+        _mm256_mul_ps(tz, pz)), inverseD);
+
+    __m256 qx = _mm256_sub_ps(_mm256_mul_ps(ty, e0z), _mm256_mul_ps(tz, e0y));
+    __m256 qy = _mm256_sub_ps(_mm256_mul_ps(tz, e0x), _mm256_mul_ps(tx, e0z));
+    __m256 qz = _mm256_sub_ps(_mm256_mul_ps(tx, e0y), _mm256_mul_ps(ty, e0x));
+    __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)),
+        _mm256_mul_ps(dz, qz)), inverseD);
+    __m256 distance = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, qx), _mm256_mul_ps(e1y, qy)),
+        _mm256_mul_ps(e1z, qz)), inverseD);
+
+    __m256 norm = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(sign, tx), _mm256_andnot_ps(sign, ty)),
+        _mm256_andnot_ps(sign, tz));
+    __m256 error = _mm256_mul_ps(_mm256_set1_ps(margin),
+        _mm256_add_ps(_mm256_andnot_ps(sign, distance), _mm256_mul_ps(norm, _mm256_set1_ps(filterRay.inverseNorm))));
+
+    __m256 lower = _mm256_set1_ps(-margin), upper = _mm256_set1_ps(1.0f + margin);
+    __m256 reject = _mm256_or_ps(
+        _mm256_or_ps(_mm256_cmp_ps(u, lower, _CMP_LT_OQ), _mm256_cmp_ps(u, upper, _CMP_GT_OQ)),
+        _mm256_or_ps(_mm256_cmp_ps(v, lower, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), upper, _CMP_GT_OQ)));
+    __m256 accept = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_NEQ_UQ),
+        _mm256_cmp_ps(_mm256_add_ps(distance, error), _mm256_set1_ps(minimum), _CMP_GT_OQ)),
+        _mm256_cmp_ps(_mm256_sub_ps(distance, error), _mm256_set1_ps(maximum), _CMP_LT_OQ));
+
+    _mm256_storeu_ps(distances, distance);
+    _mm256_storeu_ps(us, u);
+    _mm256_storeu_ps(vs, v);
+
+    return (unsigned int)_mm256_movemask_ps(_mm256_andnot_ps(reject, accept));
+}
+#endif
+
+#if defined(__AVX512F__)
+// Componente de 4 blocos consecutivos (vrtice 0 e arestas numerados de 0 a 8)
+inline __m512 loadBlocks4(const TriangleBlock * blocks, size_t component) {
+    __m128 parts[4];
+
+    for (size_t i = 0; i < 4; i++)
+        parts[i] = _mm_load_ps(component < 3 ? blocks[i].vertex[component] : blocks[i].edges[component - 3]);
+
+    return _mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(
+        _mm512_castps128_ps512(parts[0]), parts[1], 1), parts[2], 2), parts[3], 3);
+}
+
+template <>
+inline unsigned int testBlocks<16>(const TriangleBlock * blocks, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float * distances, float * us, float * vs) {
+    __m512 one = _mm512_set1_ps(1.0f);
+
+    __m512 dx = _mm512_set1_ps(filterRay.direction[0]);
+    __m512 dy = _mm512_set1_ps(filterRay.direction[1]);
+    __m512 dz = _mm512_set1_ps(filterRay.direction[2]);
+
+    __m512 e0x = loadBlocks4(blocks, 3), e0y = loadBlocks4(blocks, 4), e0z = loadBlocks4(blocks, 5);
+    __m512 e1x = loadBlocks4(blocks, 6), e1y = loadBlocks4(blocks, 7), e1z = loadBlocks4(blocks, 8);
+
+    __m512 px = _mm512_sub_ps(_mm512_mul_ps(dy, e1z), _mm512_mul_ps(dz, e1y));
+    __m512 py = _mm512_sub_ps(_mm512_mul_ps(dz, e1x), _mm512_mul_ps(dx, e1z));
+    __m512 pz = _mm512_sub_ps(_mm512_mul_ps(dx, e1y), _mm512_mul_ps(dy, e1x));
+    __m512 d = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e0x, px), _mm512_mul_ps(e0y, py)), _mm512_mul_ps(e0z, pz));
+    __m512 inverseD = _mm512_div_ps(one, d);
+
+    __m512 tx = _mm512_sub_ps(_mm512_set1_ps(filterRay.origin[0]), loadBlocks4(blocks, 0));
+    __m512 ty = _mm512_sub_ps(_mm512_set1_ps(filterRay.origin[1]), loadBlocks4(blocks, 1));
+    __m512 tz = _mm512_sub_ps(_mm512_set1_ps(filterRay.origin[2]), loadBlocks4(blocks, 2));
+    __m512 u = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(tx, px), _mm512_mul_ps(ty, py)),
+        _mm512_mul_ps(tz, pz)), inverseD);
+
+    __m512 qx = _mm512_sub_ps(_mm512_mul_ps(ty, e0z), _mm512_mul_ps(tz, e0y));
+    __m512 qy = _mm512_sub_ps(_mm512_mul_ps(tz, e0x), _mm512_mul_ps(tx, e0z));
+    __m512 qz = _mm512_sub_ps(_mm512_mul_ps(tx, e0y), _mm512_mul_ps(ty, e0x));
+    __m512 v = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, qx), _mm512_mul_ps(dy, qy)),
+        _mm512_mul_ps(dz, qz)), inverseD);
+    __m512 distance = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e1x, qx), _mm512_mul_ps(e1y, qy)),
+        _mm512_mul_ps(e1z, qz)), inverseD);
+
+    __m512 norm = _mm512_add_ps(_mm512_add_ps(_mm512_abs_ps(tx), _mm512_abs_ps(ty)), _mm512_abs_ps(tz));
+    __m512 error = _mm512_mul_ps(_mm512_set1_ps(margin),
+        _mm512_add_ps(_mm512_abs_ps(distance), _mm512_mul_ps(norm, _mm512_set1_ps(filterRay.inverseNorm))));
+
+    __m512 lower = _mm512_set1_ps(-margin), upper = _mm512_set1_ps(1.0f + margin);
+    __mmask16 reject = _mm512_cmp_ps_mask(u, lower, _CMP_LT_OQ) | _mm512_cmp_ps_mask(u, upper, _CMP_GT_OQ) |
+        _mm512_cmp_ps_mask(v, lower, _CMP_LT_OQ) | _mm512_cmp_ps_mask(_mm512_add_ps(u, v), upper, _CMP_GT_OQ);
+    __mmask16 accept = _mm512_cmp_ps_mask(d, _mm512_setzero_ps(), _CMP_NEQ_UQ) &
+        _mm512_cmp_ps_mask(_mm512_add_ps(distance, error), _mm512_set1_ps(minimum), _CMP_GT_OQ) &
+        _mm512_cmp_ps_mask(_mm512_sub_ps(distance, error), _mm512_set1_ps(maximum), _CMP_LT_OQ);
+
+    _mm512_storeu_ps(distances, distance);
+    _mm512_storeu_ps(us, u);
+    _mm512_storeu_ps(vs, v);
+
+    return (unsigned int)(accept & ~reject);
+}
+#endif
+
+// Maior janela de tringulos testada por instruo sem ultrapassar os "remaining" tringulos restantes
+// (arredondados ao bloco)
+inline size_t selectWidth(size_t remaining) {
+#if defined(__AVX512F__)
+    if (remaining > 3 * blockSize)
+        return 16;
+#endif
+#if defined(__AVX__)
+    if (remaining > blockSize)
+        return 8;
+#else
+    (void)remaining;
+#endif
+    return 4;
+}
+
+inline unsigned int testBlocks(size_t width, const TriangleBlock * blocks, const FilterRay & filterRay, float margin,
+    float minimum, float maximum, float * distances, float * us, float * vs) {
+#if defined(__AVX512F__)
+    if (width == 16)
+        return testBlocks<16>(blocks, filterRay, margin, minimum, maximum, distances, us, vs);
+#endif
+#if defined(__AVX__)
+    if (width == 8)
+        return testBlocks<8>(blocks, filterRay, margin, minimum, maximum, distances, us, vs);
+#else
+    (void)width;
+#endif
+    return testBlocks<4>(blocks, filterRay, margin, minimum, maximum, distances, us, vs);
+}
+
+// Mscara das posies da janela [base, base + width) ocupadas pelas folhas selecionadas do n
+template <size_t N>
+inline unsigned int getLeafLanes(const WideBVHNode<N> & node, unsigned int leaves, size_t base, size_t width) {
+    unsigned int lanes = 0;
+
+    for (size_t i = 0; i < N; i++) {
+        if (!(leaves & (1u << i)))
+            continue;
+
+        size_t begin = std::max<size_t>(node.children[i], base);
+        size_t end = std::min<size_t>(node.children[i] + node.counts[i], base + width);
+
+        if (begin < end)
+            lanes |= ((1u << (end - begin)) - 1) << (begin - base);
+    }
+
+    return lanes;
+}
+
+// Intervalo de posies ocupado pelas folhas selecionadas do n (folhas do n so contguas)
+template <size_t N>
+inline void getLeafRange(const WideBVHNode<N> & node, unsigned int leaves, size_t & first, size_t & end) {
+    first = SIZE_MAX;
+    end = 0;
+
+    for (size_t i = 0; i < N; i++) {
+        if (leaves & (1u << i)) {
+            first = std::min<size_t>(first, node.children[i]);
+            end = std::max<size_t>(end, node.children[i] + node.counts[i]);
+        }
+    }
+}
+
+// Interseo das folhas atingidas de um n: filtro vetorial conservador em janelas de 4, 8 ou 16
+// tringulos e teste exato (vrtices da geometria) apenas nos candidatos. O teste exato mantm resultados
+// iguais aos das demais estruturas (e o modo estanque); candidatos so em mdia menos de um por raio,
+// quase sempre o tringulo atingido, cujos vrtices o sombreamento l de qualquer forma
+template <size_t N>
+inline bool intersectLeaves(const WideBVHNode<N> & node, unsigned int leaves, const TriangleMesh * triangleMesh,
+    const std::vector<TriangleBlock> & triangles, const std::vector<size_t> & indices, const Ray3 & ray3,
+    const FilterRay & filterRay, double & maximum, RayHit & rayHit) {
+    float distances[16], us[16], vs[16];
+    float minimum = roundDown(ray3.minimum);
+    size_t first, end;
+    bool hit = false;
+
+    getLeafRange(node, leaves, first, end);
+
+    for (size_t base = first - first % blockSize, width; base < end; base += width) {
+        width = selectWidth(end - base);
+
+        unsigned int mask = getLeafLanes(node, leaves, base, width) & testBlocks(width, &triangles[base / blockSize],
+            filterRay, filterMargin, minimum, roundUp(maximum), distances, us, vs);
+
+        for (size_t lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (!(mask & 1))
+                continue;
+
+            size_t v0, v1, v2;
+            triangleMesh->getVertexIndices(indices[base + lane], v0, v1, v2);
+
+            double distance, u, v;
+
+            if (intersectTriangle(ray3.origin, ray3.direction,
+                triangleMesh->getVertex(v0), triangleMesh->getVertex(v1), triangleMesh->getVertex(v2),
+                distance, u, v) && distance > ray3.minimum && distance < maximum) {
+                maximum = distance;
+                hit = true;
+
+                rayHit.distance = distance;
+                rayHit.u = u;
+                rayHit.v = v;
+                rayHit.index = indices[base + lane];
+            }
+        }
+    }
+
+    return hit;
+}
+
+template <size_t N>
+inline bool occludedLeaves(const WideBVHNode<N> & node, unsigned int leaves, const TriangleMesh * triangleMesh,
+    const std::vector<TriangleBlock> & triangles, const std::vector<size_t> & indices, const Ray3 & ray3,
+    const FilterRay & filterRay) {
+    float distances[16], us[16], vs[16];
+    float minimum = roundDown(ray3.minimum), maximum = roundUp(ray3.maximum);
+    size_t first, end;
+
+    getLeafRange(node, leaves, first, end);
+
+    for (size_t base = first - first % blockSize, width; base < end; base += width) {
+        width = selectWidth(end - base);
+
+        unsigned int mask = getLeafLanes(node, leaves, base, width) & testBlocks(width, &triangles[base / blockSize],
+            filterRay, filterMargin, minimum, maximum, distances, us, vs);
+
+        for (size_t lane = 0; mask != 0; lane++, mask >>= 1) {
+            if (!(mask & 1))
+                continue;
+
+            size_t v0, v1, v2;
+            triangleMesh->getVertexIndices(indices[base + lane], v0, v1, v2);
+
+            double distance, u, v;
+
+            if (intersectTriangle(ray3.origin, ray3.direction,
+                triangleMesh->getVertex(v0), triangleMesh->getVertex(v1), triangleMesh->getVertex(v2),
+                distance, u, v) && distance > ray3.minimum && distance < ray3.maximum)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// Origem arredondada separadamente para os planos prximo e distante das caixas: distncias calculadas
+// ficam do lado conservador (prximo antes, distante depois) e raios que passam exatamente por um
+// vrtice ou aresta no limite da caixa no so descartados
+inline void roundOrigin(double origin, bool negative, float & nearOrigin, float & farOrigin) {
+    nearOrigin = negative ? roundDown(origin) : roundUp(origin);
+    farOrigin = negative ? roundUp(origin) : roundDown(origin);
+}
+
+// Prepara raio em preciso simples para teste das caixas dos filhos
+inline void setupRay(const Ray3 & ray3, float (&nearOrigin)[3], float (&farOrigin)[3],
+    float (&inverseDirection)[3], size_t (&near)[3], size_t (&far)[3]) {
+    for (size_t k = 0; k < 3; k++) {
+        bool negative = ray3.inverseDirection[k] < 0;
+
+        roundOrigin(ray3.origin[k], negative, nearOrigin[k], farOrigin[k]);
+        inverseDirection[k] = (float)ray3.inverseDirection[k];
+        near[k] = negative ? k + 3 : k;
+        far[k] = negative ? k : k + 3;
+    }
+}
+
+template <size_t N>
+bool traverse(const std::vector<WideBVHNode<N> > & nodes, const TriangleMesh * triangleMesh,
+    const std::vector<size_t> & indices, const std::vector<TriangleBlock> & triangles, const Ray3 & ray3,
+    RayHit & rayHit) {
+    if (nodes.empty())
+        return false;
+
+    float nearOrigin[3], farOrigin[3], inverseDirection[3];
+    size_t near[3], far[3];
+    size_t octant = 0;
+    FilterRay filterRay;
+
+    setupFilterRay(ray3, filterRay);
+
+    for (size_t k = 0; k < 3; k++) {
+        bool negative = ray3.inverseDirection[k] < 0;
+
+        roundOrigin(ray3.origin[k], negative, nearOrigin[k], farOrigin[k]);
+        inverseDirection[k] = (float)ray3.inverseDirection[k];
+        near[k] = negative ? k + 3 : k;
+        far[k] = negative ? k : k + 3;
+        octant |= negative ? 1 << k : 0;
+    }
+
+    double maximum = ray3.maximum;
+    float minimum = roundDown(ray3.minimum);
+    bool hit = false;
+
+    unsigned int stack[stackSize];
+    size_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size != 0) {
+        const WideBVHNode<N> & node = nodes[stack[--size]];
+
+        unsigned int mask = intersectChildren<N>(node.bounds, node.childCount, nearOrigin, farOrigin, inverseDirection, near, far,
+            minimum, roundUp(maximum));
+
+        if (mask == 0)
+            continue;
+
+        unsigned int inner[N];
+        unsigned int leaves = 0;
+        size_t innerCount = 0;
+
+        for (size_t i = 0; i < node.childCount; i++) {
+            size_t child = node.order[octant][i];
+
+            if (!(mask & (1u << child)))
+                continue;
+
+            if (node.counts[child] == 0)
+                inner[innerCount++] = node.children[child];
+            else
+                leaves |= 1u << child;
+        }
+
+        // Folhas atingidas testadas juntas (tringulos das folhas de um n so contguos)
+        if (leaves != 0)
+            hit |= intersectLeaves(node, leaves, triangleMesh, triangles, indices, ray3, filterRay, maximum, rayHit);
+
+        // Filho mais prximo fica no topo da pilha
+        while (innerCount != 0)
+            stack[size++] = inner[--innerCount];
+    }
+
+    return hit;
+}
+
+// Busca qualquer interseo: filhos na ordem armazenada, folhas antes de descer
+template <size_t N>
+bool occlude(const std::vector<WideBVHNode<N> > & nodes, const TriangleMesh * triangleMesh,
+    const std::vector<size_t> & indices, const std::vector<TriangleBlock> & triangles, const Ray3 & ray3) {
+    if (nodes.empty())
+        return false;
+
+    float nearOrigin[3], farOrigin[3], inverseDirection[3];
+    size_t near[3], far[3];
+    FilterRay filterRay;
+
+    setupRay(ray3, nearOrigin, farOrigin, inverseDirection, near, far);
+    setupFilterRay(ray3, filterRay);
+
+    float minimum = roundDown(ray3.minimum), maximum = roundUp(ray3.maximum);
+
+    unsigned int stack[stackSize];
+    size_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size != 0) {
+        const WideBVHNode<N> & node = nodes[stack[--size]];
+
+        unsigned int mask = intersectChildren<N>(node.bounds, node.childCount, nearOrigin, farOrigin, inverseDirection, near, far,
+            minimum, maximum);
+
+        unsigned int leaves = 0;
+
+        for (size_t i = 0; i < node.childCount; i++) {
+            if (!(mask & (1u << i)))
+                continue;
+
+            if (node.counts[i] == 0)
+                stack[size++] = node.children[i];
+            else
+                leaves |= 1u << i;
+        }
+
+        if (leaves != 0 && occludedLeaves(node, leaves, triangleMesh, triangles, indices, ray3, filterRay))
+            return true;
+    }
+
+    return false;
+}
+
+// Interseo de folha com raios selecionados do pacote: vrtices e arestas carregados uma vez por
+// tringulo (mesma aritmtica de intersectTriangle)
+inline bool intersectLeafPacket(const TriangleMesh * triangleMesh, const size_t * indices, size_t count,
+    const Ray3 * ray3s, const unsigned char * rays, size_t rayCount, double * maximums, RayHit * rayHits, bool * hits) {
+    bool hit = false;
+
+    for (size_t j = 0; j < count; j++) {
+        size_t v0, v1, v2;
+        triangleMesh->getVertexIndices(indices[j], v0, v1, v2);
+
+        const double * vertex0 = &triangleMesh->getVertex(v0).x;
+        const double * vertex1 = &triangleMesh->getVertex(v1).x;
+        const double * vertex2 = &triangleMesh->getVertex(v2).x;
+
+        double edge0[3], edge1[3];
+
+        for (size_t k = 0; k < 3; k++) {
+            edge0[k] = vertex1[k] - vertex0[k];
+            edge1[k] = vertex2[k] - vertex0[k];
+        }
+
+        for (size_t i = 0; i < rayCount; i++) {
+            size_t r = rays[i];
+            const double * origin = &ray3s[r].origin.x;
+            const double * direction = &ray3s[r].direction.x;
+
+            double p[3] = {
+                direction[1] * edge1[2] - direction[2] * edge1[1],
+                direction[2] * edge1[0] - direction[0] * edge1[2],
+                direction[0] * edge1[1] - direction[1] * edge1[0]
+            };
+            double d = edge0[0] * p[0] + edge0[1] * p[1] + edge0[2] * p[2];
+
+            if (std::abs(d) < AURORA_EPSILON)
+                continue;
+
+            double inverseD = 1.0 / d;
+            double t[3] = { origin[0] - vertex0[0], origin[1] - vertex0[1], origin[2] - vertex0[2] };
+            double u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2]) * inverseD;
+
+            if (u < 0 || u > 1.0)
+                continue;
+
+            double q[3] = {
+                t[1] * edge0[2] - t[2] * edge0[1],
+                t[2] * edge0[0] - t[0] * edge0[2],
+                t[0] * edge0[1] - t[1] * edge0[0]
+            };
+            double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseD;
+
+            if (v < 0 || u + v > 1.0)
+                continue;
+
+            double distance = (edge1[0] * q[0] + edge1[1] * q[1] + edge1[2] * q[2]) * inverseD;
+
+            if (distance > ray3s[r].minimum && distance < maximums[r]) {
+                maximums[r] = distance;
+                hits[r] = true;
+                hit = true;
+
+                rayHits[r].distance = distance;
+                rayHits[r].u = u;
+                rayHits[r].v = v;
+                rayHits[r].index = indices[j];
+            }
+        }
+    }
+
+    return hit;
+}
+
+// Percorre hierarquia com pacote de raios do mesmo octante: caixas testadas primeiro contra o pacote
+// inteiro e depois raio a raio a partir do primeiro raio ativo no n (retorna falso se pacote divergente)
+template <size_t N>
+bool traversePacket(const std::vector<WideBVHNode<N> > & nodes, const TriangleMesh * triangleMesh,
+    const std::vector<size_t> & indices, const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) {
+    float nearOrigins[packetSize][3], farOrigins[packetSize][3], inverseDirections[packetSize][3];
+    float minimums[packetSize];
+    float originMin[3], originMax[3], inverseMin[3], inverseMax[3];
+    double maximums[packetSize];
+    size_t near[3], far[3];
+    size_t octant = 0;
+
+    for (size_t k = 0; k < 3; k++) {
+        bool negative = ray3s[0].inverseDirection[k] < 0;
+
+        near[k] = negative ? k + 3 : k;
+        far[k] = negative ? k : k + 3;
+        octant |= negative ? 1 << k : 0;
+
+        originMin[k] = inverseMin[k] = AURORA_INFINITY;
+        originMax[k] = inverseMax[k] = -AURORA_INFINITY;
+    }
+
+    float packetMinimum = AURORA_INFINITY, packetMaximum = 0;
+
+    for (size_t r = 0; r < count; r++) {
+        const Ray3 & ray3 = ray3s[r];
+
+        for (size_t k = 0; k < 3; k++) {
+            roundOrigin(ray3.origin[k], near[k] != k, nearOrigins[r][k], farOrigins[r][k]);
+            inverseDirections[r][k] = (float)ray3.inverseDirection[k];
+
+            // Intervalos exigem mesmo sinal e inversos finitos em todos os raios
+            if ((inverseDirections[r][k] < 0) != (near[k] != k) || std::isinf(inverseDirections[r][k]))
+                return false;
+
+            originMin[k] = std::min(originMin[k], std::min(nearOrigins[r][k], farOrigins[r][k]));
+            originMax[k] = std::max(originMax[k], std::max(nearOrigins[r][k], farOrigins[r][k]));
+            inverseMin[k] = std::min(inverseMin[k], inverseDirections[r][k]);
+            inverseMax[k] = std::max(inverseMax[k], inverseDirections[r][k]);
+        }
+
+        minimums[r] = roundDown(ray3.minimum);
+        maximums[r] = ray3.maximum;
+        hits[r] = false;
+
+        packetMinimum = std::min(packetMinimum, minimums[r]);
+        packetMaximum = std::max(packetMaximum, roundUp(maximums[r]));
+    }
+
+    if (nodes.empty())
+        return true;
+
+    unsigned int stack[stackSize];
+    unsigned char firsts[stackSize];
+    size_t size = 0;
+
+    stack[size] = 0;
+    firsts[size++] = 0;
+
+    while (size != 0) {
+        size_t first = firsts[--size];
+        const WideBVHNode<N> & node = nodes[stack[size]];
+
+        unsigned int candidates = intersectChildrenInterval<N>(node.bounds, node.childCount,
+            originMin, originMax, inverseMin, inverseMax, near, far, packetMinimum, packetMaximum);
+
+        if (candidates == 0)
+            continue;
+
+        unsigned int inner = 0;
+
+        for (size_t i = 0; i < node.childCount; i++)
+            inner |= node.counts[i] == 0 ? 1u << i : 0;
+
+        // Filhos internos recebem o primeiro raio que os atinge; folhas so testadas por todos que as atingem
+        unsigned int pending = candidates & inner, leaves = candidates & ~inner;
+        unsigned int masks[packetSize];
+        unsigned char childFirsts[N];
+        size_t last = first;
+
+        for (; last < count && (pending != 0 || leaves != 0); last++) {
+            masks[last] = intersectChildren<N>(node.bounds, node.childCount, nearOrigins[last],
+                farOrigins[last], inverseDirections[last], near, far, minimums[last], roundUp(maximums[last])) & candidates;
+
+            for (unsigned int found = masks[last] & pending; found != 0; found &= found - 1)
+                childFirsts[__builtin_ctz(found)] = (unsigned char)last;
+
+            pending &= ~masks[last];
+        }
+
+        bool updated = false;
+
+        // Folhas na ordem do octante (mesma ordem de teste da travessia individual)
+        for (size_t i = 0; i < node.childCount && leaves != 0; i++) {
+            size_t child = node.order[octant][i];
+
+            if (!(leaves & (1u << child)))
+                continue;
+
+            unsigned char rays[packetSize];
+            size_t rayCount = 0;
+
+            for (size_t r = first; r < last; r++) {
+                if (masks[r] & (1u << child))
+                    rays[rayCount++] = (unsigned char)r;
+            }
+
+            updated |= intersectLeafPacket(triangleMesh, &indices[node.children[child]], node.counts[child],
+                ray3s, rays, rayCount, maximums, rayHits, hits);
+        }
+
+        if (updated) {
+            packetMaximum = 0;
+
+            // Todos os raios: ns na pilha podem ter primeiro raio ativo anterior
+            for (size_t r = 0; r < count; r++)
+                packetMaximum = std::max(packetMaximum, roundUp(maximums[r]));
+        }
+
+        // Filhos atingidos por algum raio, o mais prximo no topo da pilha
+        unsigned int visited = candidates & inner & ~pending;
+
+        for (size_t i = node.childCount; i-- > 0;) {
+            size_t child = node.order[octant][i];
+
+            if (visited & (1u << child)) {
+                stack[size] = node.children[child];
+                firsts[size++] = childFirsts[child];
+            }
+        }
+    }
+
+    return true;
+}
+
+template <size_t N>
+bool traverse(const std::vector<QuantizedBVHNode<N> > & nodes, const TriangleMesh * triangleMesh,
+    const std::vector<unsigned int> & indices, const Ray3 & ray3, RayHit & rayHit) {
+    if (nodes.empty())
+        return false;
+
+    float nearOrigin[3], farOrigin[3], inverseDirection[3];
+    size_t near[3], far[3];
+    size_t axis = 0;
+
+    for (size_t k = 0; k < 3; k++) {
+        bool negative = ray3.inverseDirection[k] < 0;
+
+        roundOrigin(ray3.origin[k], negative, nearOrigin[k], farOrigin[k]);
+        inverseDirection[k] = (float)ray3.inverseDirection[k];
+        near[k] = negative ? k + 3 : k;
+        far[k] = negative ? k : k + 3;
+
+        if (std::abs(ray3.direction[k]) > std::abs(ray3.direction[axis]))
+            axis = k;
+    }
+
+    double maximum = ray3.maximum;
+    float minimum = roundDown(ray3.minimum);
+    bool hit = false;
+
+    unsigned int stack[stackSize];
+    size_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size != 0) {
+        const QuantizedBVHNode<N> & node = nodes[stack[--size]];
+
+        float bounds[6][N];
+
+        for (size_t k = 0; k < 3; k++) {
+            float scale = exponentToScale(node.exponents[k]);
+
+            for (size_t i = 0; i < N; i++) {
+                bounds[k][i] = node.origin[k] + node.bounds[k][i] * scale;
+                bounds[k + 3][i] = node.origin[k] + node.bounds[k + 3][i] * scale;
+            }
+        }
+
+        unsigned int mask = intersectChildren<N>(bounds, node.childCount, nearOrigin, farOrigin, inverseDirection, near, far,
+            minimum, roundUp(maximum));
+
+        if (mask == 0)
+            continue;
+
+        unsigned int inner[N];
+        float keys[N];
+        size_t innerCount = 0;
+        unsigned int child = node.nodeBase, primitive = node.primitiveBase;
+
+        for (size_t i = 0; i < node.childCount; i++) {
+            if (node.counts[i] == 0) {
+                // Ordena filhos internos pelo plano prximo no eixo dominante do raio (insero)
+                if (mask & (1u << i)) {
+                    float key = bounds[near[axis]][i] * (near[axis] == axis ? 1.0f : -1.0f);
+                    size_t j = innerCount++;
+
+                    for (; j > 0 && keys[j - 1] > key; j--) {
+                        inner[j] = inner[j - 1];
+                        keys[j] = keys[j - 1];
+                    }
+
+                    inner[j] = child;
+                    keys[j] = key;
+                }
+
+                child++;
+                continue;
+            }
+
+            if (mask & (1u << i))
+                hit |= intersectLeaf(triangleMesh, &indices[primitive], node.counts[i], ray3, maximum, rayHit);
+
+            primitive += node.counts[i];
+        }
+
+        // Filho mais prximo fica no topo da pilha
+        while (innerCount != 0)
+            stack[size++] = inner[--innerCount];
+    }
+
+    return hit;
+}
+
+template <size_t N>
+bool occlude(const std::vector<QuantizedBVHNode<N> > & nodes, const TriangleMesh * triangleMesh,
+    const std::vector<unsigned int> & indices, const Ray3 & ray3) {
+    if (nodes.empty())
+        return false;
+
+    float nearOrigin[3], farOrigin[3], inverseDirection[3];
+    size_t near[3], far[3];
+
+    setupRay(ray3, nearOrigin, farOrigin, inverseDirection, near, far);
+
+    float minimum = roundDown(ray3.minimum), maximum = roundUp(ray3.maximum);
+
+    unsigned int stack[stackSize];
+    size_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size != 0) {
+        const QuantizedBVHNode<N> & node = nodes[stack[--size]];
+
+        float bounds[6][N];
+
+        for (size_t k = 0; k < 3; k++) {
+            float scale = exponentToScale(node.exponents[k]);
+
+            for (size_t i = 0; i < N; i++) {
+                bounds[k][i] = node.origin[k] + node.bounds[k][i] * scale;
+                bounds[k + 3][i] = node.origin[k] + node.bounds[k + 3][i] * scale;
+            }
+        }
+
+        unsigned int mask = intersectChildren<N>(bounds, node.childCount, nearOrigin, farOrigin, inverseDirection, near, far,
+            minimum, maximum);
+
+        unsigned int child = node.nodeBase, primitive = node.primitiveBase;
+
+        for (size_t i = 0; i < node.childCount; i++) {
+            if (node.counts[i] == 0) {
+                if (mask & (1u << i))
+                    stack[size++] = child;
+
+                child++;
+                continue;
+            }
+
+            if ((mask & (1u << i)) && occludedLeaf(triangleMesh, &indices[primitive], node.counts[i], ray3))
+                return true;
+
+            primitive += node.counts[i];
+        }
+    }
+
+    return false;
+}
+
+}
+
+WideBVH::WideBVH() : triangleMesh(nullptr), width(4) {}
+WideBVH::WideBVH(const WideBVH & wideBVH)
+    : triangleMesh(wideBVH.triangleMesh), indices(wideBVH.indices), triangles(wideBVH.triangles),
+    nodes4(wideBVH.nodes4), nodes8(wideBVH.nodes8), width(wideBVH.width) {}
+WideBVH::WideBVH(const BVH & bvh, size_t width) : triangleMesh(nullptr), width(width) {
+    build(bvh, width);
+}
+WideBVH::~WideBVH() {}
+
+size_t getTriangleBlockWidth() {
+    return selectWidth(SIZE_MAX);
+}
+
+int intersectTriangleBlocks(const TriangleBlock * blocks, size_t count, const Ray3 & ray3,
+    float & distance, float & u, float & v) {
+    float distances[16], us[16], vs[16];
+    float minimum = (float)ray3.minimum, maximum = (float)ray3.maximum;
+    FilterRay filterRay;
+    int closest = -1;
+
+    setupFilterRay(ray3, filterRay);
+
+    for (size_t base = 0, width; base < count; base += width) {
+        width = selectWidth(count - base);
+
+        unsigned int mask = testBlocks(width, blocks + base / blockSize, filterRay, 0.0f, minimum, maximum,
+            distances, us, vs);
+
+        if (count - base < width)
+            mask &= (1u << (count - base)) - 1;
+
+        for (size_t lane = 0; mask != 0; lane++, mask >>= 1) {
+            if ((mask & 1) && distances[lane] < maximum) {
+                maximum = distances[lane];
+                closest = (int)(base + lane);
+
+                distance = distances[lane];
+                u = us[lane];
+                v = vs[lane];
+            }
+        }
+    }
+
+    return closest;
+}
+int intersectTriangleBlocksReference(const TriangleBlock * blocks, size_t count, const Ray3 & ray3,
+    float & distance, float & u, float & v) {
+    float minimum = (float)ray3.minimum, maximum = (float)ray3.maximum;
+    FilterRay filterRay;
+    int closest = -1;
+
+    setupFilterRay(ray3, filterRay);
+
+    for (size_t i = 0; i < count; i++) {
+        float triangleDistance, triangleU, triangleV;
+
+        if (testTriangle(blocks[i / blockSize], i % blockSize, filterRay, 0.0f, minimum, maximum,
+            triangleDistance, triangleU, triangleV) && triangleDistance < maximum) {
+            maximum = triangleDistance;
+            closest = (int)i;
+
+            distance = triangleDistance;
+            u = triangleU;
+            v = triangleV;
+        }
+    }
+
+    return closest;
+}
+
+std::ostream & operator <<(std::ostream & lhs, const WideBVH & rhs) {
+    return lhs << "Width: " << rhs.width << std::endl
+        << "Nodes: " << rhs.getNodeCount() << std::endl
+        << "Memory: " << rhs.getMemorySize() << " bytes";
+}
+
+size_t WideBVH::getWidth() const {
+    return width;
+}
+size_t WideBVH::getNodeCount() const {
+    return width == 8 ? nodes8.size() : nodes4.size();
+}
+size_t WideBVH::getMemorySize() const {
+    return (width == 8 ? nodes8.size() * sizeof(WideBVHNode<8>) : nodes4.size() * sizeof(WideBVHNode<4>))
+        + indices.size() * sizeof(size_t) + triangles.size() * sizeof(TriangleBlock);
+}
+const TriangleMesh * WideBVH::getTriangleMesh() const {
+    return triangleMesh;
+}
+
+WideBVH & WideBVH::build(const BVH & bvh, size_t width) {
+    this->width = width == 8 ? 8 : 4;
+
+    triangleMesh = bvh.getTriangleMesh();
+    indices.clear();
+
+    nodes4.clear();
+    nodes8.clear();
+    triangles.clear();
+
+    if (bvh.getNodeCount() == 0)
+        return *this;
+
+    if (this->width == 8) {
+        collapse<8>(bvh.getNodes(), 0, nodes8);
+        packTriangles<8>(triangleMesh, bvh.getIndices(), nodes8, indices, triangles);
+    }
+    else {
+        collapse<4>(bvh.getNodes(), 0, nodes4);
+        packTriangles<4>(triangleMesh, bvh.getIndices(), nodes4, indices, triangles);
+    }
+
+    return *this;
+}
+bool WideBVH::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (width == 8)
+        return traverse<8>(nodes8, triangleMesh, indices, triangles, ray3, rayHit);
+
+    return traverse<4>(nodes4, triangleMesh, indices, triangles, ray3, rayHit);
+}
+bool WideBVH::occluded(const Ray3 & ray3) const {
+    if (width == 8)
+        return occlude<8>(nodes8, triangleMesh, indices, triangles, ray3);
+
+    return occlude<4>(nodes4, triangleMesh, indices, triangles, ray3);
+}
+void WideBVH::intersect(const Ray3 * ray3s, size_t count, RayHit * rayHits, bool * hits) const {
+    // Interseo de folha do pacote  Mller-Trumbore: demais mtodos seguem raio a raio
+    if (getTriangleIntersection() != TriangleIntersection::MollerTrumbore) {
+        for (size_t r = 0; r < count; r++)
+            hits[r] = intersect(ray3s[r], rayHits[r]);
+
+        return;
+    }
+
+    for (size_t begin = 0; begin < count; begin += packetSize) {
+        size_t size = std::min(packetSize, count - begin);
+
+        bool traced = width == 8 ?
+            traversePacket<8>(nodes8, triangleMesh, indices, ray3s + begin, size, rayHits + begin, hits + begin) :
+            traversePacket<4>(nodes4, triangleMesh, indices, ray3s + begin, size, rayHits + begin, hits + begin);
+
+        if (!traced) {
+            for (size_t r = begin; r < begin + size; r++)
+                hits[r] = intersect(ray3s[r], rayHits[r]);
+        }
+    }
+}
+
+QuantizedBVH::QuantizedBVH() : triangleMesh(nullptr), width(8) {}
+QuantizedBVH::QuantizedBVH(const QuantizedBVH & quantizedBVH)
+    : triangleMesh(quantizedBVH.triangleMesh), indices(quantizedBVH.indices),
+    nodes4(quantizedBVH.nodes4), nodes8(quantizedBVH.nodes8), width(quantizedBVH.width) {}
+QuantizedBVH::QuantizedBVH(const BVH & bvh, size_t width) : triangleMesh(nullptr), width(width) {
+    build(bvh, width);
+}
+QuantizedBVH::~QuantizedBVH() {}
+
+std::ostream & operator <<(std::ostream & lhs, const QuantizedBVH & rhs) {
+    return lhs << "Width: " << rhs.width << std::endl
+        << "Nodes: " << rhs.getNodeCount() << std::endl
+        << "Memory: " << rhs.getMemorySize() << " bytes";
+}
+
+size_t QuantizedBVH::getWidth() const {
+    return width;
+}
+size_t QuantizedBVH::getNodeCount() const {
+    return width == 8 ? nodes8.size() : nodes4.size();
+}
+size_t QuantizedBVH::getMemorySize() const {
+    return (width == 8 ? nodes8.size() * sizeof(QuantizedBVHNode<8>) : nodes4.size() * sizeof(QuantizedBVHNode<4>))
+        + indices.size() * sizeof(unsigned int);
+}
+const TriangleMesh * QuantizedBVH::getTriangleMesh() const {
+    return triangleMesh;
+}
+
+QuantizedBVH & QuantizedBVH::build(const BVH & bvh, size_t width) {
+    this->width = width == 4 ? 4 : 8;
+
+    triangleMesh = bvh.getTriangleMesh();
+
+    indices.clear();
+    nodes4.clear();
+    nodes8.clear();
+
+    if (bvh.getNodeCount() == 0)
+        return *this;
+
+    if (this->width == 8)
+        quantize<8>(bvh.getNodes(), bvh.getIndices(), nodes8, indices);
+    else
+        quantize<4>(bvh.getNodes(), bvh.getIndices(), nodes4, indices);
+
+    return *this;
+}
+bool QuantizedBVH::intersect(const Ray3 & ray3, RayHit & rayHit) const {
+    if (width == 8)
+        return traverse<8>(nodes8, triangleMesh, indices, ray3, rayHit);
+
+    return traverse<4>(nodes4, triangleMesh, indices, ray3, rayHit);
+}
+bool QuantizedBVH::occluded(const Ray3 & ray3) const {
+    if (width == 8)
+        return occlude<8>(nodes8, triangleMesh, indices, ray3);
+
+    return occlude<4>(nodes4, triangleMesh, indices, ray3);
+}
+
+AURORA_NAMESPACE_END
@@ -4,7 +4,21 @@
 #include <aurora/Image.h>
 #include <aurora/Matrix.h>
 #include <aurora/Utility.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Ray.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/Accelerator.h>
+#include <aurora/RayStream.h>
+#include <aurora/Rasterizer.h>
+#include <aurora/ThreadPool.h>
+#include <aurora/Sampler.h>
+#include <aurora/AccumulationBuffer.h>
+#include <atomic>
 #include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include <iostream>
@@ -12,13 +26,6 @@
 using namespace aurora;
 using namespace std;
 
-float uniformRandom1D() {
-    return uniformRandom();
-}
-Vector2 uniformRandom2D() {
-    return Vector2(uniformRandom1D(), uniformRandom1D());
-}
-
 struct intersection 
 {
 	bool hit;
@@ -79,23 +86,6 @@ struct BSDF
 	}	
 };
 
-struct Vertex
-{
-	Vector3 position;
-	Vector3 normal;
-	Vector2 uv;
-	
-	Vertex() {}
-	
-	Vertex(Vector3 position, Vector3 normal, Vector2 uv)
-	{
-		this->position = position;
-		this->normal = normal;
-		this->uv = uv;
-	}
-};
-
-
 struct shaderGlobals
 {
 	Vector3 point;
@@ -125,25 +115,30 @@ struct shaderGlobals
 };
 
 
+// Referncia a um tringulo de uma geometria da cena (atributos lidos dos vetores compartilhados da geometria)
 struct Triangle
 {
+	const TriangleMesh * mesh;
 	BSDF * bsdf;
-	Vertex vertices [3];
+	size_t index;
 	
 	Triangle() {}
 	
-	Triangle(BSDF *  bsdf, Vertex *vertices) {
+	Triangle(const TriangleMesh * mesh, BSDF * bsdf, size_t index) {
+		this->mesh = mesh;
 		this->bsdf = bsdf;
-		this->vertices[0] = vertices[0];
-		this->vertices[1] = vertices[1];
-		this->vertices[2] = vertices[2];
+		this->index = index;
+	}
+	
+	const Vector3 & position(size_t i) const {
+		return mesh->getVertex(mesh->getVertexIndices()[3 * index + i]);
 	}
 	
 	bool intersects(
     	const ray & Ray, intersection & Intersection) const {
-        const Vector3 & v0 = vertices[0].position;
-        const Vector3 & v1 = vertices[1].position;
-        const Vector3 & v2 = vertices[2].position;
+        const Vector3 & v0 = position(0);
+        const Vector3 & v1 = position(1);
+        const Vector3 & v2 = position(2);
         
         Vector3 u = v1 - v0;
         Vector3 v = v2 - v0;
@@ -180,16 +175,31 @@ struct Triangle
         return true;
     }
 	
-	shaderGlobals calculateShaderGlobals(intersection Intersection ,ray Ray)
+	shaderGlobals calculateShaderGlobals(intersection Intersection ,ray Ray) const
 	{
 		shaderGlobals sg;
 		
 		sg.point = Ray.point(Intersection.distance);
 		
-		Vector3 b = barycentric(sg.point, vertices[0].position, vertices[1].position, vertices[2].position);
+		Vector3 b = barycentric(sg.point, position(0), position(1), position(2));
+        
+        // Sem vetores normais na geometria: normal do plano do tringulo
+        if (mesh->hasNormals()) {
+            size_t n0, n1, n2;
+            
+            mesh->getNormalIndices(index, n0, n1, n2);
+            sg.normal = (mesh->getNormal(n0) * b.x + mesh->getNormal(n1) * b.y + mesh->getNormal(n2) * b.z).normalize();
+        }
+        else
+            sg.normal = (position(1) - position(0)).cross(position(2) - position(0)).normalize();
         
-        sg.normal = (vertices[0].normal * b.x + vertices[1].normal * b.y + vertices[2].normal * b.z).normalize();
-        sg.uv = vertices[0].uv * b.x + vertices[1].uv * b.y + vertices[2].uv * b.z;
+        if (mesh->hasTextureCoordinates()) {
+            size_t t0, t1, t2;
+            
+            mesh->getTextureIndices(index, t0, t1, t2);
+            sg.uv = mesh->getTextureCoordinates(t0) * b.x + mesh->getTextureCoordinates(t1) * b.y +
+                mesh->getTextureCoordinates(t2) * b.z;
+        }
         
         sg.uv = Vector2(b.x, b.y);
         
@@ -201,10 +211,10 @@ struct Triangle
 		return sg;
 	}
 	
-	virtual Vector3 uniformSample(const Vector2 & sample) const {
-        const Vector3 & v0 = vertices[0].position;
-        const Vector3 & v1 = vertices[1].position;
-        const Vector3 & v2 = vertices[2].position;
+	Vector3 uniformSample(const Vector2 & sample) const {
+        const Vector3 & v0 = position(0);
+        const Vector3 & v1 = position(1);
+        const Vector3 & v2 = position(2);
         
         Vector3 b = uniformSampleTriangle(sample);
         
@@ -218,31 +228,122 @@ struct Triangle
 		
 };
 
+// Cena: geometrias compartilhadas com um material cada; tringulos numerados em sequncia pelas geometrias
+// (sem cpia por tringulo: "getTriangle" monta a referncia a partir do ndice global)
 struct Scene {
-    std::vector<Triangle*> triangles;
-    std::vector<Triangle *> lightGroup;
+    std::vector<std::shared_ptr<TriangleMesh> > meshes;
+    std::vector<BSDF *> bsdfs; // Material de cada geometria
+    std::vector<size_t> triangleOffsets; // ndice global do primeiro tringulo de cada geometria
+    std::vector<Triangle> lightGroup;
+    std::shared_ptr<TriangleMesh> mesh; // Geometria da estrutura de acelerao (a prpria geometria se nica)
+    std::shared_ptr<Accelerator> accelerator;
     
     Scene() {}
-    Scene(const std::vector<Triangle *> & triangles) {
-        this->triangles = triangles;
+    
+    // Adiciona geometria com seu material e retorna o ndice da geometria
+    size_t addMesh(const std::shared_ptr<TriangleMesh> & triangleMesh, BSDF * bsdf) {
+        triangleOffsets.push_back(getTriangleCount());
+        meshes.push_back(triangleMesh);
+        bsdfs.push_back(bsdf);
+        
+        return meshes.size() - 1;
     }
     
-    bool intersects(ray Ray, intersection & Intersection) const {
-        for (int i = 0; i < triangles.size(); i++) {
-            Triangle * triangle = triangles[i];
-            
-            intersection temp;
-            triangle->intersects(Ray,temp);
+    // Adiciona tringulo de uma geometria ao grupo de luzes
+    void addLight(size_t meshIndex, size_t triangleIndex) {
+        lightGroup.push_back(Triangle(meshes[meshIndex].get(), bsdfs[meshIndex], triangleIndex));
+    }
+    
+    size_t getTriangleCount() const {
+        return meshes.empty() ? 0 : triangleOffsets.back() + meshes.back()->getTriangleCount();
+    }
+    
+    // Referncia ao tringulo de ndice global (ndices das intersees)
+    Triangle getTriangle(size_t index) const {
+        size_t i = std::upper_bound(triangleOffsets.begin(), triangleOffsets.end(), index) - triangleOffsets.begin() - 1;
+        
+        return Triangle(meshes[i].get(), bsdfs[i], index - triangleOffsets[i]);
+    }
+    
+    // Geometria nica usada diretamente; vrias tm apenas posies e ndices reunidos na ordem global
+    // (hierarquia binria carregada de "cacheFilename" ou escrita nele, se indicado)
+    void build(AcceleratorType acceleratorType, BVHBuildMethod buildMethod, size_t bvhWidth,
+        BVHLayout layout = BVHLayout::DepthFirst, bool trianglePacking = false,
+        const std::string & cacheFilename = std::string()) {
+        if (meshes.size() == 1)
+            mesh = meshes[0];
+        else {
+            std::vector<Vector3> vertices;
+            std::vector<size_t> vertexIndices;
             
-            if (temp.hit && temp.distance < Intersection.distance) {
-                Intersection.hit = temp.hit;
-                Intersection.distance = temp.distance;
-                Intersection.index = i;
+            for (size_t i = 0; i < meshes.size(); i++) {
+                const std::vector<size_t> & indices = meshes[i]->getVertexIndices();
+                size_t offset = vertices.size();
+                
+                vertices.insert(vertices.end(), meshes[i]->getVertices().begin(), meshes[i]->getVertices().end());
+                
+                for (size_t j = 0; j < indices.size(); j++)
+                    vertexIndices.push_back(offset + indices[j]);
             }
+            
+            mesh = std::make_shared<TriangleMesh>(vertices, vertexIndices);
+        }
+        
+        accelerator = createAccelerator(mesh.get(), acceleratorType, buildMethod, bvhWidth, cacheFilename);
+        
+        // Ordem dos ns e cpia de vrtices aplicadas sobre a hierarquia construda
+        std::shared_ptr<BVHAccelerator> bvhAccelerator = std::dynamic_pointer_cast<BVHAccelerator>(accelerator);
+        
+        if (bvhAccelerator && (layout != BVHLayout::DepthFirst || trianglePacking))
+            bvhAccelerator->reorder(layout, trianglePacking);
+    }
+    
+    bool intersects(ray Ray, intersection & Intersection) const {
+        Ray3 query(Ray.origin, Ray.direction, AURORA_EPSILON, Intersection.distance);
+        RayHit hit;
+        
+        if (accelerator->intersect(query, hit)) {
+            Intersection.hit = true;
+            Intersection.distance = hit.distance;
+            Intersection.index = hit.index;
         }
         
         return Intersection.hit;
     }
+    
+    // Pacote de raios coerentes (hierarquia larga); demais estruturas seguem raio a raio
+    void intersects(const ray * rays, intersection * intersections, size_t count) const {
+        std::vector<Ray3> queries;
+        std::vector<RayHit> hits(count);
+        std::unique_ptr<bool[]> found(new bool[count]);
+        
+        queries.reserve(count);
+        
+        for (size_t i = 0; i < count; i++)
+            queries.push_back(Ray3(rays[i].origin, rays[i].direction, AURORA_EPSILON, intersections[i].distance));
+        
+        accelerator->intersect(queries.data(), count, hits.data(), found.get());
+        
+        for (size_t i = 0; i < count; i++) {
+            if (found[i]) {
+                intersections[i].hit = true;
+                intersections[i].distance = hits[i].distance;
+                intersections[i].index = hits[i].index;
+            }
+        }
+    }
+    
+    // Raio de sombra: qualquer interseo antes de "maximum" (sem dados de sombreamento)
+    bool occluded(ray Ray, double maximum) const {
+        Ray3 query(Ray.origin, Ray.direction, AURORA_EPSILON, maximum);
+        
+        return accelerator->occluded(query);
+    }
+    
+    // Raios de sombra acumulados, traados em ordem coerente (resultados na ordem de insero)
+    void occluded(RayStream & stream, bool * results) const {
+        stream.occluded(*accelerator, results);
+    }
 };
 
 struct film 
@@ -307,8 +408,11 @@ struct camera
 		worldMatrix[3][3]= 1;
 	}
 	
-	ray generateRay (float x,float y, Vector2 sample)
+	// Raio pelo pixel com deslocamento nas duas primeiras dimenses da amostra
+	ray generateRay (float x,float y, Sampler & sampler)
 	{
+		Vector2 sample = sampler.get2D() - Vector2(0.5,0.5);
+		
 		float xndc = (x + 0.5 + sample.x)/Film.width;
 		float yndc = (y + 0.5 + sample.y)/Film.height;
 		
@@ -353,6 +457,29 @@ struct renderOptions
 	float gamma;
 	float exposure;
 	
+	// Opes de acelerao e amostragem com valores padro (configuradas pelo nome em "commandOptions")
+	AcceleratorType acceleratorType = AcceleratorType::Automatic;
+	BVHBuildMethod buildMethod = BVHBuildMethod::BinnedSAH;
+	size_t bvhWidth = 4;
+	BVHLayout bvhLayout = BVHLayout::DepthFirst; // Ordem dos ns da hierarquia binria na memria
+	bool trianglePacking = false; // Vrtices copiados na ordem das folhas da hierarquia binria
+	string bvhCacheFilename; // Cache em disco da hierarquia binria (vazio = sem cache)
+	int packetSize = 0; // Lado dos blocos de pixels traados em pacote (0 = raio a raio; substitui "tileSize")
+	bool rayStreams = false; // Raios secundrios de cada bloco acumulados e traados em ordem coerente
+	TriangleIntersection triangleIntersection = TriangleIntersection::MollerTrumbore;
+	bool rasterize = false; // Visibilidade primria por rasterizao (buffer de visibilidade) em vez de raios de cmera
+	bool wavefront = false; // Caminhos traados em frentes de onda (estgios separados sobre filas) em vez de recurso
+	size_t waveSize = 1 << 20; // Caminhos por frente de onda
+	int threadCount = 0; // Threads de renderizao (0 = todos os ncleos)
+	int tileSize = 16; // Lado dos blocos de pixels distribudos entre as threads
+	SamplerType samplerType = SamplerType::Sobol; // Sequncia das amostras de cmera e de luz
+	bool progressive = false; // Passadas de amostras acumuladas at o limite de amostras ou de tempo
+	size_t timeBudget = 0; // Tempo limite da renderizao progressiva em ms (0 = sem limite)
+	int maximumSamples = 0; // Amostras por pixel da renderizao progressiva (0 = cameraSamples)
+	int passSamples = 1; // Amostras por pixel em cada passada progressiva
+	double adaptiveThreshold = 0.0; // Erro estimado abaixo do qual pixels deixam de receber amostras (0 = uniforme)
+	int adaptiveMinimumSamples = 8; // Amostras por pixel antes da primeira estimativa de erro
+	
 	renderOptions() {}
 	
 	renderOptions(
@@ -378,93 +505,852 @@ struct renderOptions
 	}	
 };
 
+AcceleratorType acceleratorTypeFromName(const string & name)
+{
+	if (name == "brute")
+		return AcceleratorType::BruteForce;
+	if (name == "grid")
+		return AcceleratorType::UniformGrid;
+	if (name == "auto")
+		return AcceleratorType::Automatic;
+	if (name == "quantized")
+		return AcceleratorType::QuantizedBVH;
+	
+	// Demais nomes indicam mtodo de construo da hierarquia
+	return AcceleratorType::BVH;
+}
+
+BVHBuildMethod buildMethodFromName(const string & name)
+{
+	if (name == "sweep")
+		return BVHBuildMethod::SweepSAH;
+	if (name == "linear")
+		return BVHBuildMethod::Linear;
+	if (name == "hlbvh")
+		return BVHBuildMethod::HierarchicalLinear;
+	if (name == "sbvh")
+		return BVHBuildMethod::SpatialSAH;
+	
+	return BVHBuildMethod::BinnedSAH;
+}
+
+SamplerType samplerTypeFromName(const string & name)
+{
+	if (name == "independent")
+		return SamplerType::Independent;
+	if (name == "halton")
+		return SamplerType::Halton;
+	
+	return SamplerType::Sobol;
+}
+
+// Opo de linha de comando "--nome [valor]"
+struct commandOption
+{
+	const char * name;
+	const char * argument; // Nome do valor (nullptr em opes sem valor)
+	void (*apply)(renderOptions & options, const char * value);
+	const char * description;
+};
+
+// Opes aceitas por "main" (nova opo: membro com valor padro em "renderOptions" e uma entrada aqui)
+const commandOption commandOptions[] = {
+	{"accelerator", "name", [](renderOptions & o, const char * v) {
+		o.acceleratorType = acceleratorTypeFromName(v);
+		o.buildMethod = buildMethodFromName(v); },
+		"auto, brute, grid, quantized or a BVH build method (sah, sweep, linear, hlbvh, sbvh)"},
+	{"bvh-width", "n", [](renderOptions & o, const char * v) { o.bvhWidth = atoi(v); },
+		"BVH children per node (2, 4 or 8)"},
+	{"layout", "order", [](renderOptions & o, const char * v) {
+		o.bvhLayout = string(v) == "larger-child-first" ? BVHLayout::LargerChildFirst : BVHLayout::DepthFirst; },
+		"BVH node order: depth-first or larger-child-first"},
+	{"triangle-packing", nullptr, [](renderOptions & o, const char *) { o.trianglePacking = true; },
+		"copy triangle vertices in BVH leaf order (binary BVH, --bvh-width 2)"},
+	{"bvh-cache", "file", [](renderOptions & o, const char * v) { o.bvhCacheFilename = v; },
+		"load the BVH from this file, or build it and write it there"},
+	{"packet-size", "n", [](renderOptions & o, const char * v) { o.packetSize = max(atoi(v), 0); },
+		"side of pixel blocks traced as packets (0 = single rays)"},
+	{"streams", nullptr, [](renderOptions & o, const char *) { o.rayStreams = true; },
+		"trace the shadow rays of each block as one sorted stream"},
+	{"watertight", nullptr, [](renderOptions & o, const char *) { o.triangleIntersection = TriangleIntersection::Watertight; },
+		"watertight single-precision triangle test"},
+	{"raster", nullptr, [](renderOptions & o, const char *) { o.rasterize = true; },
+		"rasterized primary visibility"},
+	{"wavefront", nullptr, [](renderOptions & o, const char *) { o.wavefront = true; },
+		"wavefront path tracing"},
+	{"wave-size", "n", [](renderOptions & o, const char * v) { o.waveSize = max(atoi(v), 1); },
+		"paths per wavefront"},
+	{"threads", "n", [](renderOptions & o, const char * v) { o.threadCount = max(atoi(v), 0); },
+		"render threads (0 = all cores)"},
+	{"tile-size", "n", [](renderOptions & o, const char * v) { o.tileSize = max(atoi(v), 1); },
+		"side of the pixel tiles shared between threads"},
+	{"sampler", "name", [](renderOptions & o, const char * v) { o.samplerType = samplerTypeFromName(v); },
+		"sobol, halton or independent"},
+	{"progressive", nullptr, [](renderOptions & o, const char *) { o.progressive = true; },
+		"accumulate passes, writing progress.ppm after each one"},
+	{"time-budget", "ms", [](renderOptions & o, const char * v) { o.progressive = true; o.timeBudget = max(atoi(v), 0); },
+		"progressive render time limit (0 = none)"},
+	{"samples", "n", [](renderOptions & o, const char * v) { o.maximumSamples = max(atoi(v), 0); },
+		"progressive samples per pixel (0 = camera samples)"},
+	{"pass-samples", "n", [](renderOptions & o, const char * v) { o.passSamples = max(atoi(v), 1); },
+		"samples per pixel in each progressive pass"},
+	{"adaptive-threshold", "error", [](renderOptions & o, const char * v) { o.adaptiveThreshold = atof(v); },
+		"estimated error below which pixels stop sampling (0 = uniform)"},
+	{"adaptive-minimum-samples", "n", [](renderOptions & o, const char * v) { o.adaptiveMinimumSamples = max(atoi(v), 1); },
+		"samples per pixel before the first error estimate"}
+};
+
+// Configura opes a partir dos argumentos "--nome [valor]"; retorna falso em opo desconhecida ou sem valor
+bool parseOptions(int argc, char ** argv, renderOptions & options)
+{
+	for (int i = 1; i < argc; i++) {
+		const commandOption * found = nullptr;
+		
+		for (const commandOption & option : commandOptions)
+			if (string(argv[i]) == string("--") + option.name)
+				found = &option;
+		
+		if (found == nullptr) {
+			cout << "Unknown option: " << argv[i] << endl;
+			return false;
+		}
+		
+		if (found->argument != nullptr && ++i == argc) {
+			cout << "Missing value: --" << found->name << " <" << found->argument << ">" << endl;
+			return false;
+		}
+		
+		found->apply(options, found->argument != nullptr ? argv[i] : nullptr);
+	}
+	
+	return true;
+}
+
+// Imprime opes aceitas e suas descries
+void printUsage()
+{
+	cout << "Usage: mitsuha [options]" << endl;
+	
+	for (const commandOption & option : commandOptions) {
+		string usage = string("--") + option.name;
+		
+		if (option.argument != nullptr)
+			usage += string(" <") + option.argument + ">";
+		
+		cout << "  " << usage << string(max(32 - (int)usage.size(), 1), ' ') << option.description << endl;
+	}
+}
+
+// Estados dos caminhos da renderizao em frentes de onda: um vetor por campo (estrutura de vetores), um
+// elemento por caminho; filas dos estgios guardam ndices de caminhos
+struct pathStates
+{
+	std::vector<uint32_t> pixels; // Pixel do caminho (x + y * largura)
+	std::vector<uint32_t> sampleIndices; // ndice da amostra no pixel
+	std::vector<Vector3> origins; // Origem do segmento atual
+	std::vector<Vector3> directions; // Direo do segmento atual
+	std::vector<float> distances; // Distncia da interseo do segmento atual
+	std::vector<size_t> triangles; // Tringulo intersectado pelo segmento atual (size_t(-1) sem interseo)
+	std::vector<Color3> radiances; // Radincia acumulada
+	std::vector<Vector3> shadowOrigins; // Origem do raio de sombra pendente
+	std::vector<Vector3> shadowDirections; // Direo do raio de sombra pendente
+	std::vector<double> shadowDistances; // Distncia at o ponto amostrado na luz
+	std::vector<Color3> shadowContributions; // Contribuio do raio de sombra pendente se no ocludo
+	
+	// Aloca estados para "count" caminhos (memria mantida entre frentes de onda)
+	void resize(size_t count)
+	{
+		if (count <= pixels.size())
+			return;
+		
+		pixels.resize(count);
+		sampleIndices.resize(count);
+		origins.resize(count);
+		directions.resize(count);
+		distances.resize(count);
+		triangles.resize(count);
+		radiances.resize(count);
+		shadowOrigins.resize(count);
+		shadowDirections.resize(count);
+		shadowDistances.resize(count);
+		shadowContributions.resize(count);
+	}
+};
+
 struct renderer
 {
 	renderOptions options;
 	camera Camera;
 	Scene scene;
+	Rasterizer rasterizer;
+	std::unique_ptr<ThreadPool> threadPool;
+	std::atomic<size_t> rayCount;
+	static thread_local size_t threadRayCount; // Raios da thread atual ainda no somados a "rayCount"
+	size_t deadline; // Instante (ms) a partir do qual blocos da passada atual so descartados (0 = sem limite)
+	std::vector<uint8_t> activePixels; // Pixels que recebem amostras na passada atual (vazio = todos)
+	std::vector<uint8_t> unconvergedPixels; // Pixels com erro estimado acima de adaptiveThreshold
+	pathStates paths; // Caminhos da frente de onda atual
 	
-	renderer() {}
+	renderer() {
+		threadPool.reset(new ThreadPool(options.threadCount));
+		rayCount = 0;
+		deadline = 0;
+	}
 	
 	renderer(renderOptions options, camera Camera, Scene scene)
 	{
 		this->options=options;
 		this->Camera=Camera;
 		this->scene=scene;
+		setTriangleIntersection(options.triangleIntersection);
+		this->scene.build(options.acceleratorType, options.buildMethod, options.bvhWidth,
+			options.bvhLayout, options.trianglePacking, options.bvhCacheFilename);
+		rasterizer.setCamera(Camera.worldMatrix, Camera.fieldOfView, Camera.Film.width, Camera.Film.height);
+		rasterizer.setThreadCount(options.threadCount);
+		threadPool.reset(new ThreadPool(options.threadCount));
+		rayCount = 0;
+		deadline = 0;
 	}
 	
-	Color3 computerDirectIllumination(BSDF bsdf, shaderGlobals shaderglobals)
+	// Blocos fixos de dimenses das amostras: cmera usa 0 e 1 e cada profundidade reserva seleo de luz,
+	// ponto na luz (2D) e direo do BSDF (2D), na mesma dimenso em todos os caminhos mesmo quando etapas
+	// anteriores so puladas (pares 2D alinhados s dimenses mais bem distribudas das sequncias)
+	enum {
+		cameraDimensions = 2,
+		lightSelectionDimension = 0,
+		lightPointDimension = 1,
+		bsdfDimension = 3,
+		bounceDimensions = 5
+	};
+	
+	int bounceDimension(int depth) const
+	{
+		return cameraDimensions + depth * bounceDimensions;
+	}
+	
+	// Amostra ponto em uma luz e prepara raio de sombra at ele (falso se no h luzes)
+	bool sampleLight(shaderGlobals & shaderglobals, ray & Ray, double & maximum, int depth, Sampler & sampler)
 	{
 		if(scene.lightGroup.size() == 0)
-		{
+			return false;
+		
+		sampler.setDimension(bounceDimension(depth) + lightSelectionDimension);
+		
+		int index = sampler.get1D() * (scene.lightGroup.size() - 1);
+		const Triangle & light = scene.lightGroup[index];
+		
+		sampler.setDimension(bounceDimension(depth) + lightPointDimension);
+		shaderglobals.lightPoint =  light.uniformSample(sampler.get2D());
+		
+		Vector3 wi = shaderglobals.lightPoint - shaderglobals.point;
+		float distance2 = wi.length2();
+		wi.normalize();
+		
+		Ray = ray(shaderglobals.point,wi);
+		
+		// Encurta o raio para no atingir a prpria luz
+		maximum = std::sqrt(distance2) * (1.0 - 1e-4);
+		
+		return true;
+	}
+	
+	Color3 computerDirectIllumination(BSDF bsdf, shaderGlobals shaderglobals, int depth, Sampler & sampler)
+	{
+		ray Ray;
+		double maximum;
+		
+		if(!sampleLight(shaderglobals, Ray, maximum, depth, sampler))
+			return Color3();
+		
+		threadRayCount++;
+		
+		if (scene.occluded(Ray, maximum))
 			return Color3();
+		
+		return bsdf.color;
+	}
+	
+	Color3 computerIndirectIllumination(BSDF bsdf, shaderGlobals sg, int depth)
+	{
+        return Color3();	
+	}
+	
+	Color3 shade(ray Ray, intersection Intersection, int depth, Sampler & sampler)
+	{
+		if (Intersection.hit) {
+            	Triangle triangle = scene.getTriangle(Intersection.index);
+            	BSDF * bsdf = triangle.bsdf;
+            	shaderGlobals sg = triangle.calculateShaderGlobals(Intersection, Ray);
+            	return computerDirectIllumination(*bsdf,sg,depth,sampler);
 		}
 		else
+			return Color3();
+	}
+	
+	Color3 trace(ray Ray, int depth, Sampler & sampler)
+	{
+		intersection Intersection;
+		
+		threadRayCount++;
+		scene.intersects(Ray, Intersection);
+		
+		return shade(Ray, Intersection, depth, sampler);
+	}
+	
+	// Distribui blocos de "size x size" pixels entre as threads (roubo de trabalho) e chama
+	// "function(x, y, width, height)" para cada um; blocos em colunas, como no lao original, e cada bloco
+	// escreve apenas seus prprios pixels da imagem (sem bloqueios)
+	template<typename Function>
+	void forEachTile(int size, const Function & function)
+	{
+		int columns = (options.width + size - 1) / size;
+		int rows = (options.height + size - 1) / size;
+		
+		threadPool->run(columns * rows, [&](size_t, size_t tile) {
+			int x = (tile / rows) * size;
+			int y = (tile % rows) * size;
+			
+			function(x, y, min(size, options.width - x), min(size, options.height - y));
+			
+			rayCount += threadRayCount;
+			threadRayCount = 0;
+		});
+	}
+	
+	// Verdadeiro se o tempo limite da passada atual se esgotou (blocos ainda no iniciados so descartados)
+	bool expired() const
+	{
+		return deadline != 0 && time() >= deadline;
+	}
+	
+	bool isActive(int i, int j) const
+	{
+		return activePixels.empty() || activePixels[i + j * options.width];
+	}
+	
+	// Amostragem adaptativa: ativa pixels cujo erro estimado excede adaptiveThreshold e seus vizinhos (bordas
+	// finas podem parecer convergidas com poucas amostras quando todas caem do mesmo lado); retorna o nmero
+	// de pixels ativos. S pixels amostrados na ltima passada tm o erro reavaliado (demais no mudaram)
+	size_t updateActivePixels(const AccumulationBuffer & buffer)
+	{
+		if (activePixels.empty())
+			unconvergedPixels.assign(options.width * options.height, 1);
+		
+		forEachTile(options.tileSize, [&](int x, int y, int width, int height) {
+			for(int j=y;j<y + height;j++)
+			{
+				for(int i=x;i<x + width;i++)
+				{
+					if (isActive(i, j))
+						unconvergedPixels[i + j * options.width] = buffer.getError(i, j) > options.adaptiveThreshold;
+				}
+			}
+		});
+		
+		size_t activeCount = 0;
+		
+		activePixels.assign(options.width * options.height, 0);
+		
+		for(int j=0;j<options.height;j++)
 		{
-			int index = uniformRandom() * (scene.lightGroup.size() - 1);
-			Triangle * light = scene.lightGroup[index];
+			for(int i=0;i<options.width;i++)
+			{
+				if (!unconvergedPixels[i + j * options.width])
+					continue;
+				
+				for(int v=max(j - 1, 0);v<=min(j + 1, options.height - 1);v++)
+				{
+					for(int u=max(i - 1, 0);u<=min(i + 1, options.width - 1);u++)
+					{
+						activeCount += !activePixels[u + v * options.width];
+						activePixels[u + v * options.width] = 1;
+					}
+				}
+			}
+		}
+		
+		return activeCount;
+	}
+	
+	// Traa blocos de pixels: raios de cmera em pacotes (packetSize x packetSize) e, com rayStreams,
+	// raios de sombra de todas as amostras do bloco acumulados e traados em ordem coerente
+	void renderTiles(AccumulationBuffer & buffer, int sampleCount)
+	{
+		int size = options.packetSize > 1 ? options.packetSize : options.tileSize;
+		
+		forEachTile(size, [&](int x, int y, int width, int height) {
+			if (expired())
+				return;
 			
-			shaderglobals.lightPoint =  light->uniformSample(uniformRandom2D());
+			std::vector<ray> rays;
+			std::vector<Sampler> samplers; // Estado da amostra de cada raio (sombreamento continua suas dimenses)
+			std::vector<intersection> intersections;
+			std::vector<Color3> colors(width * height, Color3(0.0, 0.0, 0.0));
+			std::vector<double> squaredSums(width * height, 0.0); // Soma dos quadrados da luminncia das amostras
+			std::vector<uint32_t> firstSamples(width * height); // Amostras j acumuladas em cada pixel
+			std::vector<size_t> tilePixels; // Pixels ativos do bloco (ndice local de cada raio)
+			RayStream stream;
+			std::vector<size_t> pixels;
+			std::vector<Color3> contributions;
 			
-			Vector3 wi = shaderglobals.lightPoint - shaderglobals.point;
-			float distance2 = wi.length2();
-			wi.normalize();
+			for(int i=0;i<width;i++)
+			{
+				for(int j=0;j<height;j++)
+				{
+					if (isActive(x + i, y + j)) {
+						firstSamples[i * height + j] = buffer.getSampleCount(x + i, y + j);
+						tilePixels.push_back(i * height + j);
+					}
+				}
+			}
 			
-			ray Ray(shaderglobals.point,wi); 
+			if (tilePixels.empty())
+				return;
 			
-			intersection Intersection;
-			scene.intersects(Ray,Intersection);
-			shaderGlobals sglight = light.calculateShaderGlobals(Intersection,Ray);
+			for(int k=0;k<sampleCount;k++)
+			{
+				rays.clear();
+				samplers.clear();
+				
+				for(size_t p=0;p<tilePixels.size();p++)
+				{
+					int i = tilePixels[p] / height;
+					int j = tilePixels[p] % height;
+					Sampler sampler(options.samplerType);
+					sampler.startPixelSample(x + i, y + j, firstSamples[tilePixels[p]] + k);
+					rays.push_back(Camera.generateRay(x + i,y + j,sampler));
+					samplers.push_back(sampler);
+				}
+				
+				intersections.assign(rays.size(), intersection());
+				
+				if (options.packetSize > 1)
+					scene.intersects(rays.data(), intersections.data(), rays.size());
+				else {
+					for(size_t r=0;r<rays.size();r++)
+						scene.intersects(rays[r], intersections[r]);
+				}
+				
+				threadRayCount += rays.size();
+				
+				for(size_t r=0;r<rays.size();r++)
+				{
+					if (!options.rayStreams) {
+						Color3 color = shade(rays[r], intersections[r], 0, samplers[r]);
+						colors[tilePixels[r]] += color;
+						squaredSums[tilePixels[r]] += color.luminance() * color.luminance();
+						continue;
+					}
+					
+					// Iluminao direta adiada: raio de sombra entra no fluxo do bloco
+					if (!intersections[r].hit)
+						continue;
+					
+					Triangle triangle = scene.getTriangle(intersections[r].index);
+					shaderGlobals sg = triangle.calculateShaderGlobals(intersections[r], rays[r]);
+					ray Ray;
+					double maximum;
+					
+					if (sampleLight(sg, Ray, maximum, 0, samplers[r])) {
+						stream.add(Ray3(Ray.origin, Ray.direction, AURORA_EPSILON, maximum));
+						pixels.push_back(tilePixels[r]);
+						contributions.push_back(triangle.bsdf->color);
+					}
+				}
+			}
 			
-		}
-		
+			if (stream.getRayCount() != 0) {
+				std::unique_ptr<bool[]> occluded(new bool[stream.getRayCount()]);
+				
+				scene.occluded(stream, occluded.get());
+				threadRayCount += stream.getRayCount();
+				
+				// Amostras com luz ocluda no contribuem; cada amostra contribui no mximo uma vez
+				for(size_t q=0;q<pixels.size();q++)
+				{
+					if (occluded[q])
+						continue;
+					
+					colors[pixels[q]] += contributions[q];
+					squaredSums[pixels[q]] += contributions[q].luminance() * contributions[q].luminance();
+				}
+			}
+			
+			for(size_t p=0;p<tilePixels.size();p++)
+			{
+				int i = tilePixels[p] / height;
+				int j = tilePixels[p] % height;
+				buffer.add(x + i, y + j, colors[tilePixels[p]], squaredSums[tilePixels[p]], sampleCount);
+			}
+		});
+	}
+	
+	// Visibilidade primria rasterizada: cada amostra de cmera sorteia o deslocamento de todos os pixels,
+	// rasteriza o buffer de visibilidade com esses deslocamentos e sombreia com o raio de cmera correspondente
+	void renderRasterized(AccumulationBuffer & buffer, int sampleCount)
+	{
+		int width = min(options.width, (int)rasterizer.getWidth());
+		int height = min(options.height, (int)rasterizer.getHeight());
+		std::vector<Vector2> samples(rasterizer.getWidth() * rasterizer.getHeight(), Vector2(0.0, 0.0));
+		std::vector<RayHit> hits;
 		
-		return bsdf.color;
+		for(int k=0;k<sampleCount;k++)
+		{
+			// Deslocamentos das primeiras dimenses das prximas amostras de cada pixel, iguais aos de
+			// generateRay no sombreamento (todos os blocos, mesmo aps o tempo limite)
+			forEachTile(options.tileSize, [&](int x, int y, int tileWidth, int tileHeight) {
+				Sampler sampler(options.samplerType);
+				
+				for(int i=x;i<min(x + tileWidth, width);i++)
+				{
+					for(int j=y;j<min(y + tileHeight, height);j++)
+					{
+						sampler.startPixelSample(i, j, buffer.getSampleCount(i, j));
+						samples[j * rasterizer.getWidth() + i] = sampler.get2D() - Vector2(0.5,0.5);
+					}
+				}
+			});
+			
+			rasterizer.rasterize(scene.mesh.get(), samples.data(), hits);
+			
+			forEachTile(options.tileSize, [&](int x, int y, int tileWidth, int tileHeight) {
+				if (expired())
+					return;
+				
+				Sampler sampler(options.samplerType);
+				
+				for(int i=x;i<min(x + tileWidth, width);i++)
+				{
+					for(int j=y;j<min(y + tileHeight, height);j++)
+					{
+						if (!isActive(i, j))
+							continue;
+						
+						size_t pixel = j * rasterizer.getWidth() + i;
+						sampler.startPixelSample(i, j, buffer.getSampleCount(i, j));
+						ray Ray = Camera.generateRay(i,j,sampler);
+						intersection Intersection;
+						
+						if (hits[pixel].hasHit()) {
+							Intersection.hit = true;
+							Intersection.distance = hits[pixel].distance;
+							Intersection.index = hits[pixel].index;
+						}
+						
+						buffer.add(i, j, shade(Ray, Intersection, 0, sampler));
+					}
+				}
+			});
+		}
 	}
 	
-	Color3 computerIndirectIllumination(BSDF bsdf, shaderGlobals sg, int depth)
+	// Traa pixels raio a raio em blocos distribudos entre as threads
+	void renderPixels(AccumulationBuffer & buffer, int sampleCount)
 	{
-        return Color3();	
+		forEachTile(options.tileSize, [&](int x, int y, int width, int height) {
+			if (expired())
+				return;
+			
+			Sampler sampler(options.samplerType);
+			
+			for(int i=x;i<x + width;i++)
+			{
+				for(int j=y;j<y + height;j++)
+				{
+					if (!isActive(i, j))
+						continue;
+					
+					Color3 colorOutput(0.0, 0.0, 0.0);
+					double squaredSum = 0.0;
+					uint32_t firstSample = buffer.getSampleCount(i, j);
+					
+					for(int k=0;k<sampleCount;k++)
+					{
+						sampler.startPixelSample(i, j, firstSample + k);
+						ray Ray = Camera.generateRay(i,j,sampler);
+						Color3 color = trace(Ray, 0, sampler);
+						colorOutput += color;
+						squaredSum += color.luminance() * color.luminance();
+					}
+					
+					buffer.add(i, j, colorOutput, squaredSum, sampleCount);
+				}
+			}
+		});
 	}
 	
-	Color3 trace(ray Ray, int depth)
+	// Executa "kernel(first, last, output)" sobre blocos de "[0, count)" distribudos entre as threads; ndices
+	// de caminhos emitidos por cada bloco em "output" so compactados em "queue" na ordem dos blocos (fila
+	// densa e independente do escalonamento)
+	template<typename Kernel>
+	void runKernel(size_t count, std::vector<uint32_t> * queue, const Kernel & kernel)
 	{
-		intersection Intersection;
-
-		if (scene.intersects(Ray, Intersection)) {
-            	Triangle * triangle = scene.triangles[Intersection.index];
-            	BSDF * bsdf = triangle->bsdf;
-            	shaderGlobals sg = triangle->calculateShaderGlobals(Intersection, Ray);
-            	return computerDirectIllumination(*bsdf,sg);
+		size_t chunkCount = (count + kernelChunkSize - 1) / kernelChunkSize;
+		std::vector<std::vector<uint32_t> > outputs(chunkCount);
+		
+		threadPool->run(chunkCount, [&](size_t, size_t chunk) {
+			size_t first = chunk * kernelChunkSize;
+			
+			kernel(first, min(first + kernelChunkSize, count), outputs[chunk]);
+			
+			rayCount += threadRayCount;
+			threadRayCount = 0;
+		});
+		
+		if (queue != nullptr) {
+			queue->clear();
+			
+			for(size_t chunk=0;chunk<chunkCount;chunk++)
+				queue->insert(queue->end(), outputs[chunk].begin(), outputs[chunk].end());
 		}
-		else
-			return Color3();
 	}
 	
-	Image3 render()
+	enum {
+		kernelChunkSize = 4096 // Itens das filas por tarefa dos estgios
+	};
+	
+	// Integrador em frentes de onda: caminhos de at waveSize amostras ficam em "paths" e cada estgio
+	// (gerao, extenso, sombreamento, sombra, acumulao) percorre sua fila compactada em paralelo, mesma
+	// operao sobre muitos caminhos seguidos em vez de um caminho inteiro por vez. Mesmas amostras e
+	// mesmo resultado do traado recursivo (trace)
+	void renderWavefront(AccumulationBuffer & buffer, int sampleCount)
 	{
-		Image3 im(options.width, options.height);
+		std::vector<uint32_t> pixels; // Pixels ativos em ordem de blocos (caminhos vizinhos na mesma tarefa)
+		std::vector<uint32_t> extendQueue;
+		std::vector<uint32_t> shadowQueue;
 		
-		for(int i=0;i<options.width;i++)
+		for(int x=0;x<options.width;x+=options.tileSize)
 		{
-			for(int j=0;j<options.height;j++)
+			for(int y=0;y<options.height;y+=options.tileSize)
 			{
-				Color3 colorOutput(0.0, 0.0, 0.0);
+				for(int j=y;j<min(y + options.tileSize, options.height);j++)
+				{
+					for(int i=x;i<min(x + options.tileSize, options.width);i++)
+					{
+						if (isActive(i, j))
+							pixels.push_back(i + j * options.width);
+					}
+				}
+			}
+		}
+		
+		size_t pixelsPerWave = max(options.waveSize / sampleCount, size_t(1));
+		
+		for(size_t firstPixel=0;firstPixel<pixels.size() && !expired();firstPixel+=pixelsPerWave)
+		{
+			size_t pixelCount = min(pixelsPerWave, pixels.size() - firstPixel);
+			
+			paths.resize(pixelCount * sampleCount);
+			
+			// Gerao: raios de cmera das amostras de cada pixel (amostras do mesmo pixel em sequncia)
+			runKernel(pixelCount * sampleCount, &extendQueue, [&](size_t first, size_t last, std::vector<uint32_t> & output) {
+				Sampler sampler(options.samplerType);
 				
-				for(int k=0;k<options.cameraSamples;k++)
+				for(size_t p=first;p<last;p++)
 				{
-					Vector2 s = Vector2(uniformRandom(),uniformRandom()) - Vector2(0.5,0.5);
-					ray Ray = Camera.generateRay(i,j,s);
-					colorOutput += trace(Ray, 0);
+					uint32_t pixel = pixels[firstPixel + p / sampleCount];
+					int x = pixel % options.width;
+					int y = pixel / options.width;
+					
+					paths.pixels[p] = pixel;
+					paths.sampleIndices[p] = buffer.getSampleCount(x, y) + p % sampleCount;
+					sampler.startPixelSample(x, y, paths.sampleIndices[p]);
+					
+					ray Ray = Camera.generateRay(x,y,sampler);
+					
+					paths.origins[p] = Ray.origin;
+					paths.directions[p] = Ray.direction;
+					paths.radiances[p] = Color3(0.0, 0.0, 0.0);
+					output.push_back(p);
 				}
+			});
+			
+			for(int depth=0;depth<max(options.maximumDepth, 1) && !extendQueue.empty();depth++)
+			{
+				// Extenso: interseo dos segmentos da fila (pacotes coerentes com packetSize)
+				runKernel(extendQueue.size(), nullptr, [&](size_t first, size_t last, std::vector<uint32_t> &) {
+					std::vector<ray> rays(last - first);
+					std::vector<intersection> intersections(last - first);
+					
+					for(size_t q=first;q<last;q++)
+						rays[q - first] = ray(paths.origins[extendQueue[q]], paths.directions[extendQueue[q]]);
+					
+					if (options.packetSize > 1)
+						scene.intersects(rays.data(), intersections.data(), rays.size());
+					else {
+						for(size_t r=0;r<rays.size();r++)
+							scene.intersects(rays[r], intersections[r]);
+					}
+					
+					threadRayCount += rays.size();
+					
+					for(size_t q=first;q<last;q++)
+					{
+						paths.distances[extendQueue[q]] = intersections[q - first].distance;
+						paths.triangles[extendQueue[q]] = intersections[q - first].hit ? intersections[q - first].index : size_t(-1);
+					}
+				});
+				
+				// Sombreamento: amostra luz dos caminhos que atingiram superfcies e emite raios de sombra
+				runKernel(extendQueue.size(), &shadowQueue, [&](size_t first, size_t last, std::vector<uint32_t> & output) {
+					Sampler sampler(options.samplerType);
+					
+					for(size_t q=first;q<last;q++)
+					{
+						uint32_t p = extendQueue[q];
+						
+						if (paths.triangles[p] == size_t(-1))
+							continue;
+						
+						ray Ray(paths.origins[p], paths.directions[p]);
+						intersection Intersection;
+						
+						Intersection.hit = true;
+						Intersection.distance = paths.distances[p];
+						Intersection.index = paths.triangles[p];
+						
+						Triangle triangle = scene.getTriangle(Intersection.index);
+						shaderGlobals sg = triangle.calculateShaderGlobals(Intersection, Ray);
+						ray shadowRay;
+						double maximum;
+						
+						sampler.startPixelSample(paths.pixels[p] % options.width, paths.pixels[p] / options.width, paths.sampleIndices[p]);
+						
+						if (sampleLight(sg, shadowRay, maximum, depth, sampler)) {
+							paths.shadowOrigins[p] = shadowRay.origin;
+							paths.shadowDirections[p] = shadowRay.direction;
+							paths.shadowDistances[p] = maximum;
+							paths.shadowContributions[p] = triangle.bsdf->color;
+							output.push_back(p);
+						}
+					}
+				});
 				
-				colorOutput /= options.cameraSamples;
+				// Sombra: ocluso dos raios da fila (ordem coerente com rayStreams) e contribuio da luz
+				// apenas nos caminhos com luz visvel
+				runKernel(shadowQueue.size(), nullptr, [&](size_t first, size_t last, std::vector<uint32_t> &) {
+					std::unique_ptr<bool[]> occluded(new bool[last - first]);
+					
+					if (options.rayStreams) {
+						RayStream stream;
+						
+						for(size_t q=first;q<last;q++)
+						{
+							uint32_t p = shadowQueue[q];
+							stream.add(Ray3(paths.shadowOrigins[p], paths.shadowDirections[p], AURORA_EPSILON, paths.shadowDistances[p]));
+						}
+						
+						scene.occluded(stream, occluded.get());
+					}
+					else {
+						for(size_t q=first;q<last;q++)
+						{
+							uint32_t p = shadowQueue[q];
+							occluded[q - first] = scene.occluded(ray(paths.shadowOrigins[p], paths.shadowDirections[p]), paths.shadowDistances[p]);
+						}
+					}
+					
+					threadRayCount += last - first;
+					
+					for(size_t q=first;q<last;q++)
+						if (!occluded[q - first])
+							paths.radiances[shadowQueue[q]] += paths.shadowContributions[shadowQueue[q]];
+				});
 				
-				im(i, j) = colorOutput;
+				// Iluminao indireta ainda no implementada (como em computerIndirectIllumination): nenhum
+				// caminho continua para a prxima extenso
+				extendQueue.clear();
 			}
+			
+			// Acumulao: soma das amostras de cada pixel (um pixel por item, sem escrita concorrente)
+			runKernel(pixelCount, nullptr, [&](size_t first, size_t last, std::vector<uint32_t> &) {
+				for(size_t slot=first;slot<last;slot++)
+				{
+					Color3 sum(0.0, 0.0, 0.0);
+					double squaredSum = 0.0;
+					
+					for(int k=0;k<sampleCount;k++)
+					{
+						const Color3 & radiance = paths.radiances[slot * sampleCount + k];
+						sum += radiance;
+						squaredSum += radiance.luminance() * radiance.luminance();
+					}
+					
+					buffer.add(pixels[firstPixel + slot] % options.width, pixels[firstPixel + slot] / options.width, sum, squaredSum, sampleCount);
+				}
+			});
 		}
+	}
+	
+	// Acumula mais "sampleCount" amostras em cada pixel, continuando a sequncia de amostras do pixel
+	void renderPass(AccumulationBuffer & buffer, int sampleCount)
+	{
+		if (options.wavefront)
+			renderWavefront(buffer, sampleCount);
+		else if (options.rasterize)
+			renderRasterized(buffer, sampleCount);
+		else if (options.packetSize > 1 || options.rayStreams)
+			renderTiles(buffer, sampleCount);
+		else
+			renderPixels(buffer, sampleCount);
+	}
+	
+	Image3 render()
+	{
+		AccumulationBuffer buffer(options.width, options.height);
+		Image3 im;
+		
+		renderPass(buffer, options.cameraSamples);
+		buffer.resolve(im);
+		
+		return im;
+	}
+	
+	// Renderizao progressiva: passadas de "passSamples" amostras por pixel at "maximumSamples" ou at
+	// o tempo limite. Passada cuja durao estimada (a da anterior) excede o tempo restante no  iniciada;
+	// se o tempo se esgota durante a passada, seus blocos ainda no iniciados so descartados (pixels com
+	// uma passada a menos). A primeira passada  sempre completa. Com adaptiveThreshold, aps
+	// adaptiveMinimumSamples as passadas amostram apenas pixels ainda no convergidos (ver updateActivePixels)
+	// e terminam quando todos convergem. "progress(imagem, amostras)" recebe a imagem parcial e as amostras
+	// da passada ao fim de cada uma
+	Image3 renderProgressive(AccumulationBuffer & buffer, const std::function<void(const Image3 &, int)> & progress = nullptr)
+	{
+		Image3 im;
+		
+		int maximumSamples = options.maximumSamples > 0 ? options.maximumSamples : options.cameraSamples;
+		int passSamples = max(options.passSamples, 1);
+		size_t start = time();
 		
+		buffer.create(options.width, options.height);
+		
+		for(int samples=0;samples<maximumSamples;)
+		{
+			size_t passStart = time();
+			int sampleCount = min(passSamples, maximumSamples - samples);
+			
+			if (options.adaptiveThreshold > 0.0 && samples >= options.adaptiveMinimumSamples &&
+				updateActivePixels(buffer) == 0)
+				break;
+			
+			deadline = samples != 0 && options.timeBudget != 0 ? start + options.timeBudget : 0;
+			renderPass(buffer, sampleCount);
+			samples += sampleCount;
+			
+			if (progress) {
+				buffer.resolve(im);
+				progress(im, samples);
+			}
+			
+			size_t now = time();
+			
+			if (options.timeBudget != 0 && now - start + (now - passStart) > options.timeBudget)
+				break;
+		}
 		
+		deadline = 0;
+		activePixels.clear();
+		unconvergedPixels.clear();
+		buffer.resolve(im);
 		
 		return im;
 	}
@@ -474,39 +1360,30 @@ struct renderer
 	
 };
 
+thread_local size_t renderer::threadRayCount = 0;
+
 
 
 
 int main(int argc, char ** argv) {
 	
-    Vertex v1[3];
-    Vertex v2[3];
-    
     renderOptions renderoptions(500, 500, 1, 4, 1, 1, 2, 2.2, 0);
+    
+    if (!parseOptions(argc, argv, renderoptions)) {
+        printUsage();
+        return 1;
+    }
 	
-	v1[0].position = Vector3(0.0, 0.0, 0.0);
-	v1[0].normal = Vector3(0.0, 0.0, 1.0);
-	v1[0].uv = Vector2(0.0, 0.0);
-	
-	v1[1].position = Vector3(2.0, 0.0, 0.0);
-	v1[1].normal = Vector3(0.0, 0.0, 1.0);
-	v1[1].uv = Vector2(1.0, 0.0);
-	
-	v1[2].position = Vector3(1.0, 2.0, 0.0);
-	v1[2].normal = Vector3(0.0, 0.0, 1.0);
-	v1[2].uv = Vector2(0.0, 1.0);
-	//////
-	v2[0].position = Vector3(2.0, 0.0, 10.0);
-	v2[0].normal = Vector3(0.0, 0.0, 1.0);
-	v2[0].uv = Vector2(0.0, 0.0);
+	// Vrtices, normais e coordenadas de textura compartilhados pelos tringulos de cada geometria
+	std::vector<size_t> indices = {0, 1, 2};
+	std::vector<Vector3> normals(3, Vector3(0.0, 0.0, 1.0));
+	std::vector<Vector2> textureCoordinates = {Vector2(0.0, 0.0), Vector2(1.0, 0.0), Vector2(0.0, 1.0)};
 	
-	v2[1].position = Vector3(4.0, 0.0, 10.0);
-	v2[1].normal = Vector3(0.0, 0.0, 1.0);
-	v2[1].uv = Vector2(1.0, 0.0);
+	std::vector<Vector3> v1 = {Vector3(0.0, 0.0, 0.0), Vector3(2.0, 0.0, 0.0), Vector3(1.0, 2.0, 0.0)};
+	std::vector<Vector3> v2 = {Vector3(2.0, 0.0, 10.0), Vector3(4.0, 0.0, 10.0), Vector3(3.0, 2.0, 10.0)};
 	
-	v2[2].position = Vector3(3.0, 2.0, 10.0);
-	v2[2].normal = Vector3(0.0, 0.0, 1.0);
-	v2[2].uv = Vector2(0.0, 1.0);
+	std::shared_ptr<TriangleMesh> m1 = std::make_shared<TriangleMesh>(v1, normals, textureCoordinates, indices, indices, indices);
+	std::shared_ptr<TriangleMesh> m2 = std::make_shared<TriangleMesh>(v2, normals, textureCoordinates, indices, indices, indices);
 	
 	Color3 white(1.0, 1.0, 1.0);
 	BSDF * light = new BSDF (BSDFType::Light, white);
@@ -521,23 +1398,44 @@ int main(int argc, char ** argv) {
 	
 	Color3 red(1.0, 0.0, 0.0);
 	BSDF * diffuse = new BSDF (BSDFType::Diffuse, red);
-	Triangle* t1 = new Triangle(diffuse, v1);
-	Triangle* t2 = new Triangle(light, v2);
-	
-	vector<Triangle*> triangles = {t1,t2};
-
 	
-	Scene scene (triangles);
-	scene.lightGroup.push_back(t2);
+	Scene scene;
+	scene.addMesh(m1, diffuse);
+	scene.addLight(scene.addMesh(m2, light), 0);
 	
 	renderer render(renderoptions, Camera, scene); 
 	
-	Image3 m = render.render();
+	cout << *render.scene.accelerator << endl;
+	
+	size_t start = time();
+	Image3 m;
+	AccumulationBuffer buffer;
+	
+	if (renderoptions.progressive) {
+		// Imagem parcial gravada ao fim de cada passada
+		m = render.renderProgressive(buffer, [&](const Image3 & image, int samples) {
+			cout << "Pass: " << samples << " samples per pixel (" << time() - start << " ms)" << endl;
+			writeImage("progress.ppm",&image);
+		});
+	}
+	else
+		m = render.render();
+	
+	size_t renderTime = time() - start;
+	
+	cout << "Render time: " << renderTime << " ms (" << render.rayCount * 1000 / max(renderTime, size_t(1)) << " rays/s, " << render.threadPool->getThreadCount() << " threads)" << endl;
+	
+	if (renderoptions.progressive) {
+		cout << "Samples: " << buffer.getTotalSampleCount() << " (" << (double)buffer.getTotalSampleCount() / (renderoptions.width * renderoptions.height) << " per pixel)" << endl;
+		
+		// Mapa do nmero de amostras por pixel
+		Image3 sampleCounts;
+		buffer.resolveSampleCounts(sampleCounts);
+		writeImage("samples.ppm",&sampleCounts);
+	}
 	
 	writeImage("output.ppm",&m);
 	
-	delete t1;
-	delete t2;
 	delete diffuse;
 	delete light;
     
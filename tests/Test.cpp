@@ -0,0 +1,98 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+
+#include <iostream>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+size_t failureCount = 0;
+
+}
+
+bool check(bool condition, const char * expression, const char * file, int line) {
+    if (!condition) {
+        failureCount++;
+        std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+    }
+
+    return condition;
+}
+size_t getFailureCount() {
+    return failureCount;
+}
+
+TriangleMesh * createTriangleSoup(size_t triangleCount, uint64_t seed) {
+    PCG32 random(seed);
+
+    TriangleMesh * triangleMesh = new TriangleMesh(3 * triangleCount, triangleCount);
+    double size = 0.5 / std::cbrt((double)triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        Vector3 center(random.nextDouble(), random.nextDouble(), random.nextDouble());
+
+        for (size_t j = 0; j < 3; j++)
+            triangleMesh->setVertex(3 * i + j, center + Vector3(
+                random.nextDouble(), random.nextDouble(), random.nextDouble()) * size);
+
+        triangleMesh->setVertexIndices(i, 3 * i, 3 * i + 1, 3 * i + 2);
+    }
+
+    return triangleMesh;
+}
+std::vector<Ray3> createRays(size_t count, const BoundingBox3 & boundingBox, uint64_t seed) {
+    PCG32 random(seed);
+
+    Vector3 size = boundingBox.max - boundingBox.min;
+    std::vector<Ray3> rays;
+    rays.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Vector3 origin(
+            boundingBox.min.x + size.x * (2.0 * random.nextDouble() - 0.5),
+            boundingBox.min.y + size.y * (2.0 * random.nextDouble() - 0.5),
+            boundingBox.min.z - size.z);
+        Vector3 target(
+            boundingBox.min.x + size.x * random.nextDouble(),
+            boundingBox.min.y + size.y * random.nextDouble(),
+            boundingBox.min.z + size.z * random.nextDouble());
+
+        rays.push_back(Ray3(origin, (target - origin).normalize()));
+    }
+
+    return rays;
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,70 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Evita redefinio de smbolos do arquivo de cabealho (caso j tenha sido includo)
+#ifndef AURORA_TEST_H
+#define AURORA_TEST_H
+
+#include <aurora/Global.h>
+#include <aurora/Ray.h>
+#include <aurora/BoundingBox.h>
+
+#include <vector>
+#include <cstdint>
+
+// Verifica condio e registra falha com expresso, arquivo e linha
+#define AURORA_CHECK(condition) aurora::check((condition), #condition, __FILE__, __LINE__)
+
+// Incio de "namespace" da biblioteca
+AURORA_NAMESPACE_BEGIN
+
+// Declarao de tipo incompleto no cabealho evita dependncia cclica de arquivos
+class TriangleMesh;
+
+// Registra resultado de verificao (imprime falha) e retorna condio
+bool check(bool condition, const char * expression, const char * file, int line);
+// Retorna nmero de falhas registradas
+size_t getFailureCount();
+
+// Cria "sopa" de tringulos aleatrios em [0, 1]^3 (lado proporcional ao espaamento mdio, sem vrtices compartilhados)
+TriangleMesh * createTriangleSoup(size_t triangleCount, uint64_t seed = 1);
+// Cria raios de um plano abaixo da caixa (em "z") em direo a pontos aleatrios dentro dela
+std::vector<Ray3> createRays(size_t count, const BoundingBox3 & boundingBox, uint64_t seed = 2);
+
+// Testes (cada um registra suas falhas)
+void testInstanceBVH();
+void testBVHUpdate();
+void testBVHCache();
+void testTriangleBlocks();
+void testWatertight();
+void testBVHDepth();
+void testQuantizedBVH();
+
+// Fim de "namespace" da biblioteca
+AURORA_NAMESPACE_END
+
+#endif
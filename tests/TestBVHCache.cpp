@@ -0,0 +1,279 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/BVHCache.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+
+#include <memory>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+const char * cacheFilename = "test_cache.bvh";
+const char * corruptFilename = "test_cache_corrupt.bvh";
+const char * acceleratorFilename = "test_cache_accelerator.bvh";
+
+// Posio dos ns no arquivo (cabealho de 80 bytes alinhado em 64) e dos campos de cada n
+const size_t nodeOffset = 128;
+const size_t nodeSize = 64;
+const size_t nodeOffsetField = 48;
+const size_t nodeCountField = 52;
+
+// Retorna contedo do arquivo
+std::string readFile(const std::string & filename) {
+    std::ifstream file(filename, std::ifstream::in | std::ifstream::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    return contents.str();
+}
+// Escreve contedo no arquivo
+void writeFile(const std::string & filename, const std::string & contents) {
+    std::ofstream file(filename, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    file.write(contents.data(), contents.size());
+}
+// L campo de 32 bits do n no contedo do arquivo
+uint32_t readNodeField(const std::string & contents, size_t node, size_t field) {
+    uint32_t value;
+    std::memcpy(&value, contents.data() + nodeOffset + node * nodeSize + field, sizeof(value));
+
+    return value;
+}
+// Retorna cpia do contedo com campo de 32 bits do n alterado
+std::string writeNodeField(const std::string & contents, size_t node, size_t field, uint32_t value) {
+    std::string modified = contents;
+    std::memcpy(&modified[nodeOffset + node * nodeSize + field], &value, sizeof(value));
+
+    return modified;
+}
+
+}
+
+// Cache em disco: ida e volta com mesmas intersees e ocluses da BVH em memria, carga na BVH e na
+// estrutura de acelerao, rejeio de hash diferente, arquivos truncados, vazios, inexistentes, com
+// cabealho corrompido e com ns fora dos limites
+void testBVHCache() {
+    std::unique_ptr<TriangleMesh> triangleMesh(createTriangleSoup(20000));
+    BVH bvh(triangleMesh.get());
+
+    uint64_t hash = BVHCache::computeHash(triangleMesh.get());
+    AURORA_CHECK(hash != 0);
+    AURORA_CHECK(BVHCache::write(cacheFilename, bvh, hash));
+
+    std::string contents = readFile(cacheFilename);
+
+    // Ida e volta
+    BVHCache bvhCache;
+    AURORA_CHECK(!bvhCache.isOpen());
+    AURORA_CHECK(bvhCache.open(cacheFilename, hash));
+    AURORA_CHECK(bvhCache.isOpen());
+    AURORA_CHECK(bvhCache.getHash() == hash);
+    AURORA_CHECK(bvhCache.getTriangleCount() == triangleMesh->getTriangleCount());
+    AURORA_CHECK(bvhCache.getNodeCount() == bvh.getNodeCount());
+    AURORA_CHECK(bvhCache.getSize() == contents.size());
+
+    std::vector<Ray3> rays = createRays(20000, bvh.getBoundingBox());
+    size_t hitCount = 0, mismatchCount = 0;
+
+    for (const Ray3 & ray : rays) {
+        RayHit bvhHit, cacheHit;
+        bool hit = bvh.intersect(ray, bvhHit);
+
+        hitCount += hit;
+        mismatchCount += bvhCache.intersect(ray, cacheHit) != hit ||
+            cacheHit.index != bvhHit.index || cacheHit.distance != bvhHit.distance ||
+            bvhCache.occluded(ray) != bvh.occluded(ray);
+    }
+
+    AURORA_CHECK(hitCount > 0);
+    AURORA_CHECK(mismatchCount == 0);
+
+    // Hierarquia carregada na BVH: mesmos ns, referncias e resultados da construda
+    std::unique_ptr<TriangleMesh> otherMesh(createTriangleSoup(1000));
+    BVH loadedBVH;
+    AURORA_CHECK(!loadedBVH.load(otherMesh.get(), bvhCache));
+    AURORA_CHECK(loadedBVH.load(triangleMesh.get(), bvhCache));
+    AURORA_CHECK(loadedBVH.getNodeCount() == bvh.getNodeCount());
+    AURORA_CHECK(loadedBVH.getIndices() == bvh.getIndices());
+    AURORA_CHECK(loadedBVH.getCost() == bvh.getCost());
+
+    size_t nodeMismatchCount = 0;
+
+    for (size_t i = 0; i < bvh.getNodeCount(); i++) {
+        const BVHNode & node = bvh.getNodes()[i];
+        const BVHNode & loadedNode = loadedBVH.getNodes()[i];
+
+        nodeMismatchCount += loadedNode.offset != node.offset || loadedNode.count != node.count ||
+            loadedNode.axis != node.axis || loadedNode.boundingBox != node.boundingBox;
+    }
+
+    AURORA_CHECK(nodeMismatchCount == 0);
+
+    mismatchCount = 0;
+
+    for (const Ray3 & ray : rays) {
+        RayHit bvhHit, loadedHit;
+        bool hit = bvh.intersect(ray, bvhHit);
+
+        mismatchCount += loadedBVH.intersect(ray, loadedHit) != hit ||
+            loadedHit.index != bvhHit.index || loadedHit.distance != bvhHit.distance ||
+            loadedBVH.occluded(ray) != bvh.occluded(ray);
+    }
+
+    AURORA_CHECK(mismatchCount == 0);
+
+    bvhCache.close();
+    AURORA_CHECK(!bvhCache.isOpen());
+
+    // Hash zero aceita o arquivo sem verificar a geometria
+    AURORA_CHECK(bvhCache.open(cacheFilename));
+    AURORA_CHECK(bvhCache.getHash() == hash);
+
+    // Geometria alterada (um nico vrtice) gera outro hash, rejeitado pelo cache
+    TriangleMesh modifiedMesh(*triangleMesh);
+    modifiedMesh.setVertex(0, modifiedMesh.getVertex(0) + Vector3(1e-12, 0.0, 0.0));
+
+    uint64_t modifiedHash = BVHCache::computeHash(&modifiedMesh);
+    AURORA_CHECK(modifiedHash != hash);
+    AURORA_CHECK(!bvhCache.open(cacheFilename, modifiedHash));
+    AURORA_CHECK(!bvhCache.isOpen());
+
+    // Arquivos truncados (no cabealho, nas sees e no ltimo byte)
+    size_t sizes[] = {1, 16, contents.size() / 3, contents.size() / 2, contents.size() - 1};
+
+    for (size_t size : sizes) {
+        writeFile(corruptFilename, contents.substr(0, size));
+        AURORA_CHECK(!bvhCache.open(corruptFilename, hash));
+        AURORA_CHECK(!bvhCache.open(corruptFilename));
+        AURORA_CHECK(!bvhCache.isOpen());
+    }
+
+    // Arquivo vazio e arquivo inexistente
+    writeFile(corruptFilename, std::string());
+    AURORA_CHECK(!bvhCache.open(corruptFilename));
+
+    std::remove(corruptFilename);
+    AURORA_CHECK(!bvhCache.open(corruptFilename));
+
+    // Cabealho corrompido (identificador do formato)
+    std::string corrupt = contents;
+    corrupt[0] ^= 0x5A;
+
+    writeFile(corruptFilename, corrupt);
+    AURORA_CHECK(!bvhCache.open(corruptFilename));
+
+    // Ns com filho ou referncias fora dos limites (raiz interna; primeira folha)
+    size_t leaf = 0;
+
+    while (readNodeField(contents, leaf, nodeCountField) == 0)
+        leaf++;
+
+    uint32_t nodeCount = (uint32_t)bvh.getNodeCount();
+    uint32_t referenceCount = (uint32_t)bvh.getIndices().size();
+    uint32_t leafCount = readNodeField(contents, leaf, nodeCountField);
+
+    std::string corruptNodes[] = {
+        writeNodeField(contents, 0, nodeOffsetField, nodeCount),
+        writeNodeField(contents, 0, nodeOffsetField, 0),
+        writeNodeField(contents, 0, nodeOffsetField, 1),
+        writeNodeField(contents, leaf, nodeOffsetField, referenceCount),
+        writeNodeField(contents, leaf, nodeOffsetField, referenceCount - leafCount + 1),
+        writeNodeField(contents, leaf, nodeCountField, referenceCount + 1),
+        writeNodeField(contents, leaf, nodeOffsetField, 0xFFFFFFFF)
+    };
+
+    for (const std::string & corruptNode : corruptNodes) {
+        writeFile(corruptFilename, corruptNode);
+        AURORA_CHECK(!bvhCache.open(corruptFilename, hash));
+        AURORA_CHECK(!bvhCache.isOpen());
+    }
+
+    // Cache fechado no intersecta nem oclui
+    RayHit rayHit;
+    AURORA_CHECK(!bvhCache.intersect(rays[0], rayHit));
+    AURORA_CHECK(!bvhCache.occluded(rays[0]));
+    AURORA_CHECK(!loadedBVH.load(triangleMesh.get(), bvhCache));
+
+    // Arquivo vlido abre novamente aps falhas
+    AURORA_CHECK(bvhCache.open(cacheFilename, hash));
+
+    bvhCache.close();
+
+    // Estrutura de acelerao: primeira construo escreve o cache, segunda o carrega com mesmos resultados
+    std::remove(acceleratorFilename);
+
+    std::shared_ptr<BVHAccelerator> built = std::dynamic_pointer_cast<BVHAccelerator>(createAccelerator(
+        triangleMesh.get(), AcceleratorType::BVH, BVHBuildMethod::BinnedSAH, 4, acceleratorFilename));
+    std::shared_ptr<BVHAccelerator> loaded = std::dynamic_pointer_cast<BVHAccelerator>(createAccelerator(
+        triangleMesh.get(), AcceleratorType::BVH, BVHBuildMethod::BinnedSAH, 4, acceleratorFilename));
+
+    AURORA_CHECK(built && !built->isCached());
+    AURORA_CHECK(loaded && loaded->isCached());
+
+    if (built && loaded) {
+        AURORA_CHECK(loaded->getWideBVH().getNodeCount() == built->getWideBVH().getNodeCount());
+
+        mismatchCount = 0;
+
+        for (const Ray3 & ray : rays) {
+            RayHit builtHit, loadedHit;
+            bool hit = built->intersect(ray, builtHit);
+
+            mismatchCount += loaded->intersect(ray, loadedHit) != hit ||
+                loadedHit.index != builtHit.index || loadedHit.distance != builtHit.distance ||
+                loaded->occluded(ray) != built->occluded(ray);
+        }
+
+        AURORA_CHECK(mismatchCount == 0);
+    }
+
+    // Cache de outra geometria  substitudo pela nova construo
+    std::shared_ptr<BVHAccelerator> other = std::dynamic_pointer_cast<BVHAccelerator>(createAccelerator(
+        otherMesh.get(), AcceleratorType::BVH, BVHBuildMethod::BinnedSAH, 4, acceleratorFilename));
+
+    AURORA_CHECK(other && !other->isCached());
+    AURORA_CHECK(bvhCache.open(acceleratorFilename, BVHCache::computeHash(otherMesh.get())));
+
+    bvhCache.close();
+
+    std::remove(acceleratorFilename);
+    std::remove(corruptFilename);
+    std::remove(cacheFilename);
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,116 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/TriangleMesh.h>
+
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Retorna profundidade mxima da hierarquia (filho esquerdo seguinte ao pai, direito em "offset")
+size_t getMaximumDepth(const BVH & bvh) {
+    const std::vector<BVHNode> & nodes = bvh.getNodes();
+
+    std::vector<std::pair<size_t, size_t> > stack;
+    stack.push_back(std::make_pair(size_t(0), size_t(0)));
+
+    size_t maximumDepth = 0;
+
+    while (!stack.empty()) {
+        size_t node = stack.back().first;
+        size_t depth = stack.back().second;
+        stack.pop_back();
+
+        maximumDepth = std::max(maximumDepth, depth);
+
+        if (!nodes[node].isLeaf()) {
+            stack.push_back(std::make_pair(node + 1, depth + 1));
+            stack.push_back(std::make_pair(nodes[node].offset, depth + 1));
+        }
+    }
+
+    return maximumDepth;
+}
+
+}
+
+// Geometria degenerada (tringulos perpendiculares a "x" em x = 2^i): divises SAH isolam um tringulo
+// por nvel, ento a profundidade deve ser limitada em todos os construtores para caber na pilha de travessia
+void testBVHDepth() {
+    const size_t triangleCount = 900;
+
+    std::vector<Vector3> vertices;
+    std::vector<size_t> vertexIndices;
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        double x = std::ldexp(1.0, (int)i);
+
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(x, 0, 0));
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(x, 1, 0));
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(x, 0, 1));
+    }
+
+    TriangleMesh triangleMesh(vertices, vertexIndices);
+
+    const BVHBuildMethod buildMethods[] = {
+        BVHBuildMethod::SweepSAH, BVHBuildMethod::BinnedSAH, BVHBuildMethod::Linear,
+        BVHBuildMethod::HierarchicalLinear, BVHBuildMethod::SpatialSAH
+    };
+
+    double last = std::ldexp(1.0, (int)triangleCount);
+
+    for (BVHBuildMethod buildMethod : buildMethods) {
+        BVH bvh(&triangleMesh, buildMethod);
+
+        // Pilha de travessia com 128 entradas (uma por nvel no pior caso)
+        AURORA_CHECK(getMaximumDepth(bvh) < 128);
+
+        // Raios ao longo de "x" atravessam todos os nveis
+        RayHit hit;
+        AURORA_CHECK(bvh.intersect(Ray3(Vector3(0.5, 0.25, 0.25), Vector3(1, 0, 0)), hit));
+        AURORA_CHECK(hit.index == 0);
+
+        AURORA_CHECK(bvh.intersect(Ray3(Vector3(last, 0.25, 0.25), Vector3(-1, 0, 0)), hit));
+        AURORA_CHECK(hit.index == triangleCount - 1);
+
+        // Dentro das caixas e fora dos tringulos ("y + z > 1"): visita a hierarquia inteira sem impacto
+        AURORA_CHECK(!bvh.intersect(Ray3(Vector3(0.5, 0.75, 0.75), Vector3(1, 0, 0)), hit));
+        AURORA_CHECK(!bvh.occluded(Ray3(Vector3(0.5, 0.75, 0.75), Vector3(1, 0, 0))));
+        AURORA_CHECK(bvh.occluded(Ray3(Vector3(0.5, 0.25, 0.25), Vector3(1, 0, 0))));
+    }
+}
+
+AURORA_NAMESPACE_END
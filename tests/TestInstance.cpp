@@ -0,0 +1,117 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/Matrix.h>
+#include <aurora/BVH.h>
+#include <aurora/Instance.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+#include <aurora/Math.h>
+
+#include <memory>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+// Compara InstanceBVH com uma BVH sobre a geometria achatada (cpias transformadas das instncias):
+// mesma interseo mais prxima (instncia, tringulo e distncia) para raios aleatrios
+void testInstanceBVH() {
+    const size_t instanceCount = 200;
+    const size_t rayCount = 20000;
+
+    std::unique_ptr<TriangleMesh> triangleMesh(createTriangleSoup(500));
+    size_t triangleCount = triangleMesh->getTriangleCount();
+    size_t vertexCount = triangleMesh->getVertexCount();
+
+    BVH bvh(triangleMesh.get());
+    InstanceBVH instanceBVH;
+
+    // Caso vazio: hierarquia de topo sem instncias no intersecta
+    instanceBVH.build();
+
+    RayHit emptyHit;
+    AURORA_CHECK(!instanceBVH.intersect(Ray3(Vector3(), Vector3(0.0, 0.0, 1.0)), emptyHit));
+
+    TriangleMesh flattenedMesh(instanceCount * vertexCount, instanceCount * triangleCount);
+    PCG32 random(3);
+
+    for (size_t i = 0; i < instanceCount; i++) {
+        Matrix4 transform;
+        transform.setTransformation(
+            Vector3(random.nextDouble(), random.nextDouble(), random.nextDouble()) * 4.0,
+            Vector3(random.nextDouble(), random.nextDouble(), random.nextDouble()) * AURORA_PI * 2.0,
+            Vector3(1.0, 1.0, 1.0) * (0.5 + random.nextDouble()),
+            Vector3());
+
+        AURORA_CHECK(instanceBVH.addInstance(&bvh, transform) == i);
+
+        // Vrtices em espao de mundo na mesma conveno "v * M" das instncias
+        for (size_t j = 0; j < vertexCount; j++)
+            flattenedMesh.setVertex(i * vertexCount + j, triangleMesh->getVertex(j) * transform);
+
+        for (size_t j = 0; j < triangleCount; j++) {
+            size_t v0, v1, v2;
+            triangleMesh->getVertexIndices(j, v0, v1, v2);
+
+            flattenedMesh.setVertexIndices(i * triangleCount + j,
+                i * vertexCount + v0, i * vertexCount + v1, i * vertexCount + v2);
+        }
+    }
+
+    instanceBVH.build();
+    BVH flattenedBVH(&flattenedMesh);
+
+    AURORA_CHECK(instanceBVH.getInstanceCount() == instanceCount);
+    AURORA_CHECK(instanceBVH.getBVH().getBoundingBox().min.x <= flattenedBVH.getBoundingBox().min.x);
+    AURORA_CHECK(instanceBVH.getBVH().getBoundingBox().max.x >= flattenedBVH.getBoundingBox().max.x);
+
+    std::vector<Ray3> rays = createRays(rayCount, flattenedBVH.getBoundingBox());
+    size_t hitCount = 0, mismatchCount = 0;
+
+    for (const Ray3 & ray : rays) {
+        RayHit instanceHit, flattenedHit;
+        bool instanceResult = instanceBVH.intersect(ray, instanceHit);
+        bool flattenedResult = flattenedBVH.intersect(ray, flattenedHit);
+
+        hitCount += flattenedResult;
+
+        if (instanceResult != flattenedResult)
+            mismatchCount++;
+        else if (flattenedResult && (
+            instanceHit.instance * triangleCount + instanceHit.index != flattenedHit.index ||
+            std::abs(instanceHit.distance - flattenedHit.distance) > 1e-9 * flattenedHit.distance))
+            mismatchCount++;
+    }
+
+    AURORA_CHECK(hitCount > rayCount / 4);
+    AURORA_CHECK(mismatchCount == 0);
+}
+
+AURORA_NAMESPACE_END
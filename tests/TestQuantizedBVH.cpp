@@ -0,0 +1,106 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/WideBVH.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+
+#include <memory>
+
+AURORA_NAMESPACE_BEGIN
+
+// Folhas com mais de 255 tringulos (centros coincidentes e tamanho mximo de folha alto): hierarquia
+// quantizada deve dividi-las em ns adicionais e manter resultados iguais  fora bruta
+void testQuantizedBVH() {
+    const size_t soupCount = 2000;
+    const size_t nestedCount = 600;
+    const size_t rayCount = 4000;
+
+    std::unique_ptr<TriangleMesh> soup(createTriangleSoup(soupCount));
+
+    std::vector<Vector3> vertices = soup->getVertices();
+    std::vector<size_t> vertexIndices = soup->getVertexIndices();
+
+    // Tringulos em planos paralelos "x + y + z = 1.5 + s" com caixas centradas em (0.5, 0.5, 0.5)
+    for (size_t i = 0; i < nestedCount; i++) {
+        double s = (i + 1) / 2048.0;
+
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(0.5 + s, 0.5 + s, 0.5 - s));
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(0.5 - s, 0.5 + s, 0.5 + s));
+        vertexIndices.push_back(vertices.size());
+        vertices.push_back(Vector3(0.5 + s, 0.5 - s, 0.5 + s));
+    }
+
+    TriangleMesh triangleMesh(vertices, vertexIndices);
+
+    BVH bvh(&triangleMesh, BVHBuildMethod::BinnedSAH, 1024);
+
+    size_t largestLeaf = 0;
+
+    for (const BVHNode & node : bvh.getNodes())
+        if (node.isLeaf())
+            largestLeaf = std::max(largestLeaf, node.count);
+
+    AURORA_CHECK(largestLeaf > 255);
+
+    BoundingBox3 boundingBox = bvh.getBoundingBox();
+    std::vector<Ray3> rays = createRays(rayCount, boundingBox);
+
+    BruteForceAccelerator bruteForce;
+    bruteForce.build(&triangleMesh);
+
+    for (size_t width : {4, 8}) {
+        QuantizedBVH quantizedBVH(bvh, width);
+
+        AURORA_CHECK(quantizedBVH.getNodeCount() > 0);
+
+        size_t mismatchCount = 0, hitCount = 0;
+
+        for (const Ray3 & ray : rays) {
+            RayHit quantizedHit, bruteForceHit;
+            bool hit = bruteForce.intersect(ray, bruteForceHit);
+
+            hitCount += hit;
+
+            if (quantizedBVH.intersect(ray, quantizedHit) != hit
+                || (hit && (quantizedHit.index != bruteForceHit.index || quantizedHit.distance != bruteForceHit.distance))
+                || quantizedBVH.occluded(ray) != bruteForce.occluded(ray))
+                mismatchCount++;
+        }
+
+        AURORA_CHECK(hitCount > 0);
+        AURORA_CHECK(mismatchCount == 0);
+    }
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,183 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/BVH.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Random.h>
+
+#include <memory>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Retorna nmero de raios em que a hierarquia diverge da fora bruta (tringulo mais prximo e ocluso)
+size_t countMismatches(const BVH & bvh, const TriangleMesh * triangleMesh, const std::vector<Ray3> & rays) {
+    BruteForceAccelerator bruteForce;
+    bruteForce.build(triangleMesh);
+
+    size_t mismatchCount = 0;
+
+    for (const Ray3 & ray : rays) {
+        RayHit bvhHit, bruteForceHit;
+        bool hit = bruteForce.intersect(ray, bruteForceHit);
+
+        if (bvh.intersect(ray, bvhHit) != hit || bvhHit.index != bruteForceHit.index) {
+            mismatchCount++;
+            continue;
+        }
+
+        // Ocluso limitada  metade da distncia do primeiro impacto (ou a uma distncia fixa sem impacto)
+        Ray3 shadowRay(ray.origin, ray.direction, ray.minimum, hit ? 0.5 * bruteForceHit.distance + 0.05 : 1.5);
+
+        if (bvh.occluded(shadowRay) != bruteForce.occluded(shadowRay))
+            mismatchCount++;
+    }
+
+    return mismatchCount;
+}
+
+// Desloca os vrtices da geometria original por uma onda suave (deformao pequena e coerente)
+void deform(TriangleMesh & triangleMesh, const TriangleMesh & original, double amplitude, double phase) {
+    for (size_t i = 0; i < original.getVertexCount(); i++) {
+        const Vector3 & vertex = original.getVertex(i);
+
+        triangleMesh.setVertex(i, vertex + Vector3(
+            std::sin(6.0 * vertex.y + phase), std::sin(6.0 * vertex.z + phase), std::sin(6.0 * vertex.x + phase)) * amplitude);
+    }
+}
+
+// Move cada tringulo inteiro para uma posio aleatria (topologia inalterada, hierarquia degradada)
+void scramble(TriangleMesh & triangleMesh, uint64_t seed) {
+    PCG32 random(seed);
+
+    for (size_t i = 0; i < triangleMesh.getTriangleCount(); i++) {
+        size_t v[3];
+        triangleMesh.getVertexIndices(i, v[0], v[1], v[2]);
+
+        Vector3 offset = Vector3(random.nextDouble(), random.nextDouble(), random.nextDouble()) - triangleMesh.getVertex(v[0]);
+
+        for (size_t j = 0; j < 3; j++)
+            triangleMesh.setVertex(v[j], triangleMesh.getVertex(v[j]) + offset);
+    }
+}
+
+}
+
+// Geometria deformvel: aps alterar vrtices, "update" deve manter resultados iguais  fora bruta
+// e escolher reajuste (deformao pequena) ou reconstruo (custo SAH degradado alm do limite)
+void testBVHUpdate() {
+    const size_t rayCount = 2000;
+
+    std::unique_ptr<TriangleMesh> original(createTriangleSoup(5000));
+    TriangleMesh triangleMesh(*original);
+
+    BVH bvh(&triangleMesh);
+    BoundingBox3 boundingBox = bvh.getBoundingBox();
+
+    boundingBox.min -= Vector3(0.2, 0.2, 0.2);
+    boundingBox.max += Vector3(0.2, 0.2, 0.2);
+
+    std::vector<Ray3> rays = createRays(rayCount, boundingBox);
+    double buildCost = bvh.getBuildCost();
+
+    AURORA_CHECK(countMismatches(bvh, &triangleMesh, rays) == 0);
+    AURORA_CHECK(std::abs(bvh.getCost() - buildCost) <= 1e-9 * buildCost);
+
+    // Deformao pequena: apenas reajuste (ndices e custo de referncia inalterados)
+    for (size_t frame = 1; frame <= 3; frame++) {
+        std::vector<size_t> indices = bvh.getIndices();
+
+        deform(triangleMesh, *original, 0.002, 0.5 * frame);
+        bvh.update();
+
+        AURORA_CHECK(bvh.getIndices() == indices);
+        AURORA_CHECK(bvh.getBuildCost() == buildCost);
+        AURORA_CHECK(bvh.getCost() <= buildCost * bvh.getRebuildThreshold());
+        AURORA_CHECK(countMismatches(bvh, &triangleMesh, rays) == 0);
+    }
+
+    // Reajuste explcito aps deformao grande: resultados corretos, mas custo alm do limite
+    scramble(triangleMesh, 5);
+
+    BVH refitBVH(bvh);
+    refitBVH.refit();
+
+    AURORA_CHECK(refitBVH.getIndices() == bvh.getIndices());
+    AURORA_CHECK(refitBVH.getCost() > buildCost * refitBVH.getRebuildThreshold());
+    AURORA_CHECK(countMismatches(refitBVH, &triangleMesh, rays) == 0);
+
+    // Limite muito alto: "update" apenas reajusta mesmo com a hierarquia degradada
+    BVH tolerantBVH(bvh);
+    tolerantBVH.setRebuildThreshold(1e9).update();
+
+    AURORA_CHECK(tolerantBVH.getIndices() == bvh.getIndices());
+    AURORA_CHECK(tolerantBVH.getBuildCost() == buildCost);
+    AURORA_CHECK(countMismatches(tolerantBVH, &triangleMesh, rays) == 0);
+
+    // Limite padro: degradao espalhada por toda a hierarquia dispara reconstruo completa
+    std::vector<size_t> indices = bvh.getIndices();
+    bvh.update();
+
+    AURORA_CHECK(bvh.getIndices() != indices);
+    AURORA_CHECK(bvh.getCost() == bvh.getBuildCost());
+    AURORA_CHECK(bvh.getCost() < refitBVH.getCost());
+    AURORA_CHECK(countMismatches(bvh, &triangleMesh, rays) == 0);
+
+    // Degradao local (40 tringulos das primeiras folhas, mesma subrvore, espalhados pela caixa):
+    // reconstruo parcial apenas das subrvores degradadas (custo de referncia inalterado)
+    buildCost = bvh.getBuildCost();
+    indices = bvh.getIndices();
+    PCG32 random(7);
+
+    for (size_t i = 0; i < 40; i++) {
+        size_t v[3];
+        triangleMesh.getVertexIndices(indices[i], v[0], v[1], v[2]);
+
+        Vector3 offset = Vector3(random.nextDouble(), random.nextDouble(), random.nextDouble()) - triangleMesh.getVertex(v[0]);
+
+        for (size_t j = 0; j < 3; j++)
+            triangleMesh.setVertex(v[j], triangleMesh.getVertex(v[j]) + offset);
+    }
+
+    BVH localRefitBVH(bvh);
+    localRefitBVH.refit();
+    bvh.update();
+
+    AURORA_CHECK(localRefitBVH.getCost() > buildCost * localRefitBVH.getRebuildThreshold());
+    AURORA_CHECK(bvh.getIndices() != indices);
+    AURORA_CHECK(bvh.getBuildCost() == buildCost);
+    AURORA_CHECK(bvh.getCost() <= buildCost * bvh.getRebuildThreshold());
+    AURORA_CHECK(countMismatches(bvh, &triangleMesh, rays) == 0);
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,94 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/WideBVH.h>
+#include <aurora/Random.h>
+
+#include <vector>
+
+AURORA_NAMESPACE_BEGIN
+
+// Teste vetorial de blocos de tringulos (largura do conjunto de instrues da compilao) contra a
+// referncia escalar: mesmo tringulo mais prximo, distncia e coordenadas baricntricas idnticas
+// (mesma aritmtica) para blocos e raios aleatrios, contagens que no completam a janela e intervalos
+// de raio limitados
+void testTriangleBlocks() {
+    PCG32 random(5);
+
+    const size_t setCount = 512, setSize = 36;
+    std::vector<TriangleBlock> blocks(setCount * setSize / 4, TriangleBlock());
+
+    for (TriangleBlock & block : blocks)
+        for (size_t lane = 0; lane < 4; lane++)
+            for (size_t k = 0; k < 3; k++) {
+                block.vertex[k][lane] = (float)random.nextDouble();
+                block.edges[k][lane] = (float)(random.nextDouble() - 0.5) * 0.6f;
+                block.edges[k + 3][lane] = (float)(random.nextDouble() - 0.5) * 0.6f;
+            }
+
+    std::vector<Ray3> rays;
+
+    for (size_t i = 0; i < 256; i++) {
+        Vector3 origin = i % 2 == 0 ?
+            Vector3(random.nextDouble(), random.nextDouble(), -1.0) :
+            Vector3(random.nextDouble(), random.nextDouble(), random.nextDouble());
+        Vector3 target(random.nextDouble(), random.nextDouble(), random.nextDouble());
+        double maximum = i % 3 == 0 ? 0.5 + random.nextDouble() : AURORA_INFINITY;
+
+        rays.push_back(Ray3(origin, (target - origin).normalize(), AURORA_EPSILON, maximum));
+    }
+
+    size_t counts[] = {1, 3, 4, 5, 8, 11, 12, 16, 17, 24, 31, 36};
+    size_t hitCount = 0, mismatchCount = 0;
+
+    for (size_t s = 0; s < setCount; s++)
+        for (size_t r = 0; r < 32; r++)
+            for (size_t count : counts) {
+                const TriangleBlock * set = &blocks[s * setSize / 4];
+                const Ray3 & ray = rays[(s + 7 * r) % rays.size()];
+
+                float distance = 0, u = 0, v = 0;
+                float referenceDistance = 0, referenceU = 0, referenceV = 0;
+
+                int closest = intersectTriangleBlocks(set, count, ray, distance, u, v);
+                int reference = intersectTriangleBlocksReference(set, count, ray,
+                    referenceDistance, referenceU, referenceV);
+
+                hitCount += reference >= 0;
+                mismatchCount += closest != reference || (reference >= 0 && (distance != referenceDistance ||
+                    u != referenceU || v != referenceV));
+            }
+
+    AURORA_CHECK(getTriangleBlockWidth() == 4 || getTriangleBlockWidth() == 8 || getTriangleBlockWidth() == 16);
+    AURORA_CHECK(hitCount > 0);
+    AURORA_CHECK(mismatchCount == 0);
+}
+
+AURORA_NAMESPACE_END
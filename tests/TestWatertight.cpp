@@ -0,0 +1,184 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <aurora/Vector.h>
+#include <aurora/Accelerator.h>
+#include <aurora/TriangleMesh.h>
+#include <aurora/Utility.h>
+#include <aurora/Random.h>
+
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+AURORA_NAMESPACE_BEGIN
+
+namespace {
+
+// Cria icosfera subdividida "levels" vezes (malha fechada com vrtices compartilhados entre tringulos vizinhos),
+// com deslocamento e escala irregulares (coordenadas no representveis exatamente)
+TriangleMesh * createIcosphere(size_t levels, const Vector3 & center, const Vector3 & scale) {
+    double t = (1.0 + std::sqrt(5.0)) / 2.0;
+    double points[12][3] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    size_t faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6},
+        {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10},
+        {8, 6, 7}, {9, 8, 1}
+    };
+
+    std::vector<Vector3> vertices;
+    std::vector<size_t> vertexIndices;
+
+    for (const double (&point)[3] : points)
+        vertices.push_back(Vector3(point[0], point[1], point[2]).normalize());
+
+    for (const size_t (&face)[3] : faces)
+        vertexIndices.insert(vertexIndices.end(), {face[0], face[1], face[2]});
+
+    for (size_t level = 0; level < levels; level++) {
+        std::map<std::pair<size_t, size_t>, size_t> midpoints;
+        std::vector<size_t> subdivided;
+
+        // Retorna vrtice do ponto mdio da aresta (compartilhado pelos dois tringulos vizinhos)
+        auto midpoint = [&](size_t a, size_t b) {
+            std::pair<size_t, size_t> edge(std::min(a, b), std::max(a, b));
+            std::map<std::pair<size_t, size_t>, size_t>::iterator it = midpoints.find(edge);
+
+            if (it != midpoints.end())
+                return it->second;
+
+            vertices.push_back(((vertices[a] + vertices[b]) * 0.5).normalize());
+
+            return midpoints[edge] = vertices.size() - 1;
+        };
+
+        for (size_t i = 0; i < vertexIndices.size(); i += 3) {
+            size_t a = vertexIndices[i], b = vertexIndices[i + 1], c = vertexIndices[i + 2];
+            size_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+
+            subdivided.insert(subdivided.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+
+        vertexIndices.swap(subdivided);
+    }
+
+    TriangleMesh * triangleMesh = new TriangleMesh(vertices, vertexIndices);
+
+    for (size_t i = 0; i < vertices.size(); i++)
+        triangleMesh->setVertex(i, Vector3(vertices[i].x * scale.x, vertices[i].y * scale.y,
+            vertices[i].z * scale.z) + center);
+
+    return triangleMesh;
+}
+
+}
+
+// Malha fechada sem frestas: raios de pontos internos na direo de vrtices, pontos de arestas e
+// interiores de tringulos devem todos intersectar a icosfera (consulta mais prxima, ocluso e pacotes)
+// com o teste estanque em todas as estruturas de acelerao
+void testWatertight() {
+    Vector3 center(10.37, -5.11, 0.731), scale(3.1, 2.7, 1.9);
+    std::unique_ptr<TriangleMesh> triangleMesh(createIcosphere(5, center, scale));
+
+    size_t triangleCount = triangleMesh->getTriangleCount();
+    PCG32 random(3);
+    std::vector<Ray3> rays;
+
+    for (size_t i = 0; i < 60000; i++) {
+        Vector3 origin = center + Vector3(random.nextDouble() - 0.5, random.nextDouble() - 0.5,
+            random.nextDouble() - 0.5) * 1.2;
+
+        size_t v0, v1, v2;
+        triangleMesh->getVertexIndices(random.nextUInt() % triangleCount, v0, v1, v2);
+
+        const Vector3 & a = triangleMesh->getVertex(v0);
+        const Vector3 & b = triangleMesh->getVertex(v1);
+        const Vector3 & c = triangleMesh->getVertex(v2);
+        double s = random.nextDouble(), r = random.nextDouble();
+
+        if (s + r > 1.0)
+            s = 1.0 - s, r = 1.0 - r;
+
+        // Vrtices, pontos de arestas e pontos interiores, alternados
+        Vector3 target = i % 3 == 0 ? a : i % 3 == 1 ? a * s + b * (1.0 - s) : a * (1.0 - s - r) + b * s + c * r;
+
+        rays.push_back(Ray3(origin, (target - origin).normalize()));
+    }
+
+    TriangleIntersection previous = getTriangleIntersection();
+    setTriangleIntersection(TriangleIntersection::Watertight);
+
+    struct configuration {
+        AcceleratorType type;
+        size_t width;
+        size_t rayCount; // Fora bruta testa todos os tringulos por raio (apenas parte dos raios)
+    } configurations[] = {
+        {AcceleratorType::BruteForce, 2, 1500},
+        {AcceleratorType::UniformGrid, 2, rays.size()},
+        {AcceleratorType::BVH, 2, rays.size()},
+        {AcceleratorType::BVH, 4, rays.size()},
+        {AcceleratorType::BVH, 8, rays.size()},
+        {AcceleratorType::QuantizedBVH, 4, rays.size()},
+        {AcceleratorType::QuantizedBVH, 8, rays.size()}
+    };
+
+    for (const configuration & c : configurations) {
+        std::shared_ptr<Accelerator> accelerator = createAccelerator(triangleMesh.get(), c.type,
+            BVHBuildMethod::BinnedSAH, c.width);
+
+        size_t missCount = 0, unoccludedCount = 0, packetMissCount = 0;
+
+        for (size_t i = 0; i < c.rayCount; i++) {
+            RayHit rayHit;
+
+            missCount += !accelerator->intersect(rays[i], rayHit);
+            unoccludedCount += !accelerator->occluded(rays[i]);
+        }
+
+        std::vector<RayHit> rayHits(c.rayCount);
+        std::unique_ptr<bool[]> hits(new bool[c.rayCount]);
+
+        accelerator->intersect(rays.data(), c.rayCount, rayHits.data(), hits.get());
+
+        for (size_t i = 0; i < c.rayCount; i++)
+            packetMissCount += !hits[i];
+
+        AURORA_CHECK(missCount == 0);
+        AURORA_CHECK(unoccludedCount == 0);
+        AURORA_CHECK(packetMissCount == 0);
+    }
+
+    setTriangleIntersection(previous);
+}
+
+AURORA_NAMESPACE_END
@@ -0,0 +1,74 @@
+// Copyright (c) 2019, Danilo Peixoto. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <iostream>
+#include <cstring>
+
+using namespace aurora;
+using namespace std;
+
+// Teste registrado (nome usado na linha de comando)
+struct test
+{
+	const char * name;
+	void (*function)();
+};
+
+const test tests[] = {
+	{"instance", testInstanceBVH},
+	{"refit", testBVHUpdate},
+	{"cache", testBVHCache},
+	{"blocks", testTriangleBlocks},
+	{"watertight", testWatertight},
+	{"depth", testBVHDepth},
+	{"quantized", testQuantizedBVH}
+};
+
+int main(int argc, char ** argv) {
+	
+	// Sem argumentos executa todos os testes, seno apenas os indicados
+	for (const test & t : tests) {
+		bool selected = argc == 1;
+		
+		for (int i = 1; i < argc; i++)
+			selected = selected || strcmp(argv[i], t.name) == 0;
+		
+		if (!selected)
+			continue;
+		
+		size_t failures = getFailureCount();
+		t.function();
+		
+		cout << t.name << ": " << (getFailureCount() == failures ? "ok" : "FAILED") << endl;
+	}
+	
+	cout << getFailureCount() << " failures" << endl;
+	
+	return getFailureCount() == 0 ? 0 : 1;
+}